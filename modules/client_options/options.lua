@@ -18,6 +18,7 @@ local defaultOptions = {
   foregroundFrameRate = 61,
   backgroundFrameRate = 201,
   painterEngine = 0,
+  asyncTextureLoading = true,
   enableAudio = true,
   enableMusicSound = true,
   musicSoundVolume = 100,
@@ -218,6 +219,8 @@ function setOption(key, value, force)
     gameMapPanel:setDrawLights(options['enableLights'] and value < 100)
   elseif key == 'painterEngine' then
     g_graphics.selectPainterEngine(value)
+  elseif key == 'asyncTextureLoading' then
+    g_things.setAsyncTextureLoading(value)
   elseif key == 'displayNames' then
     gameMapPanel:setDrawNames(value)
   elseif key == 'displayHealth' then
@@ -14,6 +14,9 @@ LogWarning = 2
 LogError = 3
 LogFatal = 4
 
+LogOverflowDrop = 0
+LogOverflowBlock = 1
+
 MouseFocusReason = 0
 KeyboardFocusReason = 1
 ActiveFocusReason = 2
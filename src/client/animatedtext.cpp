@@ -22,9 +22,9 @@
 
 #include "animatedtext.h"
 #include "map.h"
+#include "animationscheduler.h"
 #include "game.h"
 #include <framework/core/clock.h>
-#include <framework/core/eventdispatcher.h>
 #include <framework/graphics/graphics.h>
 
 AnimatedText::AnimatedText()
@@ -70,8 +70,7 @@ void AnimatedText::onAppear()
     m_animationTimer.restart();
 
     // schedule removal
-    auto self = asAnimatedText();
-    g_dispatcher.scheduleEvent([self]() { g_map.removeThing(self); }, Otc::ANIMATED_TEXT_DURATION);
+    g_animations.scheduleRemoval(asAnimatedText(), Otc::ANIMATED_TEXT_DURATION);
 }
 
 void AnimatedText::setColor(int color)
@@ -0,0 +1,82 @@
+/*
+ * Copyright (c) 2010-2013 OTClient <https://github.com/edubart/otclient>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "animationscheduler.h"
+#include "creature.h"
+#include "map.h"
+#include <framework/core/clock.h>
+#include <framework/core/eventdispatcher.h>
+
+AnimationScheduler g_animations;
+
+void AnimationScheduler::init()
+{
+    // the dispatcher is polled once per frame, so the shortest cycle runs the pass once every frame
+    m_updateEvent = g_dispatcher.cycleEvent([this] { update(); }, 1);
+}
+
+void AnimationScheduler::terminate()
+{
+    if(m_updateEvent) {
+        m_updateEvent->cancel();
+        m_updateEvent = nullptr;
+    }
+    m_creatures.clear();
+    m_updatingCreatures.clear();
+    m_removals.clear();
+    m_expiredThings.clear();
+}
+
+void AnimationScheduler::addCreature(const CreaturePtr& creature)
+{
+    m_creatures.push_back(creature);
+}
+
+void AnimationScheduler::scheduleRemoval(const ThingPtr& thing, int delay)
+{
+    m_removals.push_back({ g_clock.millis() + delay, thing });
+}
+
+void AnimationScheduler::update()
+{
+    // creature updates can reach lua, which may start new walks while the pass is running
+    m_updatingCreatures.swap(m_creatures);
+    for(const CreaturePtr& creature : m_updatingCreatures) {
+        if(creature->updateAnimation())
+            m_creatures.push_back(creature);
+    }
+    m_updatingCreatures.clear();
+
+    ticks_t now = g_clock.millis();
+    for(std::size_t i = 0; i < m_removals.size();) {
+        if(m_removals[i].time <= now) {
+            m_expiredThings.push_back(std::move(m_removals[i].thing));
+            m_removals[i] = std::move(m_removals.back());
+            m_removals.pop_back();
+        } else
+            ++i;
+    }
+
+    for(const ThingPtr& thing : m_expiredThings)
+        g_map.removeThing(thing);
+    m_expiredThings.clear();
+}
@@ -0,0 +1,62 @@
+/*
+ * Copyright (c) 2010-2013 OTClient <https://github.com/edubart/otclient>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef ANIMATIONSCHEDULER_H
+#define ANIMATIONSCHEDULER_H
+
+#include "declarations.h"
+#include <framework/core/declarations.h>
+
+// Runs one update pass per frame over everything on the map that animates by itself,
+// instead of each creature, effect and missile keeping its own scheduled events.
+class AnimationScheduler
+{
+public:
+    void init();
+    void terminate();
+
+    // the creature is updated every frame until it stops walking
+    void addCreature(const CreaturePtr& creature);
+    // removes the thing from the map once the delay is over
+    void scheduleRemoval(const ThingPtr& thing, int delay);
+
+    int getCreatureCount() { return m_creatures.size(); }
+    int getPendingRemovals() { return m_removals.size(); }
+
+private:
+    void update();
+
+    struct ThingRemoval {
+        ticks_t time;
+        ThingPtr thing;
+    };
+
+    std::vector<CreaturePtr> m_creatures;
+    std::vector<CreaturePtr> m_updatingCreatures;
+    std::vector<ThingRemoval> m_removals;
+    std::vector<ThingPtr> m_expiredThings;
+    ScheduledEventPtr m_updateEvent;
+};
+
+extern AnimationScheduler g_animations;
+
+#endif
@@ -29,6 +29,7 @@
 #include "shadermanager.h"
 #include "spritemanager.h"
 #include "minimap.h"
+#include "animationscheduler.h"
 #include <framework/core/configmanager.h>
 
 Client g_client;
@@ -40,6 +41,7 @@ void Client::init(std::vector<std::string>& args)
 
     g_map.init();
     g_minimap.init();
+    g_animations.init();
     g_game.init();
     g_shaders.init();
     g_things.init();
@@ -85,6 +87,7 @@ void Client::terminate()
 {
     g_creatures.terminate();
     g_game.terminate();
+    g_animations.terminate();
     g_map.terminate();
     g_minimap.terminate();
     g_things.terminate();
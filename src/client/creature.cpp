@@ -30,6 +30,8 @@
 #include "effect.h"
 #include "luavaluecasts.h"
 #include "lightview.h"
+#include "creatureoverlay.h"
+#include "animationscheduler.h"
 
 #include <framework/graphics/graphics.h>
 #include <framework/core/eventdispatcher.h>
@@ -38,6 +40,7 @@
 #include <framework/graphics/paintershaderprogram.h>
 #include <framework/graphics/ogl/painterogl2_shadersources.h>
 #include <framework/graphics/texturemanager.h>
+#include <framework/core/resourcemanager.h>
 #include <framework/graphics/framebuffermanager.h>
 #include "spritemanager.h"
 
@@ -49,6 +52,7 @@ Creature::Creature() : Thing()
     m_direction = Otc::South;
     m_walkAnimationPhase = 0;
     m_walkedPixels = 0;
+    m_walkFinishAnimTime = 0;
     m_walkTurnDirection = Otc::InvalidDirection;
     m_skull = Otc::SkullNone;
     m_shield = Otc::ShieldNone;
@@ -226,7 +230,7 @@ void Creature::drawOutfit(const Rect& destRect, bool resize)
     }
 }
 
-void Creature::drawInformation(const Point& point, bool useGray, const Rect& parentRect, int drawFlags)
+void Creature::drawInformation(CreatureOverlay& overlay, const Point& point, bool useGray, const Rect& parentRect, int drawFlags)
 {
     if(m_healthPercent < 1) // creature is dead
         return;
@@ -259,34 +263,19 @@ void Creature::drawInformation(const Point& point, bool useGray, const Rect& par
         fillColor = Color(0x66, 0xcc, 0xff);
 
     if(drawFlags & Otc::DrawBars) {
-        g_painter->setColor(Color::black);
-        g_painter->drawFilledRect(backgroundRect);
-
-        g_painter->setColor(fillColor);
-        g_painter->drawFilledRect(healthRect);
+        overlay.addFilledRect(backgroundRect, Color::black);
+        overlay.addFilledRect(healthRect, fillColor);
     }
 
-    if(drawFlags & Otc::DrawNames) {
-        if(g_painter->getColor() != fillColor)
-            g_painter->setColor(fillColor);
-        m_nameCache.draw(textRect);
-    }
+    if(drawFlags & Otc::DrawNames)
+        overlay.addText(m_nameCache, textRect, fillColor);
 
-    if(m_skull != Otc::SkullNone && m_skullTexture) {
-        g_painter->setColor(Color::white);
-        Rect skullRect = Rect(backgroundRect.x() + 13.5 + 12, backgroundRect.y() + 5, m_skullTexture->getSize());
-        g_painter->drawTexturedRect(skullRect, m_skullTexture);
-    }
-    if(m_shield != Otc::ShieldNone && m_shieldTexture && m_showShieldTexture) {
-        g_painter->setColor(Color::white);
-        Rect shieldRect = Rect(backgroundRect.x() + 13.5, backgroundRect.y() + 5, m_shieldTexture->getSize());
-        g_painter->drawTexturedRect(shieldRect, m_shieldTexture);
-    }
-    if(m_emblem != Otc::EmblemNone && m_emblemTexture) {
-        g_painter->setColor(Color::white);
-        Rect emblemRect = Rect(backgroundRect.x() + 13.5 + 12, backgroundRect.y() + 16, m_emblemTexture->getSize());
-        g_painter->drawTexturedRect(emblemRect, m_emblemTexture);
-    }
+    if(m_skull != Otc::SkullNone && !m_skullIcon.empty())
+        overlay.addIcon(m_skullIcon, Point(backgroundRect.x() + 13.5 + 12, backgroundRect.y() + 5));
+    if(m_shield != Otc::ShieldNone && !m_shieldIcon.empty() && m_showShieldTexture)
+        overlay.addIcon(m_shieldIcon, Point(backgroundRect.x() + 13.5, backgroundRect.y() + 5));
+    if(m_emblem != Otc::EmblemNone && !m_emblemIcon.empty())
+        overlay.addIcon(m_emblemIcon, Point(backgroundRect.x() + 13.5 + 12, backgroundRect.y() + 16));
 }
 
 void Creature::turn(Otc::Direction direction)
@@ -316,11 +305,7 @@ void Creature::walk(const Position& oldPos, const Position& newPos)
     m_walking = true;
     m_walkTimer.restart();
     m_walkedPixels = 0;
-
-    if(m_walkFinishAnimEvent) {
-        m_walkFinishAnimEvent->cancel();
-        m_walkFinishAnimEvent = nullptr;
-    }
+    m_walkFinishAnimTime = 0;
 
     // no direction need to be changed when the walk ends
     m_walkTurnDirection = Otc::InvalidDirection;
@@ -392,7 +377,8 @@ void Creature::updateJump()
 
 void Creature::onPositionChange(const Position& newPos, const Position& oldPos)
 {
-    callLuaField("onPositionChange", newPos, oldPos);
+    static const int onPositionChangeField = g_lua.internKey("onPositionChange");
+    callLuaField(onPositionChangeField, newPos, oldPos);
 }
 
 void Creature::onAppear()
@@ -474,15 +460,11 @@ void Creature::updateWalkAnimation(int totalPixelsWalked)
         m_walkAnimationPhase = 1 + (m_footStep % footAnimPhases);
     }
 
-    if(totalPixelsWalked == 32 && !m_walkFinishAnimEvent) {
-        auto self = static_self_cast<Creature>();
-        m_walkFinishAnimEvent = g_dispatcher.scheduleEvent([self] {
-            if(!self->m_walking || self->m_walkTimer.ticksElapsed() >= self->getStepDuration(true))
-                self->m_walkAnimationPhase = 0;
-            self->m_walkFinishAnimEvent = nullptr;
-        }, std::min(footDelay, 200));
+    // the feet are put back at rest by the animation pass
+    if(totalPixelsWalked == 32 && m_walkFinishAnimTime == 0) {
+        m_walkFinishAnimTime = g_clock.millis() + std::min(footDelay, 200);
+        scheduleAnimation();
     }
-
 }
 
 void Creature::updateWalkOffset(int totalPixelsWalked)
@@ -533,21 +515,36 @@ void Creature::updateWalkingTile()
 
 void Creature::nextWalkUpdate()
 {
-    // remove any previous scheduled walk updates
-    if(m_walkUpdateEvent)
-        m_walkUpdateEvent->cancel();
-
     // do the update
     updateWalk();
 
-    // schedules next update
-    if(m_walking) {
-        auto self = static_self_cast<Creature>();
-        m_walkUpdateEvent = g_dispatcher.scheduleEvent([self] {
-            self->m_walkUpdateEvent = nullptr;
-            self->nextWalkUpdate();
-        }, getStepDuration() / 32);
+    // the next updates are done by the animation pass, once per frame
+    if(m_walking)
+        scheduleAnimation();
+}
+
+void Creature::scheduleAnimation()
+{
+    if(m_animationScheduled)
+        return;
+
+    m_animationScheduled = true;
+    g_animations.addCreature(static_self_cast<Creature>());
+}
+
+bool Creature::updateAnimation()
+{
+    if(m_walking)
+        updateWalk();
+
+    if(m_walkFinishAnimTime != 0 && g_clock.millis() >= m_walkFinishAnimTime) {
+        if(!m_walking || m_walkTimer.ticksElapsed() >= getStepDuration(true))
+            m_walkAnimationPhase = 0;
+        m_walkFinishAnimTime = 0;
     }
+
+    m_animationScheduled = m_walking || m_walkFinishAnimTime != 0;
+    return m_animationScheduled;
 }
 
 void Creature::updateWalk()
@@ -570,12 +567,6 @@ void Creature::updateWalk()
 
 void Creature::terminateWalk()
 {
-    // remove any scheduled walk update
-    if(m_walkUpdateEvent) {
-        m_walkUpdateEvent->cancel();
-        m_walkUpdateEvent = nullptr;
-    }
-
     // now the walk has ended, do any scheduled turn
     if(m_walkTurnDirection != Otc::InvalidDirection)  {
         setDirection(m_walkTurnDirection);
@@ -710,12 +701,15 @@ void Creature::setEmblem(uint8 emblem)
 
 void Creature::setSkullTexture(const std::string& filename)
 {
-    m_skullTexture = g_textures.getTexture(filename);
+    // paths are resolved now, they are relative to the script calling this
+    m_skullIcon = g_resources.resolvePath(filename);
+    g_textures.getAtlasRegion(m_skullIcon);
 }
 
 void Creature::setShieldTexture(const std::string& filename, bool blink)
 {
-    m_shieldTexture = g_textures.getTexture(filename);
+    m_shieldIcon = g_resources.resolvePath(filename);
+    g_textures.getAtlasRegion(m_shieldIcon);
     m_showShieldTexture = true;
 
     if(blink && !m_shieldBlink) {
@@ -730,7 +724,8 @@ void Creature::setShieldTexture(const std::string& filename, bool blink)
 
 void Creature::setEmblemTexture(const std::string& filename)
 {
-    m_emblemTexture = g_textures.getTexture(filename);
+    m_emblemIcon = g_resources.resolvePath(filename);
+    g_textures.getAtlasRegion(m_emblemIcon);
 }
 
 void Creature::setSpeedFormula(double speedA, double speedB, double speedC)
@@ -48,7 +48,7 @@ public:
 
     void internalDrawOutfit(Point dest, float scaleFactor, bool animateWalk, bool animateIdle, Otc::Direction direction, LightView *lightView = nullptr);
     void drawOutfit(const Rect& destRect, bool resize);
-    void drawInformation(const Point& point, bool useGray, const Rect& parentRect, int drawFlags);
+    void drawInformation(CreatureOverlay& overlay, const Point& point, bool useGray, const Rect& parentRect, int drawFlags);
 
     void setId(uint32 id) { m_id = id; }
     void setName(const std::string& name);
@@ -109,6 +109,8 @@ public:
     virtual void walk(const Position& oldPos, const Position& newPos);
     virtual void stopWalk();
     void allowAppearWalk() { m_allowAppearWalk = true; }
+    // called every frame by the animation scheduler, returns false when there is nothing left to animate
+    bool updateAnimation();
 
     bool isWalking() { return m_walking; }
     bool isRemoved() { return m_removed; }
@@ -130,6 +132,7 @@ protected:
     virtual void updateWalkOffset(int totalPixelsWalked);
     void updateWalkingTile();
     virtual void nextWalkUpdate();
+    void scheduleAnimation();
     virtual void updateWalk();
     virtual void terminateWalk();
 
@@ -146,9 +149,9 @@ protected:
     uint8 m_skull;
     uint8 m_shield;
     uint8 m_emblem;
-    TexturePtr m_skullTexture;
-    TexturePtr m_shieldTexture;
-    TexturePtr m_emblemTexture;
+    std::string m_skullIcon;
+    std::string m_shieldIcon;
+    std::string m_emblemIcon;
     stdext::boolean<true> m_showShieldTexture;
     stdext::boolean<false> m_shieldBlink;
     stdext::boolean<false> m_passable;
@@ -175,8 +178,8 @@ protected:
     stdext::boolean<false> m_walking;
     stdext::boolean<false> m_allowAppearWalk;
     stdext::boolean<false> m_footStepDrawn;
-    ScheduledEventPtr m_walkUpdateEvent;
-    ScheduledEventPtr m_walkFinishAnimEvent;
+    stdext::boolean<false> m_animationScheduled;
+    ticks_t m_walkFinishAnimTime;
     EventPtr m_disappearEvent;
     Point m_walkOffset;
     Otc::Direction m_walkTurnDirection;
@@ -0,0 +1,107 @@
+/*
+ * Copyright (c) 2010-2013 OTClient <https://github.com/edubart/otclient>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "creatureoverlay.h"
+#include <framework/graphics/graphics.h>
+#include <framework/graphics/cachedtext.h>
+#include <framework/graphics/bitmapfont.h>
+#include <framework/graphics/textureatlas.h>
+#include <framework/graphics/texturemanager.h>
+
+CreatureOverlay::CreatureOverlay()
+{
+    m_drawCalls = 0;
+    m_quads = 0;
+}
+
+void CreatureOverlay::addFilledRect(const Rect& dest, const Color& color)
+{
+    if(dest.isEmpty())
+        return;
+    getCoords(BarsLayer, nullptr, color).addRect(dest);
+}
+
+void CreatureOverlay::addText(CachedText& text, const Rect& dest, const Color& color)
+{
+    const BitmapFontPtr& font = text.getFont();
+    if(!font || !font->getTexture())
+        return;
+    text.appendCoords(getCoords(NamesLayer, font->getTexture(), color), dest);
+}
+
+void CreatureOverlay::addIcon(const std::string& fileName, const Point& pos)
+{
+    // icons share the atlas pages, so all of them usually end up in the same batch
+    AtlasRegionPtr region = g_textures.getAtlasRegion(fileName);
+    if(!region)
+        return;
+    const Rect& src = region->getRect();
+    getCoords(IconsLayer, region->getTexture(), Color::white).addRect(Rect(pos, src.size()), src);
+}
+
+void CreatureOverlay::draw()
+{
+    m_drawCalls = 0;
+    m_quads = 0;
+
+    for(int layer = 0; layer < LayerCount; ++layer) {
+        std::vector<std::unique_ptr<Batch>>& batches = m_batches[layer];
+        for(const std::unique_ptr<Batch>& batch : batches) {
+            int vertexCount = batch->coords.getVertexCount();
+            if(vertexCount == 0)
+                continue;
+
+            g_painter->setColor(batch->color);
+            if(batch->texture)
+                g_painter->drawTextureCoords(batch->coords, batch->texture);
+            else
+                g_painter->drawFilledCoords(batch->coords);
+
+            m_drawCalls++;
+            m_quads += vertexCount / 6;
+        }
+
+        // batches left unused for a whole frame are dropped, the others keep their buffers allocated
+        batches.erase(std::remove_if(batches.begin(), batches.end(), [](const std::unique_ptr<Batch>& batch) {
+            return batch->coords.getVertexCount() == 0;
+        }), batches.end());
+        for(const std::unique_ptr<Batch>& batch : batches)
+            batch->coords.clear();
+    }
+
+    g_painter->resetColor();
+}
+
+CoordsBuffer& CreatureOverlay::getCoords(Layer layer, const TexturePtr& texture, const Color& color)
+{
+    std::vector<std::unique_ptr<Batch>>& batches = m_batches[layer];
+    for(const std::unique_ptr<Batch>& batch : batches) {
+        if(batch->texture == texture && batch->color == color)
+            return batch->coords;
+    }
+
+    Batch *batch = new Batch;
+    batch->texture = texture;
+    batch->color = color;
+    batches.push_back(std::unique_ptr<Batch>(batch));
+    return batch->coords;
+}
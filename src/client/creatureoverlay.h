@@ -0,0 +1,69 @@
+/*
+ * Copyright (c) 2010-2013 OTClient <https://github.com/edubart/otclient>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef CREATUREOVERLAY_H
+#define CREATUREOVERLAY_H
+
+#include "declarations.h"
+#include <framework/graphics/declarations.h>
+#include <framework/graphics/coordsbuffer.h>
+
+// Collects the bars, names and icons drawn over creatures during a frame,
+// so they are drawn with one call per color and texture instead of several per creature.
+// Layers are drawn in order, all bars then all names then all icons, so where two creatures'
+// information overlaps, names and icons stay above every bar rather than the later creature covering the earlier
+class CreatureOverlay
+{
+    enum Layer {
+        BarsLayer = 0,
+        NamesLayer,
+        IconsLayer,
+        LayerCount
+    };
+
+    struct Batch {
+        TexturePtr texture;
+        Color color;
+        CoordsBuffer coords;
+    };
+
+public:
+    CreatureOverlay();
+
+    void addFilledRect(const Rect& dest, const Color& color);
+    void addText(CachedText& text, const Rect& dest, const Color& color);
+    void addIcon(const std::string& fileName, const Point& pos);
+
+    void draw();
+
+    int getDrawCalls() { return m_drawCalls; }
+    int getQuads() { return m_quads; }
+
+private:
+    CoordsBuffer& getCoords(Layer layer, const TexturePtr& texture, const Color& color);
+
+    std::vector<std::unique_ptr<Batch>> m_batches[LayerCount];
+    int m_drawCalls;
+    int m_quads;
+};
+
+#endif
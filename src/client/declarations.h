@@ -51,6 +51,7 @@ class House;
 class Town;
 class CreatureType;
 class Spawn;
+class CreatureOverlay;
 
 typedef stdext::shared_object_ptr<MapView> MapViewPtr;
 typedef stdext::shared_object_ptr<LightView> LightViewPtr;
@@ -22,7 +22,7 @@
 
 #include "effect.h"
 #include "map.h"
-#include <framework/core/eventdispatcher.h>
+#include "animationscheduler.h"
 
 void Effect::draw(const Point& dest, float scaleFactor, bool animate, LightView *lightView)
 {
@@ -45,8 +45,7 @@ void Effect::onAppear()
         m_phaseDuration <<= 2;
 
     // schedule removal
-    auto self = asEffect();
-    g_dispatcher.scheduleEvent([self]() { g_map.removeThing(self); }, m_phaseDuration * getAnimationPhases());
+    g_animations.scheduleRemoval(asEffect(), m_phaseDuration * getAnimationPhases());
 }
 
 void Effect::setId(uint32 id)
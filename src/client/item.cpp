@@ -99,7 +99,7 @@ void Item::setOtbId(uint16 id)
 {
     if(!g_things.isValidOtbId(id))
         id = 0;
-    auto itemType = g_things.getItemType(id);
+    const ItemTypePtr& itemType = g_things.getItemType(id);
     m_serverId = id;
 
     id = itemType->getClientId();
@@ -175,7 +175,8 @@ void Item::unserializeItem(const BinaryTreePtr &in)
             }
         }
     } catch(stdext::exception& e) {
-        g_logger.error(stdext::format("Failed to unserialize OTBM item: %s", e.what()));
+        // the otbm loader runs it on worker threads, where the logger can't be used
+        stdext::throw_exception(stdext::format("Failed to unserialize OTBM item: %s", e.what()));
     }
 }
 
@@ -26,6 +26,7 @@
 #include <framework/graphics/framebuffermanager.h>
 #include <framework/graphics/painter.h>
 #include <framework/graphics/image.h>
+#include <framework/core/profiler.h>
 
 enum {
     MAX_LIGHT_INTENSITY = 8,
@@ -129,6 +130,8 @@ void LightView::resize(const Size& size)
 
 void LightView::draw(const Rect& dest, const Rect& src)
 {
+    PROFILE_SCOPE("LightView::draw");
+
     g_painter->saveAndResetState();
     m_lightbuffer->bind();
     g_painter->setCompositionMode(Painter::CompositionMode_Replace);
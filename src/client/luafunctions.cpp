@@ -63,6 +63,8 @@ void Client::registerLuaFunctions()
     g_lua.bindSingletonFunction("g_things", "isOtbLoaded", &ThingTypeManager::isOtbLoaded, &g_things);
     g_lua.bindSingletonFunction("g_things", "getDatSignature", &ThingTypeManager::getDatSignature, &g_things);
     g_lua.bindSingletonFunction("g_things", "getDatSignature", &ThingTypeManager::getDatSignature, &g_things);
+    g_lua.bindSingletonFunction("g_things", "setAsyncTextureLoading", &ThingTypeManager::setAsyncTextureLoading, &g_things);
+    g_lua.bindSingletonFunction("g_things", "isAsyncTextureLoading", &ThingTypeManager::isAsyncTextureLoading, &g_things);
     g_lua.bindSingletonFunction("g_things", "getThingType", &ThingTypeManager::getThingType, &g_things);
     g_lua.bindSingletonFunction("g_things", "getItemType", &ThingTypeManager::getItemType, &g_things);
     g_lua.bindSingletonFunction("g_things", "getThingTypes", &ThingTypeManager::getThingTypes, &g_things);
@@ -97,6 +99,12 @@ void Client::registerLuaFunctions()
     g_lua.bindSingletonFunction("g_sprites", "isLoaded", &SpriteManager::isLoaded, &g_sprites);
     g_lua.bindSingletonFunction("g_sprites", "getSprSignature", &SpriteManager::getSignature, &g_sprites);
     g_lua.bindSingletonFunction("g_sprites", "getSpritesCount", &SpriteManager::getSpritesCount, &g_sprites);
+    g_lua.bindSingletonFunction("g_sprites", "setCacheSize", &SpriteManager::setCacheSize, &g_sprites);
+    g_lua.bindSingletonFunction("g_sprites", "getCacheSize", &SpriteManager::getCacheSize, &g_sprites);
+    g_lua.bindSingletonFunction("g_sprites", "clearCache", &SpriteManager::clearCache, &g_sprites);
+    g_lua.bindSingletonFunction("g_sprites", "getSpritePixels", &SpriteManager::getSpritePixels, &g_sprites);
+    g_lua.bindSingletonFunction("g_sprites", "setVectorDecoding", &SpriteManager::setVectorDecoding, &g_sprites);
+    g_lua.bindSingletonFunction("g_sprites", "isVectorDecoding", &SpriteManager::isVectorDecoding, &g_sprites);
 
     g_lua.registerSingletonClass("g_map");
     g_lua.bindSingletonFunction("g_map", "isLookPossible", &Map::isLookPossible, &g_map);
@@ -120,8 +128,11 @@ void Client::registerLuaFunctions()
     g_lua.bindSingletonFunction("g_map", "findPath", &Map::findPath, &g_map);
     g_lua.bindSingletonFunction("g_map", "loadOtbm", &Map::loadOtbm, &g_map);
     g_lua.bindSingletonFunction("g_map", "saveOtbm", &Map::saveOtbm, &g_map);
+    g_lua.bindSingletonFunction("g_map", "setParallelLoading", &Map::setParallelLoading, &g_map);
+    g_lua.bindSingletonFunction("g_map", "isParallelLoading", &Map::isParallelLoading, &g_map);
     g_lua.bindSingletonFunction("g_map", "loadOtcm", &Map::loadOtcm, &g_map);
     g_lua.bindSingletonFunction("g_map", "saveOtcm", &Map::saveOtcm, &g_map);
+    g_lua.bindSingletonFunction("g_map", "getPendingOtcmBlocks", &Map::getPendingOtcmBlocks, &g_map);
     g_lua.bindSingletonFunction("g_map", "getHouseFile", &Map::getHouseFile, &g_map);
     g_lua.bindSingletonFunction("g_map", "setHouseFile", &Map::setHouseFile, &g_map);
     g_lua.bindSingletonFunction("g_map", "getSpawnFile", &Map::getSpawnFile, &g_map);
@@ -149,6 +160,11 @@ void Client::registerLuaFunctions()
     g_lua.bindSingletonFunction("g_minimap", "saveImage", &Minimap::saveImage, &g_minimap);
     g_lua.bindSingletonFunction("g_minimap", "loadOtmm", &Minimap::loadOtmm, &g_minimap);
     g_lua.bindSingletonFunction("g_minimap", "saveOtmm", &Minimap::saveOtmm, &g_minimap);
+    g_lua.bindSingletonFunction("g_minimap", "flushOtmm", &Minimap::flushOtmm, &g_minimap);
+    g_lua.bindSingletonFunction("g_minimap", "setMemoryBudget", &Minimap::setMemoryBudget, &g_minimap);
+    g_lua.bindSingletonFunction("g_minimap", "getMemoryBudget", &Minimap::getMemoryBudget, &g_minimap);
+    g_lua.bindSingletonFunction("g_minimap", "getLoadedBlocks", &Minimap::getLoadedBlocks, &g_minimap);
+    g_lua.bindSingletonFunction("g_minimap", "getStoredBlocks", &Minimap::getStoredBlocks, &g_minimap);
 
     g_lua.registerSingletonClass("g_creatures");
     g_lua.bindSingletonFunction("g_creatures", "getCreatures", &CreatureManager::getCreatures, &g_creatures);
@@ -295,6 +311,16 @@ void Client::registerLuaFunctions()
 
     g_lua.registerClass<ProtocolGame, Protocol>();
     g_lua.bindClassStaticFunction<ProtocolGame>("create", []{ return ProtocolGamePtr(new ProtocolGame); });
+    g_lua.bindClassStaticFunction<ProtocolGame>("setLuaOpcode", &ProtocolGame::setLuaOpcode);
+    g_lua.bindClassStaticFunction<ProtocolGame>("isLuaOpcode", &ProtocolGame::isLuaOpcode);
+    g_lua.bindClassStaticFunction<ProtocolGame>("getLuaPathOpcodes", &ProtocolGame::getLuaPathOpcodes);
+    g_lua.bindClassStaticFunction<ProtocolGame>("getFastPathOpcodes", &ProtocolGame::getFastPathOpcodes);
+    g_lua.bindClassStaticFunction<ProtocolGame>("resetOpcodeCounters", &ProtocolGame::resetOpcodeCounters);
+    g_lua.bindClassMemberFunction<ProtocolGame>("setRecording", &ProtocolGame::setRecording);
+    g_lua.bindClassMemberFunction<ProtocolGame>("isRecording", &ProtocolGame::isRecording);
+    g_lua.bindClassMemberFunction<ProtocolGame>("getRecordedMessages", &ProtocolGame::getRecordedMessages);
+    g_lua.bindClassMemberFunction<ProtocolGame>("clearRecordedMessages", &ProtocolGame::clearRecordedMessages);
+    g_lua.bindClassMemberFunction<ProtocolGame>("replayRecordedMessages", &ProtocolGame::replayRecordedMessages);
     g_lua.bindClassMemberFunction<ProtocolGame>("login", &ProtocolGame::login);
     g_lua.bindClassMemberFunction<ProtocolGame>("sendExtendedOpcode", &ProtocolGame::sendExtendedOpcode);
     g_lua.bindClassMemberFunction<ProtocolGame>("addPosition", &ProtocolGame::addPosition);
@@ -632,6 +658,8 @@ void Client::registerLuaFunctions()
     g_lua.bindClassMemberFunction<UIMap>("getViewMode", &UIMap::getViewMode);
     g_lua.bindClassMemberFunction<UIMap>("getFollowingCreature", &UIMap::getFollowingCreature);
     g_lua.bindClassMemberFunction<UIMap>("getDrawFlags", &UIMap::getDrawFlags);
+    g_lua.bindClassMemberFunction<UIMap>("getOverlayDrawCalls", &UIMap::getOverlayDrawCalls);
+    g_lua.bindClassMemberFunction<UIMap>("getOverlayQuads", &UIMap::getOverlayQuads);
     g_lua.bindClassMemberFunction<UIMap>("getCameraPosition", &UIMap::getCameraPosition);
     g_lua.bindClassMemberFunction<UIMap>("getPosition", &UIMap::getPosition);
     g_lua.bindClassMemberFunction<UIMap>("getTile", &UIMap::getTile);
@@ -640,6 +668,7 @@ void Client::registerLuaFunctions()
     g_lua.bindClassMemberFunction<UIMap>("getZoom", &UIMap::getZoom);
     g_lua.bindClassMemberFunction<UIMap>("getMapShader", &UIMap::getMapShader);
     g_lua.bindClassMemberFunction<UIMap>("getMinimumAmbientLight", &UIMap::getMinimumAmbientLight);
+    g_lua.bindClassMemberFunction<UIMap>("checkVisibleTilesCache", &UIMap::checkVisibleTilesCache);
 
     g_lua.registerClass<UIMinimap, UIWidget>();
     g_lua.bindClassStaticFunction<UIMinimap>("create", []{ return UIMinimapPtr(new UIMinimap); });
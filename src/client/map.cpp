@@ -33,6 +33,8 @@
 #include <framework/core/eventdispatcher.h>
 #include <framework/core/application.h>
 
+#include <queue>
+
 Map g_map;
 TilePtr Map::m_nulltile;
 
@@ -74,6 +76,10 @@ void Map::clean()
 
     for(int i=0;i<=Otc::MAX_Z;++i)
         m_tileBlocks[i].clear();
+    closeOtcmBlocks();
+
+    for(const MapViewPtr& mapView : m_mapViews)
+        mapView->onMapClean();
 
     m_waypoints.clear();
 
@@ -274,8 +280,11 @@ const TilePtr& Map::createTile(const Position& pos)
         m_tilesRect.setRight(pos.x);
     if(pos.y > m_tilesRect.bottom())
         m_tilesRect.setBottom(pos.y);
-    TileBlock& block = m_tileBlocks[pos.z][getBlockIndex(pos)];
-    return block.create(pos);
+    TileBlock& block = m_tileBlocks[pos.z].getOrCreate(getBlockIndex(pos));
+    const TilePtr& tile = block.create(pos);
+    for(const MapViewPtr& mapView : m_mapViews)
+        mapView->onTileUpdate(pos);
+    return tile;
 }
 
 template <typename... Items>
@@ -303,17 +312,21 @@ const TilePtr& Map::getOrCreateTile(const Position& pos)
         m_tilesRect.setRight(pos.x);
     if(pos.y > m_tilesRect.bottom())
         m_tilesRect.setBottom(pos.y);
-    TileBlock& block = m_tileBlocks[pos.z][getBlockIndex(pos)];
-    return block.getOrCreate(pos);
+    TileBlock& block = m_tileBlocks[pos.z].getOrCreate(getBlockIndex(pos));
+    if(const TilePtr& tile = block.get(pos))
+        return tile;
+    const TilePtr& tile = block.create(pos);
+    for(const MapViewPtr& mapView : m_mapViews)
+        mapView->onTileUpdate(pos);
+    return tile;
 }
 
 const TilePtr& Map::getTile(const Position& pos)
 {
     if(!pos.isMapPosition())
         return m_nulltile;
-    auto it = m_tileBlocks[pos.z].find(getBlockIndex(pos));
-    if(it != m_tileBlocks[pos.z].end())
-        return it->second.get(pos);
+    if(TileBlock *block = m_tileBlocks[pos.z].find(getBlockIndex(pos)))
+        return block->get(pos);
     return m_nulltile;
 }
 
@@ -321,13 +334,11 @@ void Map::cleanTile(const Position& pos)
 {
     if(!pos.isMapPosition())
         return;
-    auto it = m_tileBlocks[pos.z].find(getBlockIndex(pos));
-    if(it != m_tileBlocks[pos.z].end()) {
-        TileBlock& block = it->second;
-        if(const TilePtr& tile = block.get(pos)) {
+    if(TileBlock *block = m_tileBlocks[pos.z].find(getBlockIndex(pos))) {
+        if(const TilePtr& tile = block->get(pos)) {
             tile->clean();
             if(tile->canErase())
-                block.remove(pos);
+                block->remove(pos);
 
             notificateTileUpdate(pos);
         }
@@ -380,8 +391,7 @@ std::map<Position, ItemPtr> Map::findItemsById(uint16 clientId, uint32 max)
     std::map<Position, ItemPtr> ret;
     uint32 count = 0;
     for(uint8_t z = 0; z <= Otc::MAX_Z; ++z) {
-        for(const auto& pair : m_tileBlocks[z]) {
-            const TileBlock& block = pair.second;
+        for(const TileBlock& block : m_tileBlocks[z].getBlocks()) {
             for(const TilePtr& tile : block.getTiles()) {
                 if(unlikely(!tile || tile->isEmpty()))
                     continue;
@@ -449,6 +459,7 @@ void Map::setCentralPosition(const Position& centralPosition)
     m_centralPosition = centralPosition;
 
     removeUnawareThings();
+    loadAwareOtcmBlocks();
 
     // this fixes local player position when the local player is removed from the map,
     // the local player is removed from the map when there are too many creatures on his tile,
@@ -594,6 +605,7 @@ void Map::setAwareRange(const AwareRange& range)
 {
     m_awareRange = range;
     removeUnawareThings();
+    loadAwareOtcmBlocks();
 }
 
 void Map::resetAwareRange()
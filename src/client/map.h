@@ -86,7 +86,12 @@ enum OTBM_NodeTypes_t
 
 enum {
     OTCM_SIGNATURE = 0x4D43544F,
-    OTCM_VERSION = 1
+    OTCM_VERSION = 2
+};
+
+enum OTCM_Flags {
+    // version 2 tile blocks are compressed with zlib
+    OTCM_FLAG_ZLIB = 1 << 0
 };
 
 enum {
@@ -119,6 +124,81 @@ private:
     std::array<TilePtr, BLOCK_SIZE*BLOCK_SIZE> m_tiles;
 };
 
+// open addressing index of the tile blocks of a floor,
+// blocks live in a deque so references to their tiles stay valid while new blocks are added
+class TileBlockMap {
+public:
+    TileBlockMap() : m_mask(0) { }
+
+    TileBlock *find(uint index) {
+        if(m_slots.empty())
+            return nullptr;
+        for(uint i = hash(index) & m_mask;; i = (i + 1) & m_mask) {
+            const Slot& slot = m_slots[i];
+            if(!slot.block)
+                return nullptr;
+            if(slot.index == index)
+                return slot.block;
+        }
+    }
+
+    TileBlock& getOrCreate(uint index) {
+        if(TileBlock *block = find(index))
+            return *block;
+        // keep the load factor under 1/2 so probe sequences stay short
+        if((m_blocks.size() + 1) * 2 > m_slots.size())
+            rehash(std::max<uint>(m_slots.size() * 2, 64));
+        m_blocks.emplace_back();
+        TileBlock *block = &m_blocks.back();
+        insert(index, block);
+        return *block;
+    }
+
+    void clear() {
+        m_slots.clear();
+        m_blocks.clear();
+        m_mask = 0;
+    }
+
+    const std::deque<TileBlock>& getBlocks() const { return m_blocks; }
+
+private:
+    struct Slot {
+        Slot() : index(0), block(nullptr) { }
+        uint index;
+        TileBlock *block;
+    };
+
+    static uint hash(uint index) {
+        index ^= index >> 16;
+        index *= 0x85ebca6b;
+        index ^= index >> 13;
+        return index;
+    }
+
+    void insert(uint index, TileBlock *block) {
+        uint i = hash(index) & m_mask;
+        while(m_slots[i].block)
+            i = (i + 1) & m_mask;
+        m_slots[i].index = index;
+        m_slots[i].block = block;
+    }
+
+    void rehash(uint size) {
+        std::vector<Slot> slots(size);
+        slots.swap(m_slots);
+        m_mask = size - 1;
+        for(const Slot& slot : slots) {
+            if(slot.block)
+                insert(slot.index, slot.block);
+        }
+    }
+
+    std::vector<Slot> m_slots;
+    std::deque<TileBlock> m_blocks;
+    uint m_mask;
+};
+
 struct AwareRange
 {
     int top;
@@ -143,10 +223,15 @@ public:
 
     bool loadOtcm(const std::string& fileName);
     void saveOtcm(const std::string& fileName);
+    int getPendingOtcmBlocks();
 
     void loadOtbm(const std::string& fileName);
     void saveOtbm(const std::string& fileName);
 
+    // decodes otbm tile areas on the async dispatcher workers
+    void setParallelLoading(bool enable) { m_parallelLoading = enable; }
+    bool isParallelLoading() { return m_parallelLoading; }
+
     // otbm attributes (description, size, etc.)
     void setHouseFile(const std::string& file) { m_attribs.set(OTBM_ATTR_HOUSE_FILE, file); }
     void setSpawnFile(const std::string& file) { m_attribs.set(OTBM_ATTR_SPAWN_FILE, file); }
@@ -232,16 +317,30 @@ public:
     std::tuple<std::vector<Otc::Direction>, Otc::PathFindResult> findPath(const Position& start, const Position& goal, int maxComplexity, int flags = 0);
 
 private:
+    // tile block of an otcm v2 file, loaded only once it gets near the aware range
+    struct OtcmBlock {
+        uint32 offset;
+        uint32 size;
+        uint32 rawSize;
+    };
+
     void removeUnawareThings();
+    void readOtcmTiles(const FileStreamPtr& fin, bool keepExisting);
+    void loadOtcmBlock(const OtcmBlock& block);
+    void loadAwareOtcmBlocks();
+    void loadAllOtcmBlocks();
+    void closeOtcmBlocks();
     uint getBlockIndex(const Position& pos) { return ((pos.y / BLOCK_SIZE) * (65536 / BLOCK_SIZE)) + (pos.x / BLOCK_SIZE); }
 
-    std::unordered_map<uint, TileBlock> m_tileBlocks[Otc::MAX_Z+1];
+    TileBlockMap m_tileBlocks[Otc::MAX_Z+1];
     std::unordered_map<uint32, CreaturePtr> m_knownCreatures;
     std::array<std::vector<MissilePtr>, Otc::MAX_Z+1> m_floorMissiles;
     std::vector<AnimatedTextPtr> m_animatedTexts;
     std::vector<StaticTextPtr> m_staticTexts;
     std::vector<MapViewPtr> m_mapViews;
     std::unordered_map<Position, std::string, PositionHasher> m_waypoints;
+    std::unordered_map<uint, OtcmBlock> m_otcmBlocks[Otc::MAX_Z+1];
+    FileStreamPtr m_otcmFile;
 
     uint32 m_zoneFlags;
     std::array<Color, TILESTATE_LAST> m_zoneColors;
@@ -253,6 +352,7 @@ private:
 
     stdext::packed_storage<uint8> m_attribs;
     AwareRange m_awareRange;
+    stdext::boolean<false> m_parallelLoading;
     static TilePtr m_nulltile;
 };
 
@@ -29,8 +29,185 @@
 #include <framework/core/resourcemanager.h>
 #include <framework/core/filestream.h>
 #include <framework/core/binarytree.h>
+#include <framework/core/asyncdispatcher.h>
 #include <framework/xml/tinyxml.h>
 #include <framework/ui/uiwidget.h>
+#include <zlib.h>
+
+namespace {
+
+enum {
+    // tile areas decoded by each async task when loading in parallel
+    OTBM_AREAS_PER_TASK = 64
+};
+
+// a tile as read from an otbm file, before being added to the map
+struct OtbmTile {
+    OtbmTile() : houseId(0), houseTile(false), flags(TILESTATE_NONE) { }
+
+    Position pos;
+    uint32 houseId;
+    bool houseTile;
+    uint32 flags;
+    std::vector<ItemPtr> items; // from tile attributes
+    std::vector<ItemPtr> childItems; // from item nodes
+    std::vector<std::string> errors; // logged when the tile is added
+};
+
+typedef std::vector<OtbmTile> OtbmTileList;
+
+struct OtbmDecodedAreas {
+    OtbmDecodedAreas(uint count) : areas(count), errorArea(count) { }
+
+    std::vector<OtbmTileList> areas;
+    uint errorArea; // decoding stopped here
+    std::string error;
+};
+
+typedef std::shared_ptr<OtbmDecodedAreas> OtbmDecodedAreasPtr;
+
+// items with bad attributes are still added, as far as they could be read
+void unserializeOtbmItem(const ItemPtr& item, const BinaryTreePtr& node, OtbmTile& tile)
+{
+    try {
+        item->unserializeItem(node);
+    } catch(stdext::exception& e) {
+        tile.errors.push_back(e.what());
+    }
+}
+
+// only creates new objects, it doesn't touch the map, houses, lua or the logger so it can run in any thread
+void decodeOtbmTileArea(const BinaryTreePtr& nodeMapData, OtbmTileList& tiles)
+{
+    Position basePos;
+    basePos.x = nodeMapData->getU16();
+    basePos.y = nodeMapData->getU16();
+    basePos.z = nodeMapData->getU8();
+
+    for(const BinaryTreePtr &nodeTile : nodeMapData->getChildren()) {
+        uint8 type = nodeTile->getU8();
+        if(unlikely(type != OTBM_TILE && type != OTBM_HOUSETILE))
+            stdext::throw_exception(stdext::format("invalid node tile type %d", (int)type));
+
+        tiles.push_back(OtbmTile());
+        OtbmTile& tile = tiles.back();
+        tile.pos = basePos + nodeTile->getPoint();
+
+        if(type ==  OTBM_HOUSETILE) {
+            tile.houseTile = true;
+            tile.houseId = nodeTile->getU32();
+        }
+
+        while(nodeTile->canRead()) {
+            uint8 tileAttr = nodeTile->getU8();
+            switch(tileAttr) {
+                case OTBM_ATTR_TILE_FLAGS: {
+                    uint32 _flags = nodeTile->getU32();
+                    if((_flags & TILESTATE_PROTECTIONZONE) == TILESTATE_PROTECTIONZONE)
+                        tile.flags |= TILESTATE_PROTECTIONZONE;
+                    else if((_flags & TILESTATE_OPTIONALZONE) == TILESTATE_OPTIONALZONE)
+                        tile.flags |= TILESTATE_OPTIONALZONE;
+                    else if((_flags & TILESTATE_HARDCOREZONE) == TILESTATE_HARDCOREZONE)
+                        tile.flags |= TILESTATE_HARDCOREZONE;
+
+                    if((_flags & TILESTATE_NOLOGOUT) == TILESTATE_NOLOGOUT)
+                        tile.flags |= TILESTATE_NOLOGOUT;
+
+                    if((_flags & TILESTATE_REFRESH) == TILESTATE_REFRESH)
+                        tile.flags |= TILESTATE_REFRESH;
+
+                    if((_flags & TILESTATE_HOUSE) == TILESTATE_HOUSE)
+                        tile.flags |= TILESTATE_HOUSE;
+                    break;
+                }
+                case OTBM_ATTR_ITEM: {
+                    tile.items.push_back(Item::createFromOtb(nodeTile->getU16()));
+                    break;
+                }
+                default: {
+                    stdext::throw_exception(stdext::format("invalid tile attribute %d at pos %s",
+                                                       (int)tileAttr, stdext::to_string(tile.pos)));
+                }
+            }
+        }
+
+        for(const BinaryTreePtr& nodeItem : nodeTile->getChildren()) {
+            if(unlikely(nodeItem->getU8() != OTBM_ITEM))
+                stdext::throw_exception("invalid item node");
+
+            ItemPtr item = Item::createFromOtb(nodeItem->getU16());
+            unserializeOtbmItem(item, nodeItem, tile);
+
+            if(item->isContainer()) {
+                for(const BinaryTreePtr& containerItem : nodeItem->getChildren()) {
+                    if(containerItem->getU8() != OTBM_ITEM)
+                        stdext::throw_exception("invalid container item node");
+
+                    ItemPtr cItem = Item::createFromOtb(containerItem->getU16());
+                    unserializeOtbmItem(cItem, containerItem, tile);
+                    item->addContainerItem(cItem);
+                }
+            }
+
+            tile.childItems.push_back(item);
+        }
+    }
+}
+
+OtbmDecodedAreasPtr decodeOtbmTileAreas(const BinaryTreeIndexPtr& index, const std::vector<uint>& nodeIds)
+{
+    OtbmDecodedAreasPtr decoded(new OtbmDecodedAreas(nodeIds.size()));
+    for(uint i = 0; i < nodeIds.size(); ++i) {
+        try {
+            BinaryTreePtr nodeMapData(new BinaryTree(index, nodeIds[i]));
+            if(nodeMapData->getU8() == OTBM_TILE_AREA)
+                decodeOtbmTileArea(nodeMapData, decoded->areas[i]);
+        } catch(stdext::exception& e) {
+            // reported when the loader reaches this area, as the serial loader would
+            decoded->errorArea = i;
+            decoded->error = e.what();
+            break;
+        }
+    }
+    return decoded;
+}
+
+void addOtbmTiles(const OtbmTileList& tiles)
+{
+    for(const OtbmTile& otbmTile : tiles) {
+        for(const std::string& error : otbmTile.errors)
+            g_logger.error(error);
+
+        HousePtr house = nullptr;
+        if(otbmTile.houseTile) {
+            TilePtr tile = g_map.getOrCreateTile(otbmTile.pos);
+            if(!(house = g_houses.getHouse(otbmTile.houseId))) {
+                house = HousePtr(new House(otbmTile.houseId));
+                g_houses.addHouse(house);
+            }
+            house->setTile(tile);
+        }
+
+        for(const ItemPtr& item : otbmTile.items)
+            g_map.addThing(item, otbmTile.pos);
+
+        for(const ItemPtr& item : otbmTile.childItems) {
+            if(house && item->isMoveable()) {
+                g_logger.warning(stdext::format("Moveable item found in house: %d at pos %s - escaping...", item->getId(), stdext::to_string(otbmTile.pos)));
+                continue;
+            }
+            g_map.addThing(item, otbmTile.pos);
+        }
+
+        if(const TilePtr& tile = g_map.getTile(otbmTile.pos)) {
+            if(house)
+                tile->setHouseId(house->getId());
+            tile->setFlags((tileflags_t)otbmTile.flags);
+        }
+    }
+}
+
+}
 
 void Map::loadOtbm(const std::string& fileName)
 {
@@ -39,6 +216,8 @@ void Map::loadOtbm(const std::string& fileName)
         if(!fin)
             stdext::throw_exception(stdext::format("Unable to load map '%s'", fileName));
 
+        ticks_t start = stdext::millis();
+
         fin->cache();
         if(!g_things.isOtbLoaded())
             stdext::throw_exception("OTB isn't loaded yet to load a map.");
@@ -92,97 +271,49 @@ void Map::loadOtbm(const std::string& fileName)
             }
         }
 
-        for(const BinaryTreePtr& nodeMapData : node->getChildren()) {
+        BinaryTreeVec mapDataNodes = node->getChildren();
+
+        // tile areas don't depend on each other, so they can be decoded on the async dispatcher workers
+        // while their tiles are still added to the map here, in file order
+        std::vector<boost::shared_future<OtbmDecodedAreasPtr>> decodedAreas;
+        struct CancelGuard {
+            AsyncCancelTokenPtr token;
+            ~CancelGuard() { if(token) token->cancel(); }
+        } cancelGuard;
+        if(m_parallelLoading) {
+            cancelGuard.token = AsyncCancelTokenPtr(new AsyncCancelToken);
+            const BinaryTreeIndexPtr& index = node->getIndex();
+            for(uint first = 0; first < mapDataNodes.size(); first += OTBM_AREAS_PER_TASK) {
+                std::vector<uint> nodeIds;
+                for(uint i = first; i < std::min<uint>(first + OTBM_AREAS_PER_TASK, mapDataNodes.size()); ++i)
+                    nodeIds.push_back(mapDataNodes[i]->getNodeId());
+                decodedAreas.push_back(g_asyncDispatcher.schedule([index, nodeIds]() {
+                    return decodeOtbmTileAreas(index, nodeIds);
+                }, AsyncDispatcher::Priority_Background, cancelGuard.token));
+            }
+        }
+
+        int lastProgress = -1;
+        for(uint i = 0; i < mapDataNodes.size(); ++i) {
+            const BinaryTreePtr& nodeMapData = mapDataNodes[i];
             uint8 mapDataType = nodeMapData->getU8();
             if(mapDataType == OTBM_TILE_AREA) {
-                Position basePos;
-                basePos.x = nodeMapData->getU16();
-                basePos.y = nodeMapData->getU16();
-                basePos.z = nodeMapData->getU8();
-
-                for(const BinaryTreePtr &nodeTile : nodeMapData->getChildren()) {
-                    uint8 type = nodeTile->getU8();
-                    if(unlikely(type != OTBM_TILE && type != OTBM_HOUSETILE))
-                        stdext::throw_exception(stdext::format("invalid node tile type %d", (int)type));
-
-                    HousePtr house = nullptr;
-                    uint32 flags = TILESTATE_NONE;
-                    Position pos = basePos + nodeTile->getPoint();
-
-                    if(type ==  OTBM_HOUSETILE) {
-                        uint32 hId = nodeTile->getU32();
-                        TilePtr tile = getOrCreateTile(pos);
-                        if(!(house = g_houses.getHouse(hId))) {
-                            house = HousePtr(new House(hId));
-                            g_houses.addHouse(house);
-                        }
-                        house->setTile(tile);
-                    }
-
-                    while(nodeTile->canRead()) {
-                        uint8 tileAttr = nodeTile->getU8();
-                        switch(tileAttr) {
-                            case OTBM_ATTR_TILE_FLAGS: {
-                                uint32 _flags = nodeTile->getU32();
-                                if((_flags & TILESTATE_PROTECTIONZONE) == TILESTATE_PROTECTIONZONE)
-                                    flags |= TILESTATE_PROTECTIONZONE;
-                                else if((_flags & TILESTATE_OPTIONALZONE) == TILESTATE_OPTIONALZONE)
-                                    flags |= TILESTATE_OPTIONALZONE;
-                                else if((_flags & TILESTATE_HARDCOREZONE) == TILESTATE_HARDCOREZONE)
-                                    flags |= TILESTATE_HARDCOREZONE;
-
-                                if((_flags & TILESTATE_NOLOGOUT) == TILESTATE_NOLOGOUT)
-                                    flags |= TILESTATE_NOLOGOUT;
-
-                                if((_flags & TILESTATE_REFRESH) == TILESTATE_REFRESH)
-                                    flags |= TILESTATE_REFRESH;
-
-                                if((_flags & TILESTATE_HOUSE) == TILESTATE_HOUSE)
-                                    flags |= TILESTATE_HOUSE;
-                                break;
-                            }
-                            case OTBM_ATTR_ITEM: {
-                                addThing(Item::createFromOtb(nodeTile->getU16()), pos);
-                                break;
-                            }
-                            default: {
-                                stdext::throw_exception(stdext::format("invalid tile attribute %d at pos %s",
-                                                                   (int)tileAttr, stdext::to_string(pos)));
-                            }
-                        }
-                    }
-
-                    for(const BinaryTreePtr& nodeItem : nodeTile->getChildren()) {
-                        if(unlikely(nodeItem->getU8() != OTBM_ITEM))
-                            stdext::throw_exception("invalid item node");
-
-                        ItemPtr item = Item::createFromOtb(nodeItem->getU16());
-                        item->unserializeItem(nodeItem);
-
-                        if(item->isContainer()) {
-                            for(const BinaryTreePtr& containerItem : nodeItem->getChildren()) {
-                                if(containerItem->getU8() != OTBM_ITEM)
-                                    stdext::throw_exception("invalid container item node");
-
-                                ItemPtr cItem = Item::createFromOtb(containerItem->getU16());
-                                cItem->unserializeItem(containerItem);
-                                item->addContainerItem(cItem);
-                            }
-                        }
-
-                        if(house && item->isMoveable()) {
-                            g_logger.warning(stdext::format("Moveable item found in house: %d at pos %s - escaping...", item->getId(), stdext::to_string(pos)));
-                            item.reset();
-                        }
-
-                        addThing(item, pos);
-                    }
+                if(m_parallelLoading) {
+                    const OtbmDecodedAreasPtr& decoded = decodedAreas[i / OTBM_AREAS_PER_TASK].get();
+                    if(i % OTBM_AREAS_PER_TASK == decoded->errorArea)
+                        stdext::throw_exception(decoded->error);
+                    addOtbmTiles(decoded->areas[i % OTBM_AREAS_PER_TASK]);
+                } else {
+                    OtbmTileList tiles;
+                    decodeOtbmTileArea(nodeMapData, tiles);
+                    addOtbmTiles(tiles);
+                }
 
-                    if(const TilePtr& tile = getTile(pos)) {
-                        if(house)
-                            tile->setHouseId(house->getId());
-                        tile->setFlags((tileflags_t)flags);
-                    }
+                // called from inside the load, no frame is drawn until it returns so it can't drive a progress bar
+                int progress = (i + 1) * 100 / mapDataNodes.size();
+                if(progress != lastProgress) {
+                    lastProgress = progress;
+                    g_lua.callGlobalField("g_map", "onLoadProgress", progress);
                 }
             } else if(mapDataType == OTBM_TOWNS) {
                 TownPtr town = nullptr;
@@ -221,6 +352,7 @@ void Map::loadOtbm(const std::string& fileName)
         }
 
         fin->close();
+        g_logger.debug(stdext::format("Map '%s' loaded in %d ms", fileName, (int)(stdext::millis() - start)));
     } catch(std::exception& e) {
         g_logger.error(stdext::format("Failed to load '%s': %s", fileName, e.what()));
     }
@@ -305,8 +437,7 @@ void Map::saveOtbm(const std::string& fileName)
                 bool firstNode = true;
 
                 for(uint8_t z = 0; z <= Otc::MAX_Z; ++z) {
-                    for(const auto& it : m_tileBlocks[z]) {
-                        const TileBlock& block = it.second;
+                    for(const TileBlock& block : m_tileBlocks[z].getBlocks()) {
                         for(const TilePtr& tile : block.getTiles()) {
                             if(unlikely(!tile || tile->isEmpty()))
                                 continue;
@@ -408,18 +539,18 @@ bool Map::loadOtcm(const std::string& fileName)
         if(!fin)
             stdext::throw_exception("unable to open file");
 
-        fin->cache();
-
         uint32 signature = fin->getU32();
         if(signature != OTCM_SIGNATURE)
             stdext::throw_exception("invalid otcm file");
 
         uint16 start = fin->getU16();
         uint16 version = fin->getU16();
-        fin->getU32(); // flags
+        uint32 flags = fin->getU32();
 
+        uint32 directoryPos = 0;
         switch(version) {
-            case 1: {
+            case 1:
+            case 2: {
                 fin->getString(); // description
                 uint32 datSignature = fin->getU32();
                 fin->getU16(); // protocol version
@@ -428,52 +559,54 @@ bool Map::loadOtcm(const std::string& fileName)
                 if(datSignature != g_things.getDatSignature())
                     g_logger.warning("otcm map loaded was created with a different dat signature");
 
+                if(version == 2) {
+                    if(flags != OTCM_FLAG_ZLIB)
+                        stdext::throw_exception("otcm compression not supported");
+                    directoryPos = fin->getU32();
+                }
                 break;
             }
             default:
                 stdext::throw_exception("otcm version not supported");
         }
 
-        fin->seek(start);
+        if(version == 1) {
+            // the whole map is stored in a single stream
+            fin->cache();
+            fin->seek(start);
+            readOtcmTiles(fin, false);
+            fin->close();
+            return true;
+        }
 
-        while(true) {
-            Position pos;
+        // blocks from a previous otcm would be loaded over this map
+        closeOtcmBlocks();
 
+        fin->seek(directoryPos);
+        uint32 blockCount = fin->getU32();
+        for(uint32 i = 0; i < blockCount; ++i) {
+            Position pos;
             pos.x = fin->getU16();
             pos.y = fin->getU16();
             pos.z = fin->getU8();
 
-            // end of file
-            if(!pos.isValid())
-                break;
-
-            const TilePtr& tile = g_map.createTile(pos);
-
-            int stackPos = 0;
-            while(true) {
-                int id = fin->getU16();
-
-                // end of tile
-                if(id == 0xFFFF)
-                    break;
-
-                int countOrSubType = fin->getU8();
-
-                ItemPtr item = Item::create(id);
-                item->setCountOrSubType(countOrSubType);
+            OtcmBlock block;
+            block.offset = fin->getU32();
+            block.size = fin->getU32();
+            block.rawSize = fin->getU32();
 
-                if(item->isValid())
-                    tile->addThing(item, stackPos++);
-            }
-
-            g_map.notificateTileUpdate(pos);
+            if(!pos.isValid() || block.offset < start || block.offset + block.size > directoryPos)
+                stdext::throw_exception("invalid otcm block directory");
+            m_otcmBlocks[pos.z][getBlockIndex(pos)] = block;
         }
 
-        fin->close();
-
+        // the file stays open, blocks are read when the aware range gets near them
+        m_otcmFile = fin;
+        loadAwareOtcmBlocks();
         return true;
     } catch(stdext::exception& e) {
         g_logger.error(stdext::format("failed to load OTCM map: %s", e.what()));
+        closeOtcmBlocks();
         return false;
     }
 }
@@ -483,11 +616,13 @@ void Map::saveOtcm(const std::string& fileName)
     try {
         stdext::timer saveTimer;
 
+        // blocks not loaded yet would be lost, and their file may be the one being overwritten
+        loadAllOtcmBlocks();
+
         FileStreamPtr fin = g_resources.createFile(fileName);
         fin->cache();
 
-        //TODO: compression flag with zlib
-        uint32 flags = 0;
+        uint32 flags = OTCM_FLAG_ZLIB;
 
         // header
         fin->addU32(OTCM_SIGNATURE);
@@ -495,11 +630,13 @@ void Map::saveOtcm(const std::string& fileName)
         fin->addU16(OTCM_VERSION);
         fin->addU32(flags);
 
-        // version 1 header
-        fin->addString("OTCM 1.0"); // map description
+        // version 2 header
+        fin->addString("OTCM 2.0"); // map description
         fin->addU32(g_things.getDatSignature());
         fin->addU16(g_game.getProtocolVersion());
         fin->addString(g_game.getWorldName());
+        uint32 directoryPosOffset = fin->tell();
+        fin->addU32(0); // block directory start, will be overwritten later
 
         // go back and rewrite where the map data starts
         uint32 start = fin->tell();
@@ -507,37 +644,88 @@ void Map::saveOtcm(const std::string& fileName)
         fin->addU16(start);
         fin->seek(start);
 
+        struct BlockEntry {
+            Position pos;
+            OtcmBlock block;
+        };
+        std::vector<BlockEntry> directory;
+
+        std::string rawBlock;
+        std::vector<uchar> compressBuffer;
+        const int COMPRESS_LEVEL = 3;
+
         for(uint8_t z = 0; z <= Otc::MAX_Z; ++z) {
-            for(const auto& it : m_tileBlocks[z]) {
-                const TileBlock& block = it.second;
+            for(const TileBlock& block : m_tileBlocks[z].getBlocks()) {
+                // each block is written as a version 1 stream of its own tiles
+                FileStreamPtr blockStream(new FileStream(fileName, std::string()));
+                Position blockPos;
                 for(const TilePtr& tile : block.getTiles()) {
                     if(!tile || tile->isEmpty())
                         continue;
 
                     Position pos = tile->getPosition();
-                    fin->addU16(pos.x);
-                    fin->addU16(pos.y);
-                    fin->addU8(pos.z);
+                    blockStream->addU16(pos.x);
+                    blockStream->addU16(pos.y);
+                    blockStream->addU8(pos.z);
+                    blockPos = pos;
 
                     for(const ThingPtr& thing : tile->getThings()) {
                         if(thing->isItem()) {
                             ItemPtr item = thing->static_self_cast<Item>();
-                            fin->addU16(item->getId());
-                            fin->addU8(item->getCountOrSubType());
+                            blockStream->addU16(item->getId());
+                            blockStream->addU8(item->getCountOrSubType());
                         }
                     }
 
                     // end of tile
-                    fin->addU16(0xFFFF);
+                    blockStream->addU16(0xFFFF);
                 }
+
+                if(!blockPos.isValid())
+                    continue;
+
+                // end of block
+                Position invalidPos;
+                blockStream->addU16(invalidPos.x);
+                blockStream->addU16(invalidPos.y);
+                blockStream->addU8(invalidPos.z);
+
+                uint rawSize = blockStream->size();
+                rawBlock.resize(rawSize);
+                blockStream->seek(0);
+                blockStream->read(&rawBlock[0], rawSize);
+
+                ulong len = compressBound(rawSize);
+                compressBuffer.resize(len);
+                int ret = compress2(compressBuffer.data(), &len, (uchar*)rawBlock.data(), rawSize, COMPRESS_LEVEL);
+                if(ret != Z_OK)
+                    stdext::throw_exception("unable to compress tile block");
+
+                BlockEntry entry;
+                entry.pos = Position(blockPos.x - blockPos.x % BLOCK_SIZE, blockPos.y - blockPos.y % BLOCK_SIZE, blockPos.z);
+                entry.block.offset = fin->tell();
+                entry.block.size = len;
+                entry.block.rawSize = rawSize;
+                directory.push_back(entry);
+
+                fin->write(compressBuffer.data(), len);
             }
         }
 
-        // end of file
-        Position invalidPos;
-        fin->addU16(invalidPos.x);
-        fin->addU16(invalidPos.y);
-        fin->addU8(invalidPos.z);
+        // block directory
+        uint32 directoryPos = fin->tell();
+        fin->addU32(directory.size());
+        for(const BlockEntry& entry : directory) {
+            fin->addU16(entry.pos.x);
+            fin->addU16(entry.pos.y);
+            fin->addU8(entry.pos.z);
+            fin->addU32(entry.block.offset);
+            fin->addU32(entry.block.size);
+            fin->addU32(entry.block.rawSize);
+        }
+
+        fin->seek(directoryPosOffset);
+        fin->addU32(directoryPos);
 
         fin->flush();
 
@@ -547,4 +735,137 @@ void Map::saveOtcm(const std::string& fileName)
     }
 }
 
+int Map::getPendingOtcmBlocks()
+{
+    int count = 0;
+    for(int z = 0; z <= Otc::MAX_Z; ++z)
+        count += m_otcmBlocks[z].size();
+    return count;
+}
+
+void Map::readOtcmTiles(const FileStreamPtr& fin, bool keepExisting)
+{
+    while(true) {
+        Position pos;
+
+        pos.x = fin->getU16();
+        pos.y = fin->getU16();
+        pos.z = fin->getU8();
+
+        // end of file
+        if(!pos.isValid())
+            break;
+
+        // cached tiles are older than the ones already received from the server
+        bool skip = keepExisting && getTile(pos);
+        const TilePtr& tile = skip ? m_nulltile : createTile(pos);
+
+        int stackPos = 0;
+        while(true) {
+            int id = fin->getU16();
+
+            // end of tile
+            if(id == 0xFFFF)
+                break;
+
+            int countOrSubType = fin->getU8();
+            if(skip)
+                continue;
+
+            ItemPtr item = Item::create(id);
+            item->setCountOrSubType(countOrSubType);
+
+            if(item->isValid())
+                tile->addThing(item, stackPos++);
+        }
+
+        if(!skip)
+            notificateTileUpdate(pos);
+    }
+}
+
+void Map::loadOtcmBlock(const OtcmBlock& block)
+{
+    std::vector<uchar> compressBuffer(block.size);
+    m_otcmFile->seek(block.offset);
+    if(m_otcmFile->read(compressBuffer.data(), block.size) != 1)
+        stdext::throw_exception("unable to read tile block");
+
+    std::string rawBlock(block.rawSize, '\0');
+    ulong destLen = block.rawSize;
+    int ret = uncompress((uchar*)&rawBlock[0], &destLen, compressBuffer.data(), block.size);
+    if(ret != Z_OK || destLen != block.rawSize)
+        stdext::throw_exception("corrupted tile block");
+
+    readOtcmTiles(FileStreamPtr(new FileStream(m_otcmFile->name(), rawBlock)), true);
+}
+
+void Map::loadAwareOtcmBlocks()
+{
+    if(!m_otcmFile || !m_centralPosition.isValid())
+        return;
+
+    // other floors are drawn shifted by up to MAX_Z tiles, so their blocks are taken a bit further
+    int left = std::max<int>(m_centralPosition.x - m_awareRange.left - Otc::MAX_Z, 0) / BLOCK_SIZE;
+    int right = std::min<int>(m_centralPosition.x + m_awareRange.right + Otc::MAX_Z, 65535) / BLOCK_SIZE;
+    int top = std::max<int>(m_centralPosition.y - m_awareRange.top - Otc::MAX_Z, 0) / BLOCK_SIZE;
+    int bottom = std::min<int>(m_centralPosition.y + m_awareRange.bottom + Otc::MAX_Z, 65535) / BLOCK_SIZE;
+
+    // loaded blocks become ordinary map tiles, they are kept like the tiles seen in game
+    // and are not evicted again once the aware range moves away from them
+    for(int z = getFirstAwareFloor(); z <= getLastAwareFloor(); ++z) {
+        std::unordered_map<uint, OtcmBlock>& blocks = m_otcmBlocks[z];
+        if(blocks.empty())
+            continue;
+
+        for(int y = top; y <= bottom; ++y) {
+            for(int x = left; x <= right; ++x) {
+                auto it = blocks.find(getBlockIndex(Position(x * BLOCK_SIZE, y * BLOCK_SIZE, z)));
+                if(it == blocks.end())
+                    continue;
+
+                OtcmBlock block = it->second;
+                blocks.erase(it);
+                try {
+                    loadOtcmBlock(block);
+                } catch(stdext::exception& e) {
+                    // only the corrupt block is lost, the others are still loaded
+                    g_logger.error(stdext::format("failed to load OTCM block: %s", e.what()));
+                }
+            }
+        }
+    }
+
+    if(getPendingOtcmBlocks() == 0)
+        closeOtcmBlocks();
+}
+
+void Map::loadAllOtcmBlocks()
+{
+    if(!m_otcmFile)
+        return;
+
+    for(int z = 0; z <= Otc::MAX_Z; ++z) {
+        for(const auto& it : m_otcmBlocks[z]) {
+            try {
+                loadOtcmBlock(it.second);
+            } catch(stdext::exception& e) {
+                g_logger.error(stdext::format("failed to load OTCM block: %s", e.what()));
+            }
+        }
+    }
+
+    closeOtcmBlocks();
+}
+
+void Map::closeOtcmBlocks()
+{
+    for(int z = 0; z <= Otc::MAX_Z; ++z)
+        m_otcmBlocks[z].clear();
+    if(m_otcmFile) {
+        m_otcmFile->close();
+        m_otcmFile = nullptr;
+    }
+}
+
 /* vim: set ts=4 sw=4 et: */
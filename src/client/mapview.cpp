@@ -37,6 +37,7 @@
 #include <framework/core/eventdispatcher.h>
 #include <framework/core/application.h>
 #include <framework/core/resourcemanager.h>
+#include <framework/core/profiler.h>
 
 
 enum {
@@ -57,6 +58,8 @@ MapView::MapView()
     m_cachedFirstVisibleFloor = 7;
     m_cachedLastVisibleFloor = 7;
     m_updateTilesPos = 0;
+    m_tilesGridFirstFloor = 0;
+    m_tilesGridLastFloor = 0;
     m_fadeOutTime = 0;
     m_fadeInTime = 0;
     m_minimumAmbientLight = 0;
@@ -77,6 +80,8 @@ MapView::~MapView()
 
 void MapView::draw(const Rect& rect)
 {
+    PROFILE_SCOPE("MapView::draw");
+
     // update visible tiles cache when needed
     if(m_mustUpdateVisibleTilesCache || m_updateTilesPos > 0)
         updateVisibleTilesCache(m_mustUpdateVisibleTilesCache ? 0 : m_updateTilesPos);
@@ -177,6 +182,7 @@ void MapView::draw(const Rect& rect)
 
     g_painter->setColor(Color::white);
     g_painter->setOpacity(fadeOpacity);
+    g_painter->flush();
     glDisable(GL_BLEND);
 #if 0
     // debug source area
@@ -190,6 +196,7 @@ void MapView::draw(const Rect& rect)
 #else
     m_framebuffer->draw(rect, srcRect);
 #endif
+    g_painter->flush();
     g_painter->resetShaderProgram();
     g_painter->resetOpacity();
     glEnable(GL_BLEND);
@@ -220,8 +227,9 @@ void MapView::draw(const Rect& rect)
             int flags = 0;
             if(m_drawNames){ flags = Otc::DrawNames; }
             if(m_drawHealthBars) { flags |= Otc::DrawBars; }
-            creature->drawInformation(p, g_map.isCovered(pos, m_cachedFirstVisibleFloor), rect, flags);
+            creature->drawInformation(m_creatureOverlay, p, g_map.isCovered(pos, m_cachedFirstVisibleFloor), rect, flags);
         }
+        m_creatureOverlay.draw();
     }
 
     // lights are drawn after names and before texts
@@ -272,6 +280,8 @@ void MapView::draw(const Rect& rect)
 
 void MapView::updateVisibleTilesCache(int start)
 {
+    PROFILE_SCOPE("MapView::updateVisibleTilesCache");
+
     if(start == 0) {
         m_cachedFirstVisibleFloor = calcFirstVisibleFloor();
         m_cachedLastVisibleFloor = calcLastVisibleFloor();
@@ -303,6 +313,9 @@ void MapView::updateVisibleTilesCache(int start)
     m_mustDrawVisibleTilesCache = true;
     m_updateTilesPos = 0;
 
+    if(m_viewMode <= FAR_VIEW)
+        updateTilesGrid(cameraPosition);
+
     // cache visible tiles in draw order
     // draw from last floor (the lower) to first floor (the higher)
     for(int iz = m_cachedLastVisibleFloor; iz >= m_cachedFirstVisibleFloor && !stop; --iz) {
@@ -325,17 +338,12 @@ void MapView::updateVisibleTilesCache(int start)
                         break;
                     }
 
-                    // position on current floor
-                    //TODO: check position limits
-                    Position tilePos = cameraPosition.translated(ix - m_virtualCenterOffset.x, iy - m_virtualCenterOffset.y);
-                    // adjust tilePos to the wanted floor
-                    tilePos.coveredUp(cameraPosition.z - iz);
-                    if(const TilePtr& tile = g_map.getTile(tilePos)) {
+                    if(const TilePtr& tile = getTilesGridTile(ix, iy, iz, cameraPosition)) {
                         // skip tiles that have nothing
                         if(!tile->isDrawable())
                             continue;
                         // skip tiles that are completely behind another tile
-                        if(g_map.isCompletelyCovered(tilePos, m_cachedFirstVisibleFloor))
+                        if(isTilesGridTileCompletelyCovered(ix, iy, iz, cameraPosition))
                             continue;
                         m_cachedVisibleTiles.push_back(tile);
                     }
@@ -402,6 +410,134 @@ void MapView::updateVisibleTilesCache(int start)
         m_cachedFloorVisibleCreatures = g_map.getSightSpectators(cameraPosition, false);
 }
 
+void MapView::updateTilesGrid(const Position& cameraPosition)
+{
+    const int width = m_drawDimension.width();
+    const int height = m_drawDimension.height();
+    const int floors = m_cachedLastVisibleFloor - m_cachedFirstVisibleFloor + 1;
+
+    Point delta(cameraPosition.x - m_tilesGridCamera.x, cameraPosition.y - m_tilesGridCamera.y);
+    bool canShift = m_tilesGridValid &&
+                    m_tilesGridDimension == m_drawDimension &&
+                    m_tilesGridCenterOffset == m_virtualCenterOffset &&
+                    m_tilesGridFirstFloor == m_cachedFirstVisibleFloor &&
+                    m_tilesGridLastFloor == m_cachedLastVisibleFloor &&
+                    m_tilesGridCamera.z == cameraPosition.z;
+    if(canShift && delta.x == 0 && delta.y == 0)
+        return;
+
+    std::vector<TilePtr> grid(floors * width * height);
+    for(int iz = m_cachedFirstVisibleFloor; iz <= m_cachedLastVisibleFloor; ++iz) {
+        int floorIndex = (iz - m_cachedFirstVisibleFloor) * height;
+        for(int iy = 0; iy < height; ++iy) {
+            int oy = iy + delta.y;
+            for(int ix = 0; ix < width; ++ix) {
+                int ox = ix + delta.x;
+                TilePtr& cell = grid[(floorIndex + iy) * width + ix];
+                // cells still in view after the step are moved from the old grid, the others are looked up
+                if(canShift && ox >= 0 && ox < width && oy >= 0 && oy < height)
+                    cell.swap(m_tilesGrid[(floorIndex + oy) * width + ox]);
+                else
+                    cell = g_map.getTile(getTilesGridPosition(ix, iy, iz, cameraPosition));
+            }
+        }
+    }
+
+    m_tilesGrid.swap(grid);
+    m_tilesGridCamera = cameraPosition;
+    m_tilesGridDimension = m_drawDimension;
+    m_tilesGridCenterOffset = m_virtualCenterOffset;
+    m_tilesGridFirstFloor = m_cachedFirstVisibleFloor;
+    m_tilesGridLastFloor = m_cachedLastVisibleFloor;
+    m_tilesGridValid = true;
+
+#ifndef NDEBUG
+    // a shifted grid must be identical to the one a full rebuild would give
+    if(canShift)
+        assert(checkTilesGrid(cameraPosition));
+#endif
+}
+
+bool MapView::checkTilesGrid(const Position& cameraPosition)
+{
+    const int width = m_tilesGridDimension.width();
+    const int height = m_tilesGridDimension.height();
+    for(int iz = m_tilesGridFirstFloor; iz <= m_tilesGridLastFloor; ++iz) {
+        int floorIndex = (iz - m_tilesGridFirstFloor) * height;
+        for(int iy = 0; iy < height; ++iy) {
+            for(int ix = 0; ix < width; ++ix) {
+                if(m_tilesGrid[(floorIndex + iy) * width + ix] != g_map.getTile(getTilesGridPosition(ix, iy, iz, cameraPosition))) {
+                    g_logger.error(stdext::format("tiles grid cell %d,%d on floor %d differs from the map after a camera step", ix, iy, iz));
+                    return false;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+bool MapView::checkVisibleTilesCache()
+{
+    // shifts the tiles grid when the camera stepped since the last update
+    updateVisibleTilesCache();
+    std::vector<TilePtr> visibleTiles = m_cachedVisibleTiles;
+
+    Position cameraPosition = getCameraPosition();
+    bool gridMatches = m_viewMode > FAR_VIEW || !m_tilesGridValid || !cameraPosition.isValid() || checkTilesGrid(cameraPosition);
+
+    invalidateTilesGrid();
+    updateVisibleTilesCache();
+    if(visibleTiles != m_cachedVisibleTiles) {
+        g_logger.error(stdext::format("visible tiles differ from a full rebuild at %d,%d,%d", cameraPosition.x, cameraPosition.y, cameraPosition.z));
+        return false;
+    }
+    return gridMatches;
+}
+
+Position MapView::getTilesGridPosition(int ix, int iy, int iz, const Position& cameraPosition)
+{
+    // position on current floor
+    //TODO: check position limits
+    Position tilePos = cameraPosition.translated(ix - m_virtualCenterOffset.x, iy - m_virtualCenterOffset.y);
+    // adjust tilePos to the wanted floor
+    tilePos.coveredUp(cameraPosition.z - iz);
+    return tilePos;
+}
+
+const TilePtr& MapView::getTilesGridTile(int ix, int iy, int iz, const Position& cameraPosition)
+{
+    if(m_tilesGridValid && ix >= 0 && ix < m_tilesGridDimension.width() && iy >= 0 && iy < m_tilesGridDimension.height() &&
+       iz >= m_tilesGridFirstFloor && iz <= m_tilesGridLastFloor)
+        return m_tilesGrid[((iz - m_tilesGridFirstFloor) * m_tilesGridDimension.height() + iy) * m_tilesGridDimension.width() + ix];
+    return g_map.getTile(getTilesGridPosition(ix, iy, iz, cameraPosition));
+}
+
+bool MapView::isTilesGridTileCompletelyCovered(int ix, int iy, int iz, const Position& cameraPosition)
+{
+    // same as Map::isCompletelyCovered, a position covered up lands on the same cell of the floor above
+    const TilePtr& checkTile = getTilesGridTile(ix, iy, iz, cameraPosition);
+    Position tilePos = getTilesGridPosition(ix, iy, iz, cameraPosition);
+    while(tilePos.coveredUp() && tilePos.z >= m_cachedFirstVisibleFloor) {
+        bool covered = true;
+        bool done = false;
+        // check in 2x2 range tiles that has no transparent pixels
+        for(int x=0;x<2 && !done;++x) {
+            for(int y=0;y<2 && !done;++y) {
+                const TilePtr& tile = getTilesGridTile(ix - x, iy - y, tilePos.z, cameraPosition);
+                if(!tile || !tile->isFullyOpaque()) {
+                    covered = false;
+                    done = true;
+                } else if(x==0 && y==0 && (!checkTile || checkTile->isSingleDimension())) {
+                    done = true;
+                }
+            }
+        }
+        if(covered)
+            return true;
+    }
+    return false;
+}
+
 void MapView::updateGeometry(const Size& visibleDimension, const Size& optimizedSize)
 {
     int tileSize = 0;
@@ -467,6 +603,22 @@ void MapView::updateGeometry(const Size& visibleDimension, const Size& optimized
 
 void MapView::onTileUpdate(const Position& pos)
 {
+    // the tile of that position may have been created or removed, refresh its grid cell
+    if(m_tilesGridValid && pos.z >= m_tilesGridFirstFloor && pos.z <= m_tilesGridLastFloor) {
+        int offset = m_tilesGridCamera.z - pos.z;
+        int ix = pos.x - m_tilesGridCamera.x + m_tilesGridCenterOffset.x - offset;
+        int iy = pos.y - m_tilesGridCamera.y + m_tilesGridCenterOffset.y - offset;
+        if(ix >= 0 && ix < m_tilesGridDimension.width() && iy >= 0 && iy < m_tilesGridDimension.height()) {
+            int index = ((pos.z - m_tilesGridFirstFloor) * m_tilesGridDimension.height() + iy) * m_tilesGridDimension.width() + ix;
+            m_tilesGrid[index] = g_map.getTile(pos);
+        }
+    }
+    requestVisibleTilesCacheUpdate();
+}
+
+void MapView::onMapClean()
+{
+    invalidateTilesGrid();
     requestVisibleTilesCacheUpdate();
 }
 
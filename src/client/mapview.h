@@ -29,6 +29,7 @@
 #include <framework/luaengine/luaobject.h>
 #include <framework/core/declarations.h>
 #include "lightview.h"
+#include "creatureoverlay.h"
 
 // @bindclass
 class MapView : public LuaObject
@@ -50,9 +51,17 @@ private:
     void updateVisibleTilesCache(int start = 0);
     void requestVisibleTilesCacheUpdate() { m_mustUpdateVisibleTilesCache = true; }
 
+    void updateTilesGrid(const Position& cameraPosition);
+    Position getTilesGridPosition(int ix, int iy, int iz, const Position& cameraPosition);
+    const TilePtr& getTilesGridTile(int ix, int iy, int iz, const Position& cameraPosition);
+    bool isTilesGridTileCompletelyCovered(int ix, int iy, int iz, const Position& cameraPosition);
+    void invalidateTilesGrid() { m_tilesGridValid = false; m_tilesGrid.clear(); }
+    bool checkTilesGrid(const Position& cameraPosition);
+
 protected:
     void onTileUpdate(const Position& pos);
     void onMapCenterChange(const Position& pos);
+    void onMapClean();
 
     friend class Map;
 
@@ -108,6 +117,10 @@ public:
     void setDrawLights(bool enable);
     bool isDrawingLights() { return m_drawLights; }
 
+    // creature bars, names and icons drawn in the last frame
+    int getOverlayDrawCalls() { return m_creatureOverlay.getDrawCalls(); }
+    int getOverlayQuads() { return m_creatureOverlay.getQuads(); }
+
     void move(int x, int y);
 
     void setAnimated(bool animated) { m_animated = animated; requestVisibleTilesCacheUpdate(); }
@@ -120,6 +133,9 @@ public:
 
     Position getPosition(const Point& point, const Size& mapSize);
 
+    // updates the visible tiles like a draw would and compares them with a full rebuild
+    bool checkVisibleTilesCache();
+
     MapViewPtr asMapView() { return static_self_cast<MapView>(); }
 
 private:
@@ -157,6 +173,16 @@ private:
 
     stdext::boolean<true> m_follow;
     std::vector<TilePtr> m_cachedVisibleTiles;
+
+    // map tiles looked up for every draw cell of the visible floors, indexed by floor, row and column,
+    // camera steps shift it and only look up the cells entering the view
+    std::vector<TilePtr> m_tilesGrid;
+    Position m_tilesGridCamera;
+    Size m_tilesGridDimension;
+    Point m_tilesGridCenterOffset;
+    int m_tilesGridFirstFloor;
+    int m_tilesGridLastFloor;
+    stdext::boolean<false> m_tilesGridValid;
     std::vector<CreaturePtr> m_cachedFloorVisibleCreatures;
     CreaturePtr m_followingCreature;
     FrameBufferPtr m_framebuffer;
@@ -165,6 +191,7 @@ private:
     Otc::DrawFlags m_drawFlags;
     std::vector<Point> m_spiral;
     LightViewPtr m_lightView;
+    CreatureOverlay m_creatureOverlay;
     float m_minimumAmbientLight;
     Timer m_fadeTimer;
     PainterShaderProgramPtr m_nextShader;
@@ -79,10 +79,21 @@ void MinimapBlock::updateTile(int x, int y, const MinimapTile& tile)
 {
     if(m_tiles[getTileIndex(x,y)].color != tile.color)
         m_mustUpdate = true;
+    if(m_tiles[getTileIndex(x,y)] != tile)
+        m_dirty = true;
 
     m_tiles[getTileIndex(x,y)] = tile;
 }
 
+Minimap::Minimap()
+{
+    m_otmmFileSize = 0;
+    m_otmmDeadBytes = 0;
+    m_otmmAppendable = false;
+    m_memoryBudget = DEFAULT_MEMORY_BUDGET;
+    m_useTick = 0;
+}
+
 void Minimap::init()
 {
 }
@@ -96,6 +107,7 @@ void Minimap::clean()
 {
     for(int i=0;i<=Otc::MAX_Z;++i)
         m_tileBlocks[i].clear();
+    closeOtmm();
 }
 
 void Minimap::draw(const Rect& screenRect, const Position& mapCenter, float scale, const Color& color)
@@ -104,6 +116,7 @@ void Minimap::draw(const Rect& screenRect, const Position& mapCenter, float scal
         return;
 
     Rect mapRect = calcMapRect(screenRect, mapCenter, scale);
+    m_useTick++;
     g_painter->saveState();
     g_painter->setColor(color);
     g_painter->drawFilledRect(screenRect);
@@ -132,6 +145,7 @@ void Minimap::draw(const Rect& screenRect, const Position& mapCenter, float scal
                 continue;
 
             MinimapBlock& block = getBlock(Position(x, y, mapCenter.z));
+            block.touch(m_useTick);
             block.update();
 
             const TexturePtr& tex = block.getTexture();
@@ -147,6 +161,8 @@ void Minimap::draw(const Rect& screenRect, const Position& mapCenter, float scal
     }
 
     g_painter->restoreSavedState();
+
+    evictBlocks();
 }
 
 Point Minimap::getTilePoint(const Position& pos, const Rect& screenRect, const Position& mapCenter, float scale)
@@ -288,6 +304,7 @@ bool Minimap::loadImage(const std::string& fileName, const Position& topLeft, fl
                     tile.color = c;
                     tile.flags = flags;
                     block.mustUpdate();
+                    block.setDirty(true);
                 }
             }
         }
@@ -310,8 +327,6 @@ bool Minimap::loadOtmm(const std::string& fileName)
         if(!fin)
             stdext::throw_exception("unable to open file");
 
-        fin->cache();
-
         uint32 signature = fin->getU32();
         if(signature != OTMM_SIGNATURE)
             stdext::throw_exception("invalid OTMM file");
@@ -321,7 +336,8 @@ bool Minimap::loadOtmm(const std::string& fileName)
         fin->getU32(); // flags
 
         switch(version) {
-            case 1: {
+            case 1:
+            case 2: {
                 fin->getString(); // description
                 break;
             }
@@ -329,49 +345,89 @@ bool Minimap::loadOtmm(const std::string& fileName)
                 stdext::throw_exception("OTMM version not supported");
         }
 
+        closeOtmm();
         fin->seek(start);
 
-        uint blockSize = MMBLOCK_SIZE * MMBLOCK_SIZE * sizeof(MinimapTile);
-        std::vector<uchar> compressBuffer(compressBound(blockSize));
-
-        while(true) {
+        // only the block headers are read, the blocks themselves are inflated when used,
+        // a block written again later in the file replaces the previous copy
+        uint32 fileSize = fin->size();
+        bool terminated = false;
+        while(fin->tell() < fileSize) {
             Position pos;
             pos.x = fin->getU16();
             pos.y = fin->getU16();
             pos.z = fin->getU8();
 
-            // end of file
-            if(!pos.isValid())
+            // end of file, only version 1 has it
+            if(!pos.isValid()) {
+                terminated = true;
                 break;
+            }
 
-            MinimapBlock& block = getBlock(pos);
-            ulong len = fin->getU16();
-            ulong destLen = blockSize;
-            fin->read(compressBuffer.data(), len);
-            int ret = uncompress((uchar*)&block.getTiles(), &destLen, compressBuffer.data(), len);
-            assert(ret == Z_OK);
-            assert(destLen == blockSize);
-            block.mustUpdate();
-            block.justSaw();
+            BlockRecord record;
+            record.size = fin->getU16();
+            record.offset = fin->tell();
+            if(pos.z > Otc::MAX_Z || record.offset + record.size > fileSize)
+                stdext::throw_exception("invalid OTMM block");
+            fin->skip(record.size);
+
+            uint index = getBlockIndex(pos);
+            auto it = m_blockRecords[pos.z].find(index);
+            if(it != m_blockRecords[pos.z].end())
+                m_otmmDeadBytes += it->second.size + 7;
+            m_blockRecords[pos.z][index] = record;
+
+            // like before, the blocks in the file replace the ones already known
+            m_tileBlocks[pos.z].erase(index);
         }
 
-        fin->close();
+        m_otmmFile = fin;
+        m_otmmFileName = fileName;
+        m_otmmFileSize = fin->tell();
+        // new blocks can't be appended after the end marker of version 1 files
+        m_otmmAppendable = version == 2 && !terminated;
         return true;
     } catch(stdext::exception& e) {
         g_logger.error(stdext::format("failed to load OTMM minimap: %s", e.what()));
+        closeOtmm();
         return false;
     }
 }
 
 void Minimap::saveOtmm(const std::string& fileName)
 {
+    // while the file isn't mostly outdated copies, only the changed blocks are appended to it
+    if(fileName == m_otmmFileName && m_otmmAppendable && m_otmmDeadBytes <= m_otmmFileSize / 2) {
+        flushOtmm();
+        return;
+    }
+
     try {
         stdext::timer saveTimer;
 
+        // blocks not loaded are copied as they are, they must be read before the file is replaced
+        std::vector<std::pair<Position, std::string>> blocks;
+        for(uint8_t z = 0; z <= Otc::MAX_Z; ++z) {
+            for(auto& it : m_tileBlocks[z]) {
+                MinimapBlock& block = it.second;
+                if(!block.wasSeen())
+                    continue;
+                blocks.push_back(std::make_pair(getIndexPosition(it.first, z), compressBlock(block)));
+            }
+            for(auto& it : m_blockRecords[z]) {
+                if(m_tileBlocks[z].find(it.first) != m_tileBlocks[z].end())
+                    continue;
+                std::string data(it.second.size, '\0');
+                m_otmmFile->seek(it.second.offset);
+                if(m_otmmFile->read(&data[0], it.second.size) != 1)
+                    stdext::throw_exception("unable to read block");
+                blocks.push_back(std::make_pair(getIndexPosition(it.first, z), data));
+            }
+        }
+
         FileStreamPtr fin = g_resources.createFile(fileName);
         fin->cache();
 
-        //TODO: compression flag with zlib
         uint32 flags = 0;
 
         // header
@@ -380,8 +436,8 @@ void Minimap::saveOtmm(const std::string& fileName)
         fin->addU16(OTMM_VERSION);
         fin->addU32(flags);
 
-        // version 1 header
-        fin->addString("OTMM 1.0"); // description
+        // version 2 header
+        fin->addString("OTMM 2.0"); // description
 
         // go back and rewrite where the map data starts
         uint32 start = fin->tell();
@@ -389,40 +445,250 @@ void Minimap::saveOtmm(const std::string& fileName)
         fin->addU16(start);
         fin->seek(start);
 
-        uint blockSize = MMBLOCK_SIZE * MMBLOCK_SIZE * sizeof(MinimapTile);
-        std::vector<uchar> compressBuffer(compressBound(blockSize));
-        const int COMPRESS_LEVEL = 3;
+        // version 2 has no end marker, so changed blocks can be appended later
+        std::vector<BlockRecord> records(blocks.size());
+        for(uint i = 0; i < blocks.size(); ++i)
+            writeBlock(fin, blocks[i].first, blocks[i].second, records[i]);
+
+        fin->flush();
+        uint32 fileSize = fin->tell();
+        fin->close();
 
+        // the new file backs the minimap from now on
+        closeOtmm();
+        for(uint i = 0; i < blocks.size(); ++i) {
+            const Position& pos = blocks[i].first;
+            m_blockRecords[pos.z][getBlockIndex(pos)] = records[i];
+        }
+        for(uint8_t z = 0; z <= Otc::MAX_Z; ++z) {
+            for(auto& it : m_tileBlocks[z])
+                it.second.setDirty(false);
+        }
+        m_otmmFile = g_resources.openFile(fileName);
+        m_otmmFileName = fileName;
+        m_otmmFileSize = fileSize;
+        m_otmmAppendable = true;
+    } catch(stdext::exception& e) {
+        g_logger.error(stdext::format("failed to save OTMM minimap: %s", e.what()));
+    }
+}
+
+void Minimap::flushOtmm()
+{
+    if(!m_otmmFile)
+        return;
+
+    if(!m_otmmAppendable) {
+        saveOtmm(m_otmmFileName);
+        return;
+    }
+
+    try {
+        FileStreamPtr fin;
         for(uint8_t z = 0; z <= Otc::MAX_Z; ++z) {
             for(auto& it : m_tileBlocks[z]) {
-                int index = it.first;
                 MinimapBlock& block = it.second;
-                if(!block.wasSeen())
+                if(!block.isDirty() || !block.wasSeen())
                     continue;
 
-                Position pos = getIndexPosition(index, z);
-                fin->addU16(pos.x);
-                fin->addU16(pos.y);
-                fin->addU8(pos.z);
+                if(!fin) {
+                    fin = g_resources.appendFile(m_otmmFileName);
+                    if(!fin)
+                        stdext::throw_exception("unable to open file");
+                }
+
+                BlockRecord& record = m_blockRecords[z][it.first];
+                if(record.size > 0)
+                    m_otmmDeadBytes += record.size + 7;
+
+                // the append handle starts at the end of the file, so the offsets it reports are absolute
+                writeBlock(fin, getIndexPosition(it.first, z), compressBlock(block), record);
+                m_otmmFileSize = record.offset + record.size;
+                block.setDirty(false);
 
-                ulong len = blockSize;
-                int ret = compress2(compressBuffer.data(), &len, (uchar*)&block.getTiles(), blockSize, COMPRESS_LEVEL);
-                assert(ret == Z_OK);
-                fin->addU16(len);
-                fin->write(compressBuffer.data(), len);
+#ifndef NDEBUG
+                // the block must read back as it is, like it will after being evicted
+                fin->flush();
+                assert(checkBlockRecord(block, record));
+#endif
             }
         }
-    
-        // end of file
-        Position invalidPos;
-        fin->addU16(invalidPos.x);
-        fin->addU16(invalidPos.y);
-        fin->addU8(invalidPos.z);
-
-        fin->flush();
 
-        fin->close();
+        if(fin) {
+            fin->flush();
+            fin->close();
+        }
     } catch(stdext::exception& e) {
         g_logger.error(stdext::format("failed to save OTMM minimap: %s", e.what()));
+        // the file can't be trusted to match the records anymore
+        m_otmmAppendable = false;
+    }
+}
+
+int Minimap::getLoadedBlocks()
+{
+    int count = 0;
+    for(int z = 0; z <= Otc::MAX_Z; ++z)
+        count += m_tileBlocks[z].size();
+    return count;
+}
+
+int Minimap::getStoredBlocks()
+{
+    int count = 0;
+    for(int z = 0; z <= Otc::MAX_Z; ++z)
+        count += m_blockRecords[z].size();
+    return count;
+}
+
+bool Minimap::hasBlock(const Position& pos)
+{
+    uint index = getBlockIndex(pos);
+    return m_tileBlocks[pos.z].find(index) != m_tileBlocks[pos.z].end() ||
+           m_blockRecords[pos.z].find(index) != m_blockRecords[pos.z].end();
+}
+
+MinimapBlock& Minimap::getBlock(const Position& pos)
+{
+    uint index = getBlockIndex(pos);
+    auto it = m_tileBlocks[pos.z].find(index);
+    if(it != m_tileBlocks[pos.z].end())
+        return it->second;
+
+    MinimapBlock& block = m_tileBlocks[pos.z][index];
+    block.touch(m_useTick);
+
+    auto recordIt = m_blockRecords[pos.z].find(index);
+    if(recordIt != m_blockRecords[pos.z].end()) {
+        try {
+            loadBlock(block, recordIt->second);
+        } catch(stdext::exception& e) {
+            g_logger.error(stdext::format("failed to load OTMM block: %s", e.what()));
+            block.clean();
+            m_blockRecords[pos.z].erase(recordIt);
+        }
+    }
+    return block;
+}
+
+void Minimap::loadBlock(MinimapBlock& block, const BlockRecord& record)
+{
+    uint blockSize = MMBLOCK_SIZE * MMBLOCK_SIZE * sizeof(MinimapTile);
+    std::vector<uchar> compressBuffer(record.size);
+
+    m_otmmFile->seek(record.offset);
+    if(m_otmmFile->read(compressBuffer.data(), record.size) != 1)
+        stdext::throw_exception("unable to read block");
+
+    ulong destLen = blockSize;
+    int ret = uncompress((uchar*)&block.getTiles(), &destLen, compressBuffer.data(), record.size);
+    if(ret != Z_OK || destLen != blockSize)
+        stdext::throw_exception("corrupted block");
+
+    block.mustUpdate();
+    block.justSaw();
+}
+
+void Minimap::writeBlock(const FileStreamPtr& fin, const Position& pos, const std::string& data, BlockRecord& record)
+{
+    fin->addU16(pos.x);
+    fin->addU16(pos.y);
+    fin->addU8(pos.z);
+    fin->addU16(data.size());
+    record.offset = fin->tell();
+    record.size = data.size();
+    fin->write(data.data(), data.size());
+}
+
+#ifndef NDEBUG
+bool Minimap::checkBlockRecord(MinimapBlock& block, const BlockRecord& record)
+{
+    MinimapBlock stored;
+    loadBlock(stored, record);
+    return memcmp(stored.getTiles().data(), block.getTiles().data(), sizeof(block.getTiles())) == 0;
+}
+#endif
+
+std::string Minimap::compressBlock(MinimapBlock& block)
+{
+    const int COMPRESS_LEVEL = 3;
+    uint blockSize = MMBLOCK_SIZE * MMBLOCK_SIZE * sizeof(MinimapTile);
+    ulong len = compressBound(blockSize);
+    std::string data(len, '\0');
+    int ret = compress2((uchar*)&data[0], &len, (uchar*)&block.getTiles(), blockSize, COMPRESS_LEVEL);
+    if(ret != Z_OK)
+        stdext::throw_exception("unable to compress block");
+    data.resize(len);
+    return data;
+}
+
+void Minimap::evictBlocks()
+{
+    uint maxBlocks = m_memoryBudget / BLOCK_MEMORY;
+    uint loadedBlocks = getLoadedBlocks();
+    if(loadedBlocks <= maxBlocks)
+        return;
+
+    // without a file to page from, every block must stay loaded, only their textures can go
+    if(!m_otmmFile) {
+        for(int z = 0; z <= Otc::MAX_Z; ++z) {
+            for(auto& it : m_tileBlocks[z]) {
+                MinimapBlock& block = it.second;
+                if(block.getTexture() && m_useTick - block.getLastUse() > TEXTURE_IDLE_TICKS)
+                    block.releaseTexture();
+            }
+        }
+        return;
+    }
+
+    // write changes first, evicted blocks are read back from the file
+    bool hasDirty = false;
+    for(int z = 0; z <= Otc::MAX_Z && !hasDirty; ++z) {
+        for(auto& it : m_tileBlocks[z]) {
+            if(it.second.isDirty() && it.second.wasSeen()) {
+                hasDirty = true;
+                break;
+            }
+        }
+    }
+    if(hasDirty)
+        flushOtmm();
+
+    struct Candidate {
+        uint lastUse;
+        int z;
+        uint index;
+        bool operator<(const Candidate& other) const { return lastUse < other.lastUse; }
+    };
+    std::vector<Candidate> candidates;
+    candidates.reserve(loadedBlocks);
+    for(int z = 0; z <= Otc::MAX_Z; ++z) {
+        for(auto& it : m_tileBlocks[z]) {
+            MinimapBlock& block = it.second;
+            // blocks drawn this frame and blocks that couldn't be written are kept
+            if(block.getLastUse() == m_useTick || (block.isDirty() && block.wasSeen()))
+                continue;
+            candidates.push_back(Candidate{block.getLastUse(), z, it.first});
+        }
+    }
+
+    // drop a bit more than needed so this doesn't run on every frame
+    uint evictCount = std::min<uint>(loadedBlocks - maxBlocks * 3 / 4, candidates.size());
+    std::partial_sort(candidates.begin(), candidates.begin() + evictCount, candidates.end());
+    for(uint i = 0; i < evictCount; ++i)
+        m_tileBlocks[candidates[i].z].erase(candidates[i].index);
+}
+
+void Minimap::closeOtmm()
+{
+    for(int z = 0; z <= Otc::MAX_Z; ++z)
+        m_blockRecords[z].clear();
+    if(m_otmmFile) {
+        m_otmmFile->close();
+        m_otmmFile = nullptr;
     }
+    m_otmmFileName.clear();
+    m_otmmFileSize = 0;
+    m_otmmDeadBytes = 0;
+    m_otmmAppendable = false;
 }
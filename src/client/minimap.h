@@ -26,11 +26,12 @@
 
 #include "declarations.h"
 #include <framework/graphics/declarations.h>
+#include <framework/core/declarations.h>
 
 enum {
     MMBLOCK_SIZE = 64,
     OTMM_SIGNATURE = 0x4D4d544F,
-    OTMM_VERSION = 1
+    OTMM_VERSION = 2
 };
 
 enum MinimapTileFlags {
@@ -55,6 +56,8 @@ struct MinimapTile
 class MinimapBlock
 {
 public:
+    MinimapBlock() : m_lastUse(0) { }
+
     void clean();
     void update();
     void updateTile(int x, int y, const MinimapTile& tile);
@@ -62,23 +65,49 @@ public:
     void resetTile(int x, int y) { m_tiles[getTileIndex(x,y)] = MinimapTile(); }
     uint getTileIndex(int x, int y) { return ((y % MMBLOCK_SIZE) * MMBLOCK_SIZE) + (x % MMBLOCK_SIZE); }
     const TexturePtr& getTexture() { return m_texture; }
+    // the texture is built again from the tiles when the block is drawn
+    void releaseTexture() { m_texture = nullptr; m_mustUpdate = true; }
     std::array<MinimapTile, MMBLOCK_SIZE *MMBLOCK_SIZE>& getTiles() { return m_tiles; }
     void mustUpdate() { m_mustUpdate = true; }
     void justSaw() { m_wasSeen = true; }
     bool wasSeen() { return m_wasSeen; }
+    // changed since it was last written to the otmm file
+    void setDirty(bool dirty) { m_dirty = dirty; }
+    bool isDirty() { return m_dirty; }
+    void touch(uint tick) { m_lastUse = tick; }
+    uint getLastUse() { return m_lastUse; }
 private:
     TexturePtr m_texture;
     std::array<MinimapTile, MMBLOCK_SIZE *MMBLOCK_SIZE> m_tiles;
     stdext::boolean<true> m_mustUpdate;
     stdext::boolean<false> m_wasSeen;
+    stdext::boolean<false> m_dirty;
+    uint m_lastUse;
 };
 
 #pragma pack(pop)
 
+// Blocks of an attached otmm file are only inflated when drawn or queried, and the least recently
+// drawn ones are evicted when the loaded blocks exceed the memory budget
 class Minimap
 {
+    enum {
+        DEFAULT_MEMORY_BUDGET = 64 * 1024 * 1024,
+        // tiles plus the mipmapped texture
+        BLOCK_MEMORY = MMBLOCK_SIZE * MMBLOCK_SIZE * (sizeof(MinimapTile) + 4 * 4 / 3),
+        // draws a block must miss before its texture can be released
+        TEXTURE_IDLE_TICKS = 300
+    };
+
+    // latest copy of a block in the otmm file
+    struct BlockRecord {
+        uint32 offset;
+        uint16 size;
+    };
 
 public:
+    Minimap();
+
     void init();
     void terminate();
 
@@ -96,17 +125,39 @@ public:
     void saveImage(const std::string& fileName, const Rect& mapRect);
     bool loadOtmm(const std::string& fileName);
     void saveOtmm(const std::string& fileName);
+    void flushOtmm();
+
+    void setMemoryBudget(int bytes) { m_memoryBudget = std::max<int>(bytes, BLOCK_MEMORY); }
+    int getMemoryBudget() { return m_memoryBudget; }
+    int getLoadedBlocks();
+    int getStoredBlocks();
 
 private:
     Rect calcMapRect(const Rect& screenRect, const Position& mapCenter, float scale);
-    bool hasBlock(const Position& pos) { return m_tileBlocks[pos.z].find(getBlockIndex(pos)) != m_tileBlocks[pos.z].end(); }
-    MinimapBlock& getBlock(const Position& pos) { return m_tileBlocks[pos.z][getBlockIndex(pos)]; }
+    bool hasBlock(const Position& pos);
+    MinimapBlock& getBlock(const Position& pos);
+    void loadBlock(MinimapBlock& block, const BlockRecord& record);
+    void writeBlock(const FileStreamPtr& fin, const Position& pos, const std::string& data, BlockRecord& record);
+    std::string compressBlock(MinimapBlock& block);
+#ifndef NDEBUG
+    bool checkBlockRecord(MinimapBlock& block, const BlockRecord& record);
+#endif
+    void evictBlocks();
+    void closeOtmm();
     Point getBlockOffset(const Point& pos) { return Point(pos.x - pos.x % MMBLOCK_SIZE,
                                                           pos.y - pos.y % MMBLOCK_SIZE); }
     Position getIndexPosition(int index, int z) { return Position((index % (65536 / MMBLOCK_SIZE))*MMBLOCK_SIZE,
                                                                   (index / (65536 / MMBLOCK_SIZE))*MMBLOCK_SIZE, z); }
     uint getBlockIndex(const Position& pos) { return ((pos.y / MMBLOCK_SIZE) * (65536 / MMBLOCK_SIZE)) + (pos.x / MMBLOCK_SIZE); }
     std::unordered_map<uint, MinimapBlock> m_tileBlocks[Otc::MAX_Z+1];
+    std::unordered_map<uint, BlockRecord> m_blockRecords[Otc::MAX_Z+1];
+    FileStreamPtr m_otmmFile;
+    std::string m_otmmFileName;
+    uint32 m_otmmFileSize;
+    uint32 m_otmmDeadBytes;
+    bool m_otmmAppendable;
+    int m_memoryBudget;
+    uint m_useTick;
 };
 
 extern Minimap g_minimap;
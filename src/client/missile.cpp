@@ -23,9 +23,9 @@
 #include "missile.h"
 #include "thingtypemanager.h"
 #include "map.h"
+#include "animationscheduler.h"
 #include "tile.h"
 #include <framework/core/clock.h>
-#include <framework/core/eventdispatcher.h>
 
 void Missile::draw(const Point& dest, float scaleFactor, bool animate, LightView *lightView)
 {
@@ -77,8 +77,7 @@ void Missile::setPath(const Position& fromPosition, const Position& toPosition)
     m_animationTimer.restart();
 
     // schedule removal
-    auto self = asMissile();
-    g_dispatcher.scheduleEvent([self]() { g_map.removeThing(self); }, m_duration);
+    g_animations.scheduleRemoval(asMissile(), m_duration);
 }
 
 void Missile::setId(uint32 id)
@@ -26,6 +26,10 @@
 #include "item.h"
 #include "localplayer.h"
 
+std::bitset<256> ProtocolGame::s_luaOpcodes;
+uint64 ProtocolGame::s_luaPathOpcodes = 0;
+uint64 ProtocolGame::s_fastPathOpcodes = 0;
+
 void ProtocolGame::login(const std::string& accountName, const std::string& accountPassword, const std::string& host, uint16 port, const std::string& characterName)
 {
     m_accountName = accountName;
@@ -65,10 +69,29 @@ void ProtocolGame::onRecv(const InputMessagePtr& inputMessage)
         }
     }
 
+    if(m_recording) {
+        int readPos = inputMessage->getReadPos();
+        std::string packet(inputMessage->getUnreadSize(), '\0');
+        for(char& byte : packet)
+            byte = inputMessage->getU8();
+        inputMessage->setReadPos(readPos);
+        m_recordedMessages.push_back(packet);
+    }
+
     parseMessage(inputMessage);
     recv();
 }
 
+void ProtocolGame::replayRecordedMessages()
+{
+    // the game state is moved back to the recorded one, packets received meanwhile are not taken into account
+    InputMessagePtr msg(new InputMessage);
+    for(const std::string& packet : m_recordedMessages) {
+        msg->setBuffer(packet);
+        parseMessage(msg);
+    }
+}
+
 void ProtocolGame::onError(const boost::system::error_code& error)
 {
     g_game.processConnectionError(error);
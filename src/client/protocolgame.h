@@ -28,6 +28,8 @@
 #include <framework/net/protocol.h>
 #include "creature.h"
 
+#include <bitset>
+
 class ProtocolGame : public Protocol
 {
 public:
@@ -114,6 +116,20 @@ public:
     // otclient only
     void sendChangeMapAwareRange(int xrange, int yrange);
 
+    // only opcodes registered by lua modules are offered to onOpcode, the others go straight to the built-in parsers
+    static void setLuaOpcode(uint8 opcode, bool enable) { s_luaOpcodes[opcode] = enable; }
+    static bool isLuaOpcode(uint8 opcode) { return s_luaOpcodes[opcode]; }
+    static uint64 getLuaPathOpcodes() { return s_luaPathOpcodes; }
+    static uint64 getFastPathOpcodes() { return s_fastPathOpcodes; }
+    static void resetOpcodeCounters() { s_luaPathOpcodes = 0; s_fastPathOpcodes = 0; }
+
+    // received packets are kept while recording, replaying parses them again to benchmark the parsers
+    void setRecording(bool enable) { m_recording = enable; }
+    bool isRecording() { return m_recording; }
+    int getRecordedMessages() { return m_recordedMessages.size(); }
+    void clearRecordedMessages() { m_recordedMessages.clear(); }
+    void replayRecordedMessages();
+
 protected:
     void onConnect();
     void onRecv(const InputMessagePtr& inputMessage);
@@ -233,10 +249,16 @@ private:
     stdext::boolean<false> m_gameInitialized;
     stdext::boolean<false> m_mapKnown;
     stdext::boolean<true> m_firstRecv;
+    stdext::boolean<false> m_recording;
+    std::vector<std::string> m_recordedMessages;
     std::string m_accountName;
     std::string m_accountPassword;
     std::string m_characterName;
     LocalPlayerPtr m_localPlayer;
+
+    static std::bitset<256> s_luaOpcodes;
+    static uint64 s_luaPathOpcodes;
+    static uint64 s_fastPathOpcodes;
 };
 
 #endif
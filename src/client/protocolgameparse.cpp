@@ -50,12 +50,17 @@ void ProtocolGame::parseMessage(const InputMessagePtr& msg)
                 }
             }
 
-            // try to parse in lua first
-            int readPos = msg->getReadPos();
-            if(callLuaField<bool>("onOpcode", opcode, msg))
-                continue;
-            else
-                msg->setReadPos(readPos); // restore read pos
+            // try to parse in lua first, when a module registered this opcode
+            if(s_luaOpcodes[opcode]) {
+                s_luaPathOpcodes++;
+                int readPos = msg->getReadPos();
+                static const int onOpcodeField = g_lua.internKey("onOpcode");
+                if(callLuaField<bool>(onOpcodeField, opcode, msg))
+                    continue;
+                else
+                    msg->setReadPos(readPos); // restore read pos
+            } else
+                s_fastPathOpcodes++;
 
             switch(opcode) {
             case Proto::GameServerLoginOrPendingState:
@@ -334,6 +339,17 @@ void ProtocolGame::parseMessage(const InputMessagePtr& msg)
                 parseChangeMapAwareRange(msg);
                 break;
             default:
+                // there is no built-in parser, an onOpcode override may still take it without having registered it
+                if(!s_luaOpcodes[opcode]) {
+                    int readPos = msg->getReadPos();
+                    if(callLuaField<bool>("onOpcode", opcode, msg)) {
+                        g_logger.warning(stdext::format("opcode %d was parsed by an onOpcode handler that did not register it with ProtocolGame.setLuaOpcode", (int)opcode));
+                        s_luaOpcodes[opcode] = true;
+                        prevOpcode = opcode;
+                        continue;
+                    }
+                    msg->setReadPos(readPos);
+                }
                 stdext::throw_exception(stdext::format("unhandled opcode %d", (int)opcode));
                 break;
             }
@@ -24,14 +24,127 @@
 #include "game.h"
 #include <framework/core/resourcemanager.h>
 #include <framework/core/filestream.h>
+#include <framework/core/mappedfile.h>
 #include <framework/graphics/image.h>
 
+#if defined(__SSSE3__)
+#include <tmmintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
 SpriteManager g_sprites;
 
+enum {
+    SPRITE_SIZE = 32,
+    SPRITE_DATA_SIZE = SPRITE_SIZE*SPRITE_SIZE*4
+};
+
+// byte by byte version of expandColoredPixels, also used for the pixels left over by the vector loop
+static void expandColoredPixelsScalar(const uint8 *in, uint8 *out, int count)
+{
+    int i = 0;
+    // one word per pixel, the last pixel can't read ahead so it is copied by bytes
+    for(; i + 1 < count; ++i)
+        stdext::writeLE32(out + i*4, stdext::readLE32(in + i*3) | 0xFF000000);
+    for(; i < count; ++i) {
+        out[i*4 + 0] = in[i*3 + 0];
+        out[i*4 + 1] = in[i*3 + 1];
+        out[i*4 + 2] = in[i*3 + 2];
+        out[i*4 + 3] = 0xFF;
+    }
+}
+
+// expands count packed RGB pixels into opaque RGBA pixels, the input must have at least count*3 bytes
+static void expandColoredPixels(const uint8 *in, uint8 *out, int count)
+{
+    int i = 0;
+#if defined(__SSSE3__)
+    // 4 pixels per step, the 16 bytes load reads 4 bytes ahead of the 12 used ones
+    const __m128i shuffle = _mm_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+    const __m128i alpha = _mm_set1_epi32(0xFF000000);
+    for(; i + 6 <= count; i += 4) {
+        __m128i rgb = _mm_loadu_si128((const __m128i*)(in + i*3));
+        _mm_storeu_si128((__m128i*)(out + i*4), _mm_or_si128(_mm_shuffle_epi8(rgb, shuffle), alpha));
+    }
+#elif defined(__SSE2__)
+    // 4 pixels per step, each 64 bits half holds 2 pixels: the first one is masked in place
+    // and the second one is shifted up by a byte into the next dword, the loads read 2 bytes ahead
+    const __m128i lowMask = _mm_set_epi32(0, 0x00FFFFFF, 0, 0x00FFFFFF);
+    const __m128i highMask = _mm_set_epi32(0x00FFFFFF, 0, 0x00FFFFFF, 0);
+    const __m128i alpha = _mm_set1_epi32(0xFF000000);
+    for(; i + 6 <= count; i += 4) {
+        __m128i rgb = _mm_unpacklo_epi64(_mm_loadl_epi64((const __m128i*)(in + i*3)),
+                                         _mm_loadl_epi64((const __m128i*)(in + i*3 + 6)));
+        __m128i rgba = _mm_or_si128(_mm_and_si128(rgb, lowMask), _mm_and_si128(_mm_slli_epi64(rgb, 8), highMask));
+        _mm_storeu_si128((__m128i*)(out + i*4), _mm_or_si128(rgba, alpha));
+    }
+#endif
+    expandColoredPixelsScalar(in + i*3, out + i*4, count - i);
+}
+
+#ifndef NDEBUG
+// checks the vector path against the scalar one for every run length up to a few steps long
+static bool checkExpandColoredPixels()
+{
+    uint8 in[64*3];
+    uint8 vectorOut[64*4];
+    uint8 scalarOut[64*4];
+    for(uint i = 0; i < sizeof(in); ++i)
+        in[i] = (uint8)(i * 37 + 11);
+
+    for(int count = 0; count <= 64; ++count) {
+        memset(vectorOut, 0, sizeof(vectorOut));
+        memset(scalarOut, 0, sizeof(scalarOut));
+        expandColoredPixels(in, vectorOut, count);
+        expandColoredPixelsScalar(in, scalarOut, count);
+        if(memcmp(vectorOut, scalarOut, sizeof(vectorOut)) != 0)
+            return false;
+    }
+    return true;
+}
+#endif
+
+// decodes the run length encoded pixel data of a sprite into SPRITE_DATA_SIZE bytes of RGBA
+static void decodeSpritePixels(const uint8 *in, uint size, uint8 *pixels, bool vectorized)
+{
+    const uint8 *inEnd = in + size;
+    uint8 *out = pixels;
+    uint8 *outEnd = pixels + SPRITE_DATA_SIZE;
+
+    while(in + 4 <= inEnd && out < outEnd) {
+        int transparentPixels = stdext::readLE16(in);
+        int coloredPixels = stdext::readLE16(in + 2);
+        in += 4;
+
+        int transparentBytes = std::min<int>(transparentPixels * 4, outEnd - out);
+        memset(out, 0, transparentBytes);
+        out += transparentBytes;
+
+        coloredPixels = std::min<int>(coloredPixels, std::min<int>((outEnd - out) / 4, (inEnd - in) / 3));
+        if(vectorized)
+            expandColoredPixels(in, out, coloredPixels);
+        else
+            expandColoredPixelsScalar(in, out, coloredPixels);
+        in += coloredPixels * 3;
+        out += coloredPixels * 4;
+    }
+
+    // fill remaining pixels with alpha
+    if(out < outEnd)
+        memset(out, 0, outEnd - out);
+}
+
 SpriteManager::SpriteManager()
 {
     m_spritesCount = 0;
     m_signature = 0;
+    m_cacheSize = 4096;
+    m_generation = 0;
+
+#ifndef NDEBUG
+    assert(checkExpandColoredPixels());
+#endif
 }
 
 void SpriteManager::terminate()
@@ -41,19 +154,42 @@ void SpriteManager::terminate()
 
 bool SpriteManager::loadSpr(std::string file)
 {
+    std::lock_guard<std::recursive_mutex> lock(m_mutex);
+    std::lock_guard<std::mutex> fileLock(m_fileMutex);
     m_spritesCount = 0;
     m_signature = 0;
     m_loaded = false;
+    clearCache();
     try {
         file = g_resources.guessFilePath(file, "spr");
 
-        m_spritesFile = g_resources.openFile(file);
-        // cache file buffer to avoid lags from hard drive
-        m_spritesFile->cache();
+        m_spritesFile = nullptr;
+        m_spritesMap = nullptr;
+
+        // map the file straight from disk when possible, so sprites are paged in on demand
+        m_spritesMap = g_resources.mapFile(file);
+        if(m_spritesMap) {
+            const uint8 *data = m_spritesMap->data();
+            bool u32Count = g_game.getFeature(Otc::GameSpritesU32);
+            m_spritesOffset = u32Count ? 8 : 6;
+            if(!m_spritesMap->canRead(0, m_spritesOffset))
+                stdext::throw_exception("file too small");
+
+            m_signature = stdext::readLE32(data);
+            uint32 spritesCount = u32Count ? stdext::readLE32(data + 4) : stdext::readLE16(data + 4);
+            // compared by entries, a byte size could overflow for corrupt counts
+            if(spritesCount > (m_spritesMap->size() - m_spritesOffset) / 4)
+                stdext::throw_exception("truncated sprite offset table");
+            m_spritesCount = spritesCount;
+        } else {
+            // files inside packages can't be mapped, cache file buffer to avoid lags from hard drive
+            m_spritesFile = g_resources.openFile(file);
+            m_spritesFile->cache();
 
-        m_signature = m_spritesFile->getU32();
-        m_spritesCount = g_game.getFeature(Otc::GameSpritesU32) ? m_spritesFile->getU32() : m_spritesFile->getU16();
-        m_spritesOffset = m_spritesFile->tell();
+            m_signature = m_spritesFile->getU32();
+            m_spritesCount = g_game.getFeature(Otc::GameSpritesU32) ? m_spritesFile->getU32() : m_spritesFile->getU16();
+            m_spritesOffset = m_spritesFile->tell();
+        }
         m_loaded = true;
         return true;
     } catch(stdext::exception& e) {
@@ -64,82 +200,147 @@ bool SpriteManager::loadSpr(std::string file)
 
 void SpriteManager::unload()
 {
+    std::lock_guard<std::recursive_mutex> lock(m_mutex);
+    std::lock_guard<std::mutex> fileLock(m_fileMutex);
     m_spritesCount = 0;
     m_signature = 0;
     m_spritesFile = nullptr;
+    m_spritesMap = nullptr;
+    clearCache();
+}
+
+void SpriteManager::setCacheSize(int size)
+{
+    std::lock_guard<std::recursive_mutex> lock(m_mutex);
+    m_cacheSize = std::max<int>(size, 0);
+    while((int)m_cache.size() > m_cacheSize) {
+        m_cache.erase(m_cacheOrder.back());
+        m_cacheOrder.pop_back();
+    }
+}
+
+void SpriteManager::clearCache()
+{
+    std::lock_guard<std::recursive_mutex> lock(m_mutex);
+    m_generation++;
+    m_cache.clear();
+    m_cacheOrder.clear();
 }
 
 ImagePtr SpriteManager::getSpriteImage(int id)
 {
     try {
-        enum {
-            SPRITE_SIZE = 32,
-            SPRITE_DATA_SIZE = SPRITE_SIZE*SPRITE_SIZE*4
-        };
+        return loadSpriteImage(id);
+    } catch(stdext::exception& e) {
+        g_logger.error(stdext::format("Failed to get sprite id %d: %s", id, e.what()));
+        return nullptr;
+    }
+}
 
-        if(id == 0 || !m_spritesFile)
+ImagePtr SpriteManager::loadSpriteImage(int id)
+{
+    uint generation;
+    {
+        std::lock_guard<std::recursive_mutex> lock(m_mutex);
+        if(id <= 0 || id > m_spritesCount)
             return nullptr;
 
-        m_spritesFile->seek(((id-1) * 4) + m_spritesOffset);
+        // images are copied out of the cache because callers are free to modify them
+        auto it = m_cache.find(id);
+        if(it != m_cache.end()) {
+            CachedSprite& cached = it->second;
+            m_cacheOrder.splice(m_cacheOrder.begin(), m_cacheOrder, cached.orderIt);
+            if(cached.pixels.empty())
+                return nullptr;
+            return ImagePtr(new Image(Size(SPRITE_SIZE, SPRITE_SIZE), 4, &cached.pixels[0]));
+        }
+        generation = m_generation;
+    }
 
-        uint32 spriteAddress = m_spritesFile->getU32();
+    // only reading the file is serialized, texture builds decode their sprites in parallel
+    ImagePtr image;
+    std::vector<uint8> pixelData;
+    bool found;
+    {
+        std::lock_guard<std::mutex> lock(m_fileMutex);
+        found = m_spritesMap ? readMappedSprite(id, pixelData) : readStreamSprite(id, pixelData);
+    }
+    if(found) {
+        image = ImagePtr(new Image(Size(SPRITE_SIZE, SPRITE_SIZE)));
+        decodeSpritePixels(pixelData.data(), pixelData.size(), image->getPixelData(), m_vectorDecoding);
+    }
 
-        // no sprite? return an empty texture
-        if(spriteAddress == 0)
-            return nullptr;
+    std::lock_guard<std::recursive_mutex> lock(m_mutex);
+    // skip the cache when the sprites were reloaded meanwhile or another thread decoded it first
+    if(m_cacheSize > 0 && generation == m_generation && !m_cache.count(id)) {
+        if((int)m_cache.size() >= m_cacheSize) {
+            m_cache.erase(m_cacheOrder.back());
+            m_cacheOrder.pop_back();
+        }
+        m_cacheOrder.push_front(id);
+        CachedSprite& cached = m_cache[id];
+        cached.orderIt = m_cacheOrder.begin();
+        if(image)
+            cached.pixels = image->getPixels();
+    }
+    return image;
+}
+
+std::string SpriteManager::getSpritePixels(int id)
+{
+    ImagePtr image = getSpriteImage(id);
+    if(!image)
+        return std::string();
+    const std::vector<uint8>& pixels = image->getPixels();
+    return std::string(pixels.begin(), pixels.end());
+}
 
-        m_spritesFile->seek(spriteAddress);
+bool SpriteManager::readMappedSprite(int id, std::vector<uint8>& pixelData)
+{
+    if(id > m_spritesCount)
+        return false;
 
-        // skip color key
-        m_spritesFile->getU8();
-        m_spritesFile->getU8();
-        m_spritesFile->getU8();
+    const uint8 *data = m_spritesMap->data();
+    uint32 spriteAddress = stdext::readLE32(data + m_spritesOffset + (id-1) * 4);
 
-        uint16 pixelDataSize = m_spritesFile->getU16();
+    // no sprite? return an empty texture
+    if(spriteAddress == 0)
+        return false;
 
-        ImagePtr image(new Image(Size(SPRITE_SIZE, SPRITE_SIZE)));
+    // 3 bytes of color key followed by the pixel data size
+    if(!m_spritesMap->canRead(spriteAddress, 5))
+        stdext::throw_exception("invalid sprite address");
 
-        uint8 *pixels = image->getPixelData();
-        int writePos = 0;
-        int read = 0;
+    uint16 pixelDataSize = stdext::readLE16(data + spriteAddress + 3);
+    if(!m_spritesMap->canRead(spriteAddress + 5, pixelDataSize))
+        stdext::throw_exception("truncated pixel data");
 
-        // decompress pixels
-        while(read < pixelDataSize && writePos < SPRITE_DATA_SIZE) {
-            uint16 transparentPixels = m_spritesFile->getU16();
-            uint16 coloredPixels = m_spritesFile->getU16();
+    pixelData.assign(data + spriteAddress + 5, data + spriteAddress + 5 + pixelDataSize);
+    return true;
+}
 
-            for(int i = 0; i < transparentPixels && writePos < SPRITE_DATA_SIZE; i++) {
-                pixels[writePos + 0] = 0x00;
-                pixels[writePos + 1] = 0x00;
-                pixels[writePos + 2] = 0x00;
-                pixels[writePos + 3] = 0x00;
-                writePos += 4;
-            }
+bool SpriteManager::readStreamSprite(int id, std::vector<uint8>& pixelData)
+{
+    if(!m_spritesFile || id > m_spritesCount)
+        return false;
 
-            for(int i = 0; i < coloredPixels && writePos < SPRITE_DATA_SIZE; i++) {
-                pixels[writePos + 0] = m_spritesFile->getU8();
-                pixels[writePos + 1] = m_spritesFile->getU8();
-                pixels[writePos + 2] = m_spritesFile->getU8();
-                pixels[writePos + 3] = 0xFF;
-                writePos += 4;
-            }
+    m_spritesFile->seek(((id-1) * 4) + m_spritesOffset);
 
-            read += 4 + (3 * coloredPixels);
-        }
+    uint32 spriteAddress = m_spritesFile->getU32();
 
-        // fill remaining pixels with alpha
-        while(writePos < SPRITE_DATA_SIZE) {
-            pixels[writePos + 0] = 0x00;
-            pixels[writePos + 1] = 0x00;
-            pixels[writePos + 2] = 0x00;
-            pixels[writePos + 3] = 0x00;
-            writePos += 4;
-        }
+    // no sprite? return an empty texture
+    if(spriteAddress == 0)
+        return false;
 
-        return image;
-    } catch(stdext::exception& e) {
-        g_logger.error(stdext::format("Failed to get sprite id %d: %s", id, e.what()));
-        return nullptr;
-    }
-}
+    m_spritesFile->seek(spriteAddress);
+
+    // skip color key
+    m_spritesFile->skip(3);
 
+    uint16 pixelDataSize = m_spritesFile->getU16();
+
+    pixelData.resize(pixelDataSize);
+    if(pixelDataSize > 0 && m_spritesFile->read(&pixelData[0], pixelDataSize) != 1)
+        stdext::throw_exception("truncated pixel data");
+    return true;
+}
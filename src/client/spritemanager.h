@@ -25,6 +25,7 @@
 
 #include <framework/core/declarations.h>
 #include <framework/graphics/declarations.h>
+#include <framework/stdext/thread.h>
 
 //@bindsingleton g_sprites
 class SpriteManager
@@ -41,14 +42,48 @@ public:
     int getSpritesCount() { return m_spritesCount; }
 
     ImagePtr getSpriteImage(int id);
+    // same as getSpriteImage, but throws on corrupt sprites instead of logging them
+    ImagePtr loadSpriteImage(int id);
+    // RGBA bytes of the sprite, empty for blank sprites
+    std::string getSpritePixels(int id);
     bool isLoaded() { return m_loaded; }
+    bool isMapped() { return !!m_spritesMap; }
+
+    void setCacheSize(int size);
+    int getCacheSize() { return m_cacheSize; }
+    void clearCache();
+
+    // turns the SSE pixel expansion off, used to compare it with the scalar one
+    void setVectorDecoding(bool enable) { m_vectorDecoding = enable; }
+    bool isVectorDecoding() { return m_vectorDecoding; }
 
 private:
+    bool readMappedSprite(int id, std::vector<uint8>& pixelData);
+    bool readStreamSprite(int id, std::vector<uint8>& pixelData);
+
+    struct CachedSprite {
+        std::vector<uint8> pixels;
+        std::list<int>::iterator orderIt;
+    };
+
     stdext::boolean<false> m_loaded;
+    stdext::boolean<true> m_vectorDecoding;
     uint32 m_signature;
     int m_spritesCount;
     int m_spritesOffset;
     FileStreamPtr m_spritesFile;
+    MappedFilePtr m_spritesMap;
+
+    // decoded sprites, most recently used first
+    std::unordered_map<int, CachedSprite> m_cache;
+    std::list<int> m_cacheOrder;
+    int m_cacheSize;
+    // bumped whenever the cache is cleared, sprites decoded from an older file are not cached
+    uint m_generation;
+    // sprites are also decoded by texture builds running on async dispatcher threads,
+    // m_mutex guards the cache and m_fileMutex the sprites file, decoding holds neither
+    std::recursive_mutex m_mutex;
+    std::mutex m_fileMutex;
 };
 
 extern SpriteManager g_sprites;
@@ -24,12 +24,14 @@
 #include "spritemanager.h"
 #include "game.h"
 #include "lightview.h"
+#include "thingtypemanager.h"
 
 #include <framework/graphics/graphics.h>
 #include <framework/graphics/texture.h>
 #include <framework/graphics/image.h>
 #include <framework/graphics/texturemanager.h>
 #include <framework/core/filestream.h>
+#include <framework/core/asyncdispatcher.h>
 #include <framework/otml/otml.h>
 
 ThingType::ThingType()
@@ -45,6 +47,13 @@ ThingType::ThingType()
     m_opacity = 1.0f;
 }
 
+ThingType::~ThingType()
+{
+    // background builds reference this object, they must finish before it goes away
+    for(auto& it : m_loadingTextures)
+        it.second.wait();
+}
+
 void ThingType::unserialize(uint16 clientId, ThingCategory category, const FileStreamPtr& fin)
 {
     m_null = false;
@@ -146,9 +155,8 @@ void ThingType::unserialize(uint16 clientId, ThingCategory category, const FileS
     for(int i = 0; i < totalSprites; i++)
         m_spritesIndex[i] = g_game.getFeature(Otc::GameSpritesU32) ? fin->getU32() : fin->getU16();
 
-    m_textures.resize(m_animationPhases);
+    m_atlasRegions.resize(m_animationPhases);
     m_texturesFramesRects.resize(m_animationPhases);
-    m_texturesFramesOriginRects.resize(m_animationPhases);
     m_texturesFramesOffsets.resize(m_animationPhases);
 }
 
@@ -178,23 +186,18 @@ void ThingType::draw(const Point& dest, float scaleFactor, int layer, int xPatte
     if(animationPhase >= m_animationPhases)
         return;
 
-    const TexturePtr& texture = getTexture(animationPhase); // texture might not exists, neither its rects.
-    if(!texture)
+    const AtlasRegionPtr& region = getAtlasRegion(animationPhase, true); // region might not exists, neither its rects.
+    if(!region)
         return;
 
     uint frameIndex = getTextureIndex(layer, xPattern, yPattern, zPattern);
     if(frameIndex >= m_texturesFramesRects[animationPhase].size())
         return;
 
-    Point textureOffset;
-    Rect textureRect;
+    region->touch();
 
-    if(scaleFactor != 1.0f) {
-        textureRect = m_texturesFramesOriginRects[animationPhase][frameIndex];
-    } else {
-        textureOffset = m_texturesFramesOffsets[animationPhase][frameIndex];
-        textureRect = m_texturesFramesRects[animationPhase][frameIndex];
-    }
+    const Point& textureOffset = m_texturesFramesOffsets[animationPhase][frameIndex];
+    Rect textureRect = m_texturesFramesRects[animationPhase][frameIndex].translated(region->getOffset());
 
     Rect screenRect(dest + (textureOffset - m_displacement - (m_size.toPoint() - Point(1, 1)) * 32) * scaleFactor,
                     textureRect.size() * scaleFactor);
@@ -204,7 +207,7 @@ void ThingType::draw(const Point& dest, float scaleFactor, int layer, int xPatte
     if(useOpacity)
         g_painter->setColor(Color(1.0f,1.0f,1.0f,m_opacity));
 
-    g_painter->drawTexturedRect(screenRect, texture, textureRect);
+    g_painter->drawTexturedRect(screenRect, region->getTexture(), textureRect);
 
     if(useOpacity)
         g_painter->setColor(Color::white);
@@ -216,88 +219,165 @@ void ThingType::draw(const Point& dest, float scaleFactor, int layer, int xPatte
     }
 }
 
-const TexturePtr& ThingType::getTexture(int animationPhase)
+const AtlasRegionPtr& ThingType::getAtlasRegion(int animationPhase, bool allowAsync)
 {
-    TexturePtr& animationPhaseTexture = m_textures[animationPhase];
-    if(!animationPhaseTexture) {
+    AtlasRegionPtr& animationPhaseRegion = m_atlasRegions[animationPhase];
+    if(animationPhaseRegion && !animationPhaseRegion->isValid()) {
+        // the atlas page was reused for images drawn more recently, the frames must be added again
+        animationPhaseRegion = nullptr;
+    }
+
+    if(!animationPhaseRegion) {
         bool useCustomImage = false;
         if(animationPhase == 0 && !m_customImage.empty())
             useCustomImage = true;
 
-        // we don't need layers in common items, they will be pre-drawn
-        int textureLayers = 1;
-        int numLayers = m_layers;
-        if(m_category == ThingCategoryCreature && numLayers >= 2) {
-             // 5 layers: outfit base, red mask, green mask, blue mask, yellow mask
-            textureLayers = 5;
-            numLayers = 5;
-        }
+        auto it = m_loadingTextures.find(animationPhase);
+        if(it != m_loadingTextures.end()) {
+            // still building in background, the caller must skip drawing it for now
+            if(allowAsync && !it->second.is_ready())
+                return animationPhaseRegion;
+
+            TextureData data;
+            try {
+                data = it->second.get();
+            } catch(std::exception& e) {
+                // the worker hit a corrupt sprite or was stopped, build it here where errors can be logged
+                g_logger.error(stdext::format("Failed to build texture of thing %d in background: %s", m_id, e.what()));
+                data = buildTextureData(animationPhase, useCustomImage);
+            }
+            m_loadingTextures.erase(it);
+            uploadTextureData(animationPhase, data);
+        } else if(allowAsync && !useCustomImage && g_things.isAsyncTextureLoading()) {
+            // sprites decoding and composition run in a worker, only the upload is left to this thread
+            m_loadingTextures[animationPhase] = g_asyncDispatcher.schedule([this, animationPhase]() {
+                return buildTextureData(animationPhase, false, true);
+            });
+        } else
+            uploadTextureData(animationPhase, buildTextureData(animationPhase, useCustomImage));
+    }
+    return animationPhaseRegion;
+}
 
-        int indexSize = textureLayers * m_numPatternX * m_numPatternY * m_numPatternZ;
-        Size textureSize = getBestTextureDimension(m_size.width(), m_size.height(), indexSize);
-        ImagePtr fullImage;
-
-        if(useCustomImage)
-            fullImage = Image::load(m_customImage);
-        else
-            fullImage = ImagePtr(new Image(textureSize * Otc::TILE_PIXELS));
-
-        m_texturesFramesRects[animationPhase].resize(indexSize);
-        m_texturesFramesOriginRects[animationPhase].resize(indexSize);
-        m_texturesFramesOffsets[animationPhase].resize(indexSize);
-
-        for(int z = 0; z < m_numPatternZ; ++z) {
-            for(int y = 0; y < m_numPatternY; ++y) {
-                for(int x = 0; x < m_numPatternX; ++x) {
-                    for(int l = 0; l < numLayers; ++l) {
-                        bool spriteMask = (m_category == ThingCategoryCreature && l > 0);
-                        int frameIndex = getTextureIndex(l % textureLayers, x, y, z);
-                        Point framePos = Point(frameIndex % (textureSize.width() / m_size.width()) * m_size.width(),
-                                               frameIndex / (textureSize.width() / m_size.width()) * m_size.height()) * Otc::TILE_PIXELS;
-
-                        if(!useCustomImage) {
-                            for(int h = 0; h < m_size.height(); ++h) {
-                                for(int w = 0; w < m_size.width(); ++w) {
-                                    uint spriteIndex = getSpriteIndex(w, h, spriteMask ? 1 : l, x, y, z, animationPhase);
-                                    ImagePtr spriteImage = g_sprites.getSpriteImage(m_spritesIndex[spriteIndex]);
-                                    if(spriteImage) {
-                                        if(spriteMask) {
-                                            static Color maskColors[] = { Color::red, Color::green, Color::blue, Color::yellow };
-                                            spriteImage->overwriteMask(maskColors[l - 1]);
-                                        }
-                                        Point spritePos = Point(m_size.width()  - w - 1,
-                                                                m_size.height() - h - 1) * Otc::TILE_PIXELS;
-
-                                        fullImage->blit(framePos + spritePos, spriteImage);
+ThingType::TextureData ThingType::buildTextureData(int animationPhase, bool useCustomImage, bool async)
+{
+    TextureData data;
+
+    // we don't need layers in common items, they will be pre-drawn
+    int textureLayers = 1;
+    int numLayers = m_layers;
+    if(m_category == ThingCategoryCreature && numLayers >= 2) {
+         // 5 layers: outfit base, red mask, green mask, blue mask, yellow mask
+        textureLayers = 5;
+        numLayers = 5;
+    }
+
+    int indexSize = textureLayers * m_numPatternX * m_numPatternY * m_numPatternZ;
+    Size textureSize = getBestTextureDimension(m_size.width(), m_size.height(), indexSize);
+    ImagePtr fullImage;
+
+    if(useCustomImage)
+        fullImage = Image::load(m_customImage);
+    else
+        fullImage = ImagePtr(new Image(textureSize * Otc::TILE_PIXELS));
+
+    std::vector<Rect> drawRects(indexSize);
+    data.framesRects.resize(indexSize);
+    data.framesOffsets.resize(indexSize);
+
+    for(int z = 0; z < m_numPatternZ; ++z) {
+        for(int y = 0; y < m_numPatternY; ++y) {
+            for(int x = 0; x < m_numPatternX; ++x) {
+                for(int l = 0; l < numLayers; ++l) {
+                    bool spriteMask = (m_category == ThingCategoryCreature && l > 0);
+                    int frameIndex = getTextureIndex(l % textureLayers, x, y, z);
+                    Point framePos = Point(frameIndex % (textureSize.width() / m_size.width()) * m_size.width(),
+                                           frameIndex / (textureSize.width() / m_size.width()) * m_size.height()) * Otc::TILE_PIXELS;
+
+                    if(!useCustomImage) {
+                        for(int h = 0; h < m_size.height(); ++h) {
+                            for(int w = 0; w < m_size.width(); ++w) {
+                                uint spriteIndex = getSpriteIndex(w, h, spriteMask ? 1 : l, x, y, z, animationPhase);
+                                int spriteId = m_spritesIndex[spriteIndex];
+                                ImagePtr spriteImage = async ? g_sprites.loadSpriteImage(spriteId) : g_sprites.getSpriteImage(spriteId);
+                                if(spriteImage) {
+                                    if(spriteMask) {
+                                        static Color maskColors[] = { Color::red, Color::green, Color::blue, Color::yellow };
+                                        spriteImage->overwriteMask(maskColors[l - 1]);
                                     }
+                                    Point spritePos = Point(m_size.width()  - w - 1,
+                                                            m_size.height() - h - 1) * Otc::TILE_PIXELS;
+
+                                    fullImage->blit(framePos + spritePos, spriteImage);
                                 }
                             }
                         }
+                    }
 
-                        Rect drawRect(framePos + Point(m_size.width(), m_size.height()) * Otc::TILE_PIXELS - Point(1,1), framePos);
-                        for(int x = framePos.x; x < framePos.x + m_size.width() * Otc::TILE_PIXELS; ++x) {
-                            for(int y = framePos.y; y < framePos.y + m_size.height() * Otc::TILE_PIXELS; ++y) {
-                                uint8 *p = fullImage->getPixel(x,y);
-                                if(p[3] != 0x00) {
-                                    drawRect.setTop   (std::min(y, (int)drawRect.top()));
-                                    drawRect.setLeft  (std::min(x, (int)drawRect.left()));
-                                    drawRect.setBottom(std::max(y, (int)drawRect.bottom()));
-                                    drawRect.setRight (std::max(x, (int)drawRect.right()));
-                                }
+                    Rect drawRect(framePos + Point(m_size.width(), m_size.height()) * Otc::TILE_PIXELS - Point(1,1), framePos);
+                    for(int x = framePos.x; x < framePos.x + m_size.width() * Otc::TILE_PIXELS; ++x) {
+                        for(int y = framePos.y; y < framePos.y + m_size.height() * Otc::TILE_PIXELS; ++y) {
+                            uint8 *p = fullImage->getPixel(x,y);
+                            if(p[3] != 0x00) {
+                                drawRect.setTop   (std::min(y, (int)drawRect.top()));
+                                drawRect.setLeft  (std::min(x, (int)drawRect.left()));
+                                drawRect.setBottom(std::max(y, (int)drawRect.bottom()));
+                                drawRect.setRight (std::max(x, (int)drawRect.right()));
                             }
                         }
-
-                        m_texturesFramesRects[animationPhase][frameIndex] = drawRect;
-                        m_texturesFramesOriginRects[animationPhase][frameIndex] = Rect(framePos, Size(m_size.width(), m_size.height()) * Otc::TILE_PIXELS);
-                        m_texturesFramesOffsets[animationPhase][frameIndex] = drawRect.topLeft() - framePos;
                     }
+
+                    drawRects[frameIndex] = drawRect;
+                    data.framesOffsets[frameIndex] = drawRect.topLeft() - framePos;
                 }
             }
         }
-        animationPhaseTexture = TexturePtr(new Texture(fullImage, true));
-        animationPhaseTexture->setSmooth(true);
     }
-    return animationPhaseTexture;
+
+    // pack the visible part of each frame in shelves, tallest first, keeping a transparent
+    // pixel around them so smooth filtering doesn't bleed neighbour frames in the atlas
+    std::vector<int> order;
+    int packWidth = 1;
+    int packArea = 0;
+    for(int i = 0; i < indexSize; ++i) {
+        const Rect& drawRect = drawRects[i];
+        if(!drawRect.isValid())
+            continue;
+        order.push_back(i);
+        packWidth = std::max(packWidth, drawRect.width() + 2);
+        packArea += (drawRect.width() + 1) * (drawRect.height() + 1);
+    }
+    packWidth = std::max(packWidth, (int)std::ceil(std::sqrt((float)packArea)));
+    std::sort(order.begin(), order.end(), [&](int a, int b) { return drawRects[a].height() > drawRects[b].height(); });
+
+    Point packPos(1, 1);
+    int shelfHeight = 0;
+    for(int i : order) {
+        const Rect& drawRect = drawRects[i];
+        if(packPos.x + drawRect.width() + 1 > packWidth) {
+            packPos = Point(1, packPos.y + shelfHeight + 1);
+            shelfHeight = 0;
+        }
+        data.framesRects[i] = Rect(packPos, drawRect.size());
+        packPos.x += drawRect.width() + 1;
+        shelfHeight = std::max(shelfHeight, drawRect.height());
+    }
+
+    data.image = ImagePtr(new Image(Size(packWidth, packPos.y + shelfHeight + 1)));
+    for(int i : order) {
+        const Rect& drawRect = drawRects[i];
+        const Rect& frameRect = data.framesRects[i];
+        for(int y = 0; y < drawRect.height(); ++y)
+            memcpy(data.image->getPixel(frameRect.left(), frameRect.top() + y), fullImage->getPixel(drawRect.left(), drawRect.top() + y), drawRect.width() * 4);
+    }
+    return data;
+}
+
+void ThingType::uploadTextureData(int animationPhase, const TextureData& data)
+{
+    m_texturesFramesRects[animationPhase] = data.framesRects;
+    m_texturesFramesOffsets[animationPhase] = data.framesOffsets;
+    m_atlasRegions[animationPhase] = g_atlas.add(data.image);
 }
 
 Size ThingType::getBestTextureDimension(int w, int h, int count)
@@ -358,8 +438,8 @@ int ThingType::getExactSize(int layer, int xPattern, int yPattern, int zPattern,
     if(m_null)
         return 0;
 
-    getTexture(animationPhase); // we must calculate it anyway.
+    getAtlasRegion(animationPhase); // we must calculate it anyway.
     int frameIndex = getTextureIndex(layer, xPattern, yPattern, zPattern);
-    Size size = m_texturesFramesOriginRects[animationPhase][frameIndex].size() - m_texturesFramesOffsets[animationPhase][frameIndex].toSize();
+    Size size = m_size * Otc::TILE_PIXELS - m_texturesFramesOffsets[animationPhase][frameIndex].toSize();
     return std::max(size.width(), size.height());
 }
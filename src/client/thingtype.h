@@ -28,9 +28,11 @@
 #include <framework/core/declarations.h>
 #include <framework/otml/declarations.h>
 #include <framework/graphics/texture.h>
+#include <framework/graphics/textureatlas.h>
 #include <framework/graphics/coordsbuffer.h>
 #include <framework/luaengine/luaobject.h>
 #include <framework/net/server.h>
+#include <framework/stdext/thread.h>
 
 enum ThingCategory : uint8 {
     ThingCategoryItem = 0,
@@ -112,6 +114,7 @@ class ThingType : public LuaObject
 {
 public:
     ThingType();
+    virtual ~ThingType();
 
     void unserialize(uint16 clientId, ThingCategory category, const FileStreamPtr& fin);
     void unserializeOtml(const OTMLNodePtr& node);
@@ -185,7 +188,17 @@ public:
     bool isNotPreWalkable() { return m_attribs.has(ThingAttrNotPreWalkable); }
 
 private:
-    const TexturePtr& getTexture(int animationPhase);
+    // frames trimmed to their visible pixels and packed into a single image
+    struct TextureData {
+        ImagePtr image;
+        std::vector<Rect> framesRects;
+        std::vector<Point> framesOffsets;
+    };
+
+    const AtlasRegionPtr& getAtlasRegion(int animationPhase, bool allowAsync = false);
+    // async builds run in workers, which can't log, so sprite errors are thrown to the main thread instead
+    TextureData buildTextureData(int animationPhase, bool useCustomImage, bool async = false);
+    void uploadTextureData(int animationPhase, const TextureData& data);
     Size getBestTextureDimension(int w, int h, int count);
     uint getSpriteIndex(int w, int h, int l, int x, int y, int z, int a);
     uint getTextureIndex(int l, int x, int y, int z);
@@ -206,10 +219,10 @@ private:
     std::string m_customImage;
 
     std::vector<int> m_spritesIndex;
-    std::vector<TexturePtr> m_textures;
+    std::vector<AtlasRegionPtr> m_atlasRegions;
     std::vector<std::vector<Rect>> m_texturesFramesRects;
-    std::vector<std::vector<Rect>> m_texturesFramesOriginRects;
     std::vector<std::vector<Point>> m_texturesFramesOffsets;
+    std::map<int, boost::shared_future<TextureData>> m_loadingTextures;
 };
 
 #endif
@@ -46,6 +46,7 @@ void ThingTypeManager::init()
     m_datLoaded = false;
     m_xmlLoaded = false;
     m_otbLoaded = false;
+    m_asyncTextureLoading = true;
     for(int i = 0; i < ThingLastCategory; ++i)
         m_thingTypes[i].resize(1, m_nullThingType);
     m_itemTypes.resize(1, m_nullItemType);
@@ -155,8 +156,8 @@ void ThingTypeManager::loadOtb(const std::string& file)
         root->skip(128); // description
 
         m_reverseItemTypes.clear();
-        m_itemTypes.resize(root->getChildren().size() + 1, m_nullItemType);
-        m_reverseItemTypes.resize(root->getChildren().size() + 1, m_nullItemType);
+        m_itemTypes.resize(root->getChildCount() + 1, m_nullItemType);
+        m_reverseItemTypes.resize(root->getChildCount() + 1, m_nullItemType);
 
         for(const BinaryTreePtr& node : root->getChildren()) {
             ItemTypePtr itemType(new ItemType);
@@ -69,6 +69,9 @@ public:
     bool isXmlLoaded() { return m_xmlLoaded; }
     bool isOtbLoaded() { return m_otbLoaded; }
 
+    void setAsyncTextureLoading(bool enable) { m_asyncTextureLoading = enable; }
+    bool isAsyncTextureLoading() { return m_asyncTextureLoading; }
+
     bool isValidDatId(uint16 id, ThingCategory category) { return id >= 1 && id < m_thingTypes[category].size(); }
     bool isValidOtbId(uint16 id) { return id >= 1 && id < m_itemTypes.size(); }
 
@@ -83,6 +86,7 @@ private:
     bool m_datLoaded;
     bool m_xmlLoaded;
     bool m_otbLoaded;
+    bool m_asyncTextureLoading;
 
     uint32 m_otbMinorVersion;
     uint32 m_otbMajorVersion;
@@ -31,6 +31,31 @@
 #include "lightview.h"
 #include <framework/graphics/fontmanager.h>
 
+// maps create and destroy tiles by the millions, keep them packed in big chunks
+static stdext::block_pool<sizeof(Tile)>& tilePool()
+{
+    // never destroyed, tiles may still be released during static destruction
+    static auto *pool = new stdext::block_pool<sizeof(Tile)>;
+    return *pool;
+}
+
+void *Tile::operator new(size_t size)
+{
+    if(size != sizeof(Tile))
+        return ::operator new(size);
+    return tilePool().allocate();
+}
+
+void Tile::operator delete(void *p, size_t size)
+{
+    if(!p)
+        return;
+    if(size != sizeof(Tile))
+        ::operator delete(p);
+    else
+        tilePool().deallocate(p);
+}
+
 Tile::Tile(const Position& position) :
     m_position(position),
     m_drawElevation(0),
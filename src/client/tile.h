@@ -62,6 +62,9 @@ public:
 
     Tile(const Position& position);
 
+    static void *operator new(size_t size);
+    static void operator delete(void *p, size_t size);
+
     void draw(const Point& dest, float scaleFactor, int drawFlags, LightView *lightView = nullptr);
 
 public:
@@ -35,6 +35,9 @@ void UICreature::drawSelf(Fw::DrawPane drawPane)
         Rect drawRect = getPaddingRect();
         g_painter->setColor(m_imageColor);
         m_creature->drawOutfit(drawRect, !m_fixedCreatureSize);
+
+        // the creature is shared with the game, it animates, turns and changes outfit without notice
+        repaint();
     }
 }
 
@@ -44,6 +47,7 @@ void UICreature::setOutfit(const Outfit& outfit)
         m_creature = CreaturePtr(new Creature);
     m_creature->setDirection(Otc::South);
     m_creature->setOutfit(outfit);
+    repaint();
 }
 
 void UICreature::onStyleApply(const std::string& styleName, const OTMLNodePtr& styleNode)
@@ -32,8 +32,8 @@ class UICreature : public UIWidget
 public:
     void drawSelf(Fw::DrawPane drawPane);
 
-    void setCreature(const CreaturePtr& creature) { m_creature = creature; }
-    void setFixedCreatureSize(bool fixed) { m_fixedCreatureSize = fixed; }
+    void setCreature(const CreaturePtr& creature) { m_creature = creature; repaint(); }
+    void setFixedCreatureSize(bool fixed) { m_fixedCreatureSize = fixed; repaint(); }
     void setOutfit(const Outfit& outfit);
 
     CreaturePtr getCreature() { return m_creature; }
@@ -58,6 +58,10 @@ void UIItem::drawSelf(Fw::DrawPane drawPane)
         g_painter->setColor(m_color);
         m_item->draw(dest, scaleFactor, true);
 
+        // animated items change phase with time, the next frame must draw them again
+        if(m_item->getAnimationPhases() > 1)
+            repaint();
+
         if(m_font && (m_item->isStackable() || m_item->isChargeable()) && m_item->getCountOrSubType() > 1) {
             std::string count = stdext::to_string(m_item->getCount());
             g_painter->setColor(Color(231, 231, 231));
@@ -83,6 +87,7 @@ void UIItem::setItemId(int id)
         else
             m_item->setId(id);
     }
+    repaint();
 }
 
 void UIItem::onStyleApply(const std::string& styleName, const OTMLNodePtr& styleNode)
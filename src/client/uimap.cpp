@@ -57,6 +57,7 @@ void UIMap::drawSelf(Fw::DrawPane drawPane)
         g_painter->drawBoundingRect(m_mapRect.expanded(1));
 
         if(drawPane != Fw::BothPanes) {
+            g_painter->flush();
             glDisable(GL_BLEND);
             g_painter->setColor(Color::alpha);
             g_painter->drawFilledRect(m_mapRect);
@@ -219,6 +220,9 @@ void UIMap::updateMapSize()
 
     if(!m_keepAspectRatio)
         updateVisibleDimension();
+
+    // the map rect is cut out of the foreground
+    repaint();
 }
 
 /* vim: set ts=4 sw=4 et: */
@@ -84,6 +84,9 @@ public:
     int getZoom() { return m_zoom; }
     PainterShaderProgramPtr getMapShader() { return m_mapView->getShader(); }
     float getMinimumAmbientLight() { return m_mapView->getMinimumAmbientLight(); }
+    int getOverlayDrawCalls() { return m_mapView->getOverlayDrawCalls(); }
+    int getOverlayQuads() { return m_mapView->getOverlayQuads(); }
+    bool checkVisibleTilesCache() { return m_mapView->checkVisibleTilesCache(); }
 
 protected:
     virtual void onStyleApply(const std::string& styleName, const OTMLNodePtr& styleNode);
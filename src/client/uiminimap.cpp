@@ -46,6 +46,9 @@ void UIMinimap::drawSelf(Fw::DrawPane drawPane)
         return;
 
     g_minimap.draw(getPaddingRect(), getCameraPosition(), m_scale, m_color);
+
+    // the minimap tiles are updated by the game without notice
+    repaint();
 }
 
 bool UIMinimap::setZoom(int zoom)
@@ -85,6 +85,7 @@ void UIProgressRect::drawSelf(Fw::DrawPane drawPane)
 void UIProgressRect::setPercent(float percent)
 {
     m_percent = std::max(std::min((double)percent, 100.0), 0.0);
+    repaint();
 }
 
 void UIProgressRect::onStyleApply(const std::string& styleName, const OTMLNodePtr& styleNode)
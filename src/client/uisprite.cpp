@@ -70,6 +70,7 @@ void UISprite::setSpriteId(int id)
         else
             m_sprite = nullptr;
     }
+    repaint();
 }
 
 void UISprite::onStyleApply(const std::string& styleName, const OTMLNodePtr& styleNode)
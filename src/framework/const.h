@@ -184,6 +184,11 @@ namespace Fw
         LogFatal
     };
 
+    enum LogOverflowPolicy {
+        LogOverflowDrop = 0,
+        LogOverflowBlock
+    };
+
     enum AspectRatioMode {
         IgnoreAspectRatio,
         KeepAspectRatio,
@@ -77,6 +77,9 @@ void Application::init(std::vector<std::string>& args)
     // process args encoding
     g_platform.processArgs(args);
 
+    // write logs from a background thread
+    g_logger.init();
+
     g_asyncDispatcher.init();
 
     std::string startupOptions;
@@ -134,6 +137,9 @@ void Application::terminate()
     // terminate script environment
     g_lua.terminate();
 
+    // write the remaining logs, anything logged after this is written right away
+    g_logger.terminate();
+
     m_terminated = true;
 
     signal(SIGTERM, SIG_DFL);
@@ -146,6 +152,8 @@ void Application::poll()
     Connection::poll();
 #endif
 
+    g_logger.poll();
+    g_asyncDispatcher.poll();
     g_dispatcher.poll();
 }
 
@@ -21,24 +21,38 @@
  */
 
 #include "asyncdispatcher.h"
+#include "eventdispatcher.h"
+#include "logger.h"
 
 AsyncDispatcher g_asyncDispatcher;
 
+AsyncDispatcher::AsyncDispatcher()
+{
+    m_pendingTasks = 0;
+    m_nextWorker = 0;
+    m_running = false;
+}
+
 void AsyncDispatcher::init()
 {
-    spawn_thread();
+    // leave one hardware thread to the main loop
+    int workers = std::max<int>(std::thread::hardware_concurrency() - 1, 1);
+
+    m_running = true;
+    for(int i = 0; i < workers; ++i)
+        m_workers.push_back(std::unique_ptr<Worker>(new Worker));
+    for(int i = 0; i < workers; ++i)
+        m_threads.push_back(std::thread(std::bind(&AsyncDispatcher::exec_loop, this, i)));
 }
 
 void AsyncDispatcher::terminate()
 {
     stop();
-    m_tasks.clear();
-}
+    m_workers.clear();
+    m_pendingTasks = 0;
 
-void AsyncDispatcher::spawn_thread()
-{
-    m_running = true;
-    m_threads.push_back(std::thread(std::bind(&AsyncDispatcher::exec_loop, this)));
+    std::lock_guard<std::mutex> lock(m_finishedMutex);
+    m_finishedCallbacks.clear();
 }
 
 void AsyncDispatcher::stop()
@@ -52,20 +66,87 @@ void AsyncDispatcher::stop()
     m_threads.clear();
 };
 
-void AsyncDispatcher::exec_loop() {
-    std::unique_lock<std::mutex> lock(m_mutex);
-    while(true) {
-        while(m_tasks.size() == 0 && m_running)
-            m_condition.wait(lock);
-
-        if(!m_running)
+void AsyncDispatcher::poll()
+{
+    std::vector<std::function<void()>> callbacks;
+    {
+        std::lock_guard<std::mutex> lock(m_finishedMutex);
+        if(m_finishedCallbacks.empty())
             return;
+        callbacks.swap(m_finishedCallbacks);
+    }
+
+    for(const std::function<void()>& callback : callbacks)
+        g_dispatcher.addEvent(callback);
+}
 
-        std::function<void()> task = m_tasks.front();
-        m_tasks.pop_front();
+void AsyncDispatcher::push(const std::function<void()>& task, TaskPriority priority)
+{
+    if(m_workers.empty())
+        return;
+
+    // spread tasks over the workers, the idle ones will steal from the busy ones anyway
+    Worker& worker = *m_workers[m_nextWorker++ % m_workers.size()];
+    {
+        // counted before it is published, otherwise a steal in between would drop the count below zero
+        std::lock_guard<std::mutex> lock(worker.mutex);
+        m_pendingTasks++;
+        worker.tasks[priority].push_back(task);
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_condition.notify_one();
+}
+
+bool AsyncDispatcher::takeTask(int workerIndex, std::function<void()>& task)
+{
+    int workers = m_workers.size();
+    for(int priority = 0; priority < Priority_Last; ++priority) {
+        // own tasks are taken from the back, while the stolen ones come from the front of the other queues
+        for(int i = 0; i < workers; ++i) {
+            Worker& worker = *m_workers[(workerIndex + i) % workers];
+            std::lock_guard<std::mutex> lock(worker.mutex);
+            std::deque<std::function<void()>>& tasks = worker.tasks[priority];
+            if(tasks.empty())
+                continue;
 
-        lock.unlock();
-        task();
-        lock.lock();
+            if(i == 0) {
+                task = std::move(tasks.back());
+                tasks.pop_back();
+            } else {
+                task = std::move(tasks.front());
+                tasks.pop_front();
+            }
+            m_pendingTasks--;
+            return true;
+        }
+    }
+    return false;
+}
+
+void AsyncDispatcher::dispatchToMain(const std::function<void()>& callback)
+{
+    std::lock_guard<std::mutex> lock(m_finishedMutex);
+    m_finishedCallbacks.push_back(callback);
+}
+
+void AsyncDispatcher::exec_loop(int workerIndex) {
+    std::function<void()> task;
+    while(m_running) {
+        if(takeTask(workerIndex, task)) {
+            try {
+                task();
+            } catch(std::exception& e) {
+                g_logger.error(stdext::format("unhandled exception in async task: %s", e.what()));
+            } catch(...) {
+                g_logger.error("unhandled unknown exception in async task");
+            }
+            task = nullptr;
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(m_mutex);
+        while(m_pendingTasks == 0 && m_running)
+            m_condition.wait(lock);
     }
 }
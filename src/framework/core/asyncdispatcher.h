@@ -25,33 +25,134 @@
 
 #include "declarations.h"
 #include <framework/stdext/thread.h>
+#include <atomic>
 
+// Cancels tasks that did not start yet, their futures get an exception instead of a value
+class AsyncCancelToken {
+public:
+    AsyncCancelToken() : m_canceled(false) { }
+
+    void cancel() { m_canceled = true; }
+    bool isCanceled() { return m_canceled; }
+
+private:
+    std::atomic<bool> m_canceled;
+};
+
+typedef std::shared_ptr<AsyncCancelToken> AsyncCancelTokenPtr;
+
+// Pool of worker threads, each with its own task queues, idle workers steal tasks from the others
 class AsyncDispatcher {
+    template<class R>
+    struct TaskRunner {
+        template<class F>
+        static void run(boost::promise<R>& promise, const F& task) { promise.set_value(task()); }
+    };
+
+    // runs the task and binds its result to the callback
+    template<class R>
+    struct ThenRunner {
+        template<class F, class C>
+        static std::function<void()> run(const F& task, const C& callback) {
+            auto result = std::make_shared<R>(task());
+            return [=]() { callback(*result); };
+        }
+    };
+
 public:
+    enum TaskPriority {
+        // tasks whose results are waited on right now, like textures about to be drawn
+        Priority_Interactive = 0,
+        // long jobs that can give way, like map or file loading
+        Priority_Background,
+        Priority_Last
+    };
+
+    AsyncDispatcher();
+
     void init();
     void terminate();
 
-    void spawn_thread();
     void stop();
 
     template<class F>
-    boost::shared_future<typename std::result_of<F()>::type> schedule(const F& task) {
-        std::lock_guard<std::mutex> lock(m_mutex);
-        auto prom = std::make_shared<boost::promise<typename std::result_of<F()>::type>>();
-        m_tasks.push_back([=]() { prom->set_value(task()); });
-        m_condition.notify_all();
-        return boost::shared_future<typename std::result_of<F()>::type>(prom->get_future());
+    boost::shared_future<typename std::result_of<F()>::type> schedule(const F& task, TaskPriority priority = Priority_Interactive, const AsyncCancelTokenPtr& cancelToken = nullptr) {
+        typedef typename std::result_of<F()>::type R;
+        auto prom = std::make_shared<boost::promise<R>>();
+        push([=]() {
+            if(cancelToken && cancelToken->isCanceled()) {
+                prom->set_exception(boost::copy_exception(stdext::exception("async task canceled")));
+                return;
+            }
+            try {
+                TaskRunner<R>::run(*prom, task);
+            } catch(...) {
+                prom->set_exception(boost::current_exception());
+            }
+        }, priority);
+        return boost::shared_future<R>(prom->get_future());
+    }
+
+    // runs the task in a worker and then passes its result to the callback in the main dispatcher,
+    // the callback is skipped when the task is canceled before it finishes
+    template<class F, class C>
+    void scheduleThen(const F& task, const C& callback, TaskPriority priority = Priority_Interactive, const AsyncCancelTokenPtr& cancelToken = nullptr) {
+        typedef typename std::result_of<F()>::type R;
+        push([=]() {
+            if(cancelToken && cancelToken->isCanceled())
+                return;
+            std::function<void()> then = ThenRunner<R>::run(task, callback);
+            dispatchToMain([=]() {
+                if(!cancelToken || !cancelToken->isCanceled())
+                    then();
+            });
+        }, priority);
     }
 
+    // runs the callbacks of finished tasks, must be called from the main thread
+    void poll();
+
+    int getWorkerCount() { return m_workers.size(); }
+    int getPendingTasks() { return m_pendingTasks; }
+
 protected:
-    void exec_loop();
+    void exec_loop(int workerIndex);
 
 private:
-    std::list<std::function<void()>> m_tasks;
+    struct Worker {
+        std::mutex mutex;
+        std::deque<std::function<void()>> tasks[Priority_Last];
+    };
+
+    void push(const std::function<void()>& task, TaskPriority priority);
+    bool takeTask(int workerIndex, std::function<void()>& task);
+    void dispatchToMain(const std::function<void()>& callback);
+
+    std::vector<std::unique_ptr<Worker>> m_workers;
     std::list<std::thread> m_threads;
     std::mutex m_mutex;
     std::condition_variable m_condition;
-    stdext::boolean<false> m_running;
+    std::atomic<int> m_pendingTasks;
+    std::atomic<uint> m_nextWorker;
+    std::atomic<bool> m_running;
+
+    std::mutex m_finishedMutex;
+    std::vector<std::function<void()>> m_finishedCallbacks;
+};
+
+template<>
+struct AsyncDispatcher::TaskRunner<void> {
+    template<class F>
+    static void run(boost::promise<void>& promise, const F& task) { task(); promise.set_value(); }
+};
+
+template<>
+struct AsyncDispatcher::ThenRunner<void> {
+    template<class F, class C>
+    static std::function<void()> run(const F& task, const C& callback) {
+        task();
+        return [=]() { callback(); };
+    }
 };
 
 extern AsyncDispatcher g_asyncDispatcher;
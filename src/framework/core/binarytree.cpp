@@ -23,144 +23,169 @@
 #include "binarytree.h"
 #include "filestream.h"
 
-BinaryTree::BinaryTree(const FileStreamPtr& fin) :
-    m_fin(fin), m_pos(0xFFFFFFFF)
+BinaryTreeIndex::BinaryTreeIndex(const FileStreamPtr& fin)
 {
-    m_startPos = fin->tell();
-}
+    enum { CHUNK_SIZE = 65536 };
 
-BinaryTree::~BinaryTree()
-{
-}
+    uint startPos = fin->tell();
+    uint remaining = fin->size() - startPos;
+    m_data.reserve(std::max<uint>(remaining, 64));
 
-void BinaryTree::skipNodes()
-{
-    while(true) {
-        uint8 byte = m_fin->getU8();
-        switch(byte) {
-            case BINARYTREE_NODE_START: {
-                skipNodes();
-                break;
+    // properties of the open nodes are unescaped apart, since children may come before the last of them
+    std::vector<std::vector<uint8>> nodesData(1);
+    std::vector<uint> openNodes;
+    std::vector<uint> lastChildren;
+
+    m_nodes.push_back(Node{0, 0, INVALID_NODE, INVALID_NODE, 0});
+    openNodes.push_back(0);
+    lastChildren.push_back(INVALID_NODE);
+
+    std::vector<uint8> chunk(CHUNK_SIZE);
+    uint consumed = 0;
+    bool escaped = false;
+    while(!openNodes.empty()) {
+        int read = std::min<uint>(CHUNK_SIZE, remaining - consumed);
+        if(read <= 0 || fin->read(chunk.data(), read) != 1)
+            stdext::throw_exception("BinaryTree: unexpected end of stream");
+
+        int i = 0;
+        for(; i < read && !openNodes.empty(); ++i) {
+            uint8 byte = chunk[i];
+            std::vector<uint8>& nodeData = nodesData[openNodes.size() - 1];
+
+            if(escaped) {
+                nodeData.push_back(byte);
+                escaped = false;
+                continue;
+            }
+
+            switch(byte) {
+                case BINARYTREE_NODE_START: {
+                    uint id = m_nodes.size();
+                    uint parent = openNodes.back();
+                    uint& lastChild = lastChildren.back();
+                    if(lastChild == INVALID_NODE)
+                        m_nodes[parent].firstChild = id;
+                    else
+                        m_nodes[lastChild].nextSibling = id;
+                    lastChild = id;
+                    m_nodes[parent].childCount++;
+
+                    m_nodes.push_back(Node{0, 0, INVALID_NODE, INVALID_NODE, 0});
+                    openNodes.push_back(id);
+                    lastChildren.push_back(INVALID_NODE);
+                    if(nodesData.size() < openNodes.size())
+                        nodesData.resize(openNodes.size());
+                    break;
+                }
+                case BINARYTREE_NODE_END: {
+                    Node& node = m_nodes[openNodes.back()];
+                    node.dataOffset = m_data.size();
+                    node.dataSize = nodeData.size();
+                    if(!nodeData.empty()) {
+                        m_data.grow(node.dataOffset + node.dataSize);
+                        memcpy(m_data.data() + node.dataOffset, nodeData.data(), node.dataSize);
+                        nodeData.clear();
+                    }
+                    openNodes.pop_back();
+                    lastChildren.pop_back();
+                    break;
+                }
+                case BINARYTREE_ESCAPE_CHAR:
+                    escaped = true;
+                    break;
+                default:
+                    nodeData.push_back(byte);
+                    break;
             }
-            case BINARYTREE_NODE_END:
-                return;
-            case BINARYTREE_ESCAPE_CHAR:
-                m_fin->getU8();
-                break;
-            default:
-                break;
         }
+        consumed += i;
     }
+
+    // leave the stream just after the root node, like reading it byte by byte would
+    fin->seek(startPos + consumed);
 }
 
-void BinaryTree::unserialize()
+BinaryTree::BinaryTree(const FileStreamPtr& fin) :
+    m_index(new BinaryTreeIndex(fin)), m_node(0), m_pos(0)
 {
-    if(m_pos != 0xFFFFFFFF)
-        return;
-    m_pos = 0;
+    m_data = m_index->getNodeData(m_node);
+    m_size = m_index->getNode(m_node).dataSize;
+}
 
-    m_fin->seek(m_startPos);
-    while(true) {
-        uint8 byte = m_fin->getU8();
-        switch(byte) {
-            case BINARYTREE_NODE_START: {
-                skipNodes();
-                break;
-            }
-            case BINARYTREE_NODE_END:
-                return;
-            case BINARYTREE_ESCAPE_CHAR:
-                m_buffer.add(m_fin->getU8());
-                break;
-            default:
-                m_buffer.add(byte);
-                break;
-        }
-    }
+BinaryTree::BinaryTree(const BinaryTreeIndexPtr& index, uint node) :
+    m_index(index), m_node(node), m_pos(0)
+{
+    m_data = m_index->getNodeData(m_node);
+    m_size = m_index->getNode(m_node).dataSize;
+}
+
+BinaryTree::~BinaryTree()
+{
 }
 
 BinaryTreeVec BinaryTree::getChildren()
 {
     BinaryTreeVec children;
-    m_fin->seek(m_startPos);
-    while(true) {
-        uint8 byte = m_fin->getU8();
-        switch(byte) {
-            case BINARYTREE_NODE_START: {
-                BinaryTreePtr node(new BinaryTree(m_fin));
-                children.push_back(node);
-                node->skipNodes();
-                break;
-            }
-            case BINARYTREE_NODE_END:
-                return children;
-            case BINARYTREE_ESCAPE_CHAR:
-                m_fin->getU8();
-                break;
-            default:
-                break;
-        }
-    }
+    const BinaryTreeIndex::Node& node = m_index->getNode(m_node);
+    children.reserve(node.childCount);
+    for(uint child = node.firstChild; child != BinaryTreeIndex::INVALID_NODE; child = m_index->getNode(child).nextSibling)
+        children.push_back(BinaryTreePtr(new BinaryTree(m_index, child)));
+    return children;
 }
 
 void BinaryTree::seek(uint pos)
 {
-    unserialize();
-    if(pos > m_buffer.size())
+    if(pos > m_size)
         stdext::throw_exception("BinaryTree: seek failed");
     m_pos = pos;
 }
 
 uint8 BinaryTree::getU8()
 {
-    unserialize();
-    if(m_pos+1 > m_buffer.size())
+    if(m_pos+1 > m_size)
         stdext::throw_exception("BinaryTree: getU8 failed");
-    uint8 v = m_buffer[m_pos];
+    uint8 v = m_data[m_pos];
     m_pos += 1;
     return v;
 }
 
 uint16 BinaryTree::getU16()
 {
-    unserialize();
-    if(m_pos+2 > m_buffer.size())
+    if(m_pos+2 > m_size)
         stdext::throw_exception("BinaryTree: getU16 failed");
-    uint16 v = stdext::readLE16(&m_buffer[m_pos]);
+    uint16 v = stdext::readLE16(m_data + m_pos);
     m_pos += 2;
     return v;
 }
 
 uint32 BinaryTree::getU32()
 {
-    unserialize();
-    if(m_pos+4 > m_buffer.size())
+    if(m_pos+4 > m_size)
         stdext::throw_exception("BinaryTree: getU32 failed");
-    uint32 v = stdext::readLE32(&m_buffer[m_pos]);
+    uint32 v = stdext::readLE32(m_data + m_pos);
     m_pos += 4;
     return v;
 }
 
 uint64 BinaryTree::getU64()
 {
-    unserialize();
-    if(m_pos+8 > m_buffer.size())
+    if(m_pos+8 > m_size)
         stdext::throw_exception("BinaryTree: getU64 failed");
-    uint64 v = stdext::readLE64(&m_buffer[m_pos]);
+    uint64 v = stdext::readLE64(m_data + m_pos);
     m_pos += 8;
     return v;
 }
 
 std::string BinaryTree::getString(uint16 len)
 {
-    unserialize();
     if(len == 0)
         len = getU16();
 
-    if(m_pos+len > m_buffer.size())
+    if(m_pos+len > m_size)
         stdext::throw_exception("BinaryTree: getString failed: string length exceeded buffer size.");
 
-    std::string ret((char *)&m_buffer[m_pos], len);
+    std::string ret((const char *)m_data + m_pos, len);
     m_pos += len;
     return ret;
 }
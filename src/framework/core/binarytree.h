@@ -32,16 +32,46 @@ enum {
     BINARYTREE_NODE_END = 0xFF
 };
 
+// Flat index of all nodes of a binary tree stream, built in a single pass over its escaped bytes
+class BinaryTreeIndex
+{
+public:
+    enum {
+        INVALID_NODE = 0xFFFFFFFF
+    };
+
+    struct Node {
+        uint dataOffset; // unescaped node properties, without the children
+        uint dataSize;
+        uint firstChild;
+        uint nextSibling;
+        uint childCount;
+    };
+
+    // the stream must be positioned just after the root node start byte
+    BinaryTreeIndex(const FileStreamPtr& fin);
+
+    const Node& getNode(uint node) { return m_nodes[node]; }
+    const uint8 *getNodeData(uint node) { return m_data.data() + m_nodes[node].dataOffset; }
+    uint getNodeCount() { return m_nodes.size(); }
+
+private:
+    std::vector<Node> m_nodes;
+    DataBuffer<uint8> m_data;
+};
+
+// Reader over one node of a BinaryTreeIndex
 class BinaryTree : public stdext::shared_object
 {
 public:
     BinaryTree(const FileStreamPtr& fin);
+    BinaryTree(const BinaryTreeIndexPtr& index, uint node);
     ~BinaryTree();
 
     void seek(uint pos);
     void skip(uint len) { seek(tell() + len); }
     uint tell() { return m_pos; }
-    uint size() { unserialize(); return m_buffer.size(); }
+    uint size() { return m_size; }
 
     uint8 getU8();
     uint16 getU16();
@@ -51,16 +81,17 @@ public:
     Point getPoint();
 
     BinaryTreeVec getChildren();
-    bool canRead() { unserialize(); return m_pos < m_buffer.size(); }
+    uint getChildCount() { return m_index->getNode(m_node).childCount; }
+    const BinaryTreeIndexPtr& getIndex() { return m_index; }
+    uint getNodeId() { return m_node; }
+    bool canRead() { return m_pos < m_size; }
 
 private:
-    void unserialize();
-    void skipNodes();
-
-    FileStreamPtr m_fin;
-    DataBuffer<uint8> m_buffer;
+    BinaryTreeIndexPtr m_index;
+    uint m_node;
+    const uint8 *m_data;
+    uint m_size;
     uint m_pos;
-    uint m_startPos;
 };
 
 class OutputBinaryTree : public stdext::shared_object
@@ -31,16 +31,22 @@ class Module;
 class Event;
 class ScheduledEvent;
 class FileStream;
+class MappedFile;
 class BinaryTree;
+class BinaryTreeIndex;
 class OutputBinaryTree;
 
 typedef stdext::shared_object_ptr<Module> ModulePtr;
 typedef stdext::shared_object_ptr<Event> EventPtr;
 typedef stdext::shared_object_ptr<ScheduledEvent> ScheduledEventPtr;
 typedef stdext::shared_object_ptr<FileStream> FileStreamPtr;
+typedef stdext::shared_object_ptr<MappedFile> MappedFilePtr;
 typedef stdext::shared_object_ptr<BinaryTree> BinaryTreePtr;
 typedef stdext::shared_object_ptr<OutputBinaryTree> OutputBinaryTreePtr;
 
 typedef std::vector<BinaryTreePtr> BinaryTreeVec;
 
+// shared by nodes read from different threads, so its reference count must be atomic
+typedef std::shared_ptr<BinaryTreeIndex> BinaryTreeIndexPtr;
+
 #endif
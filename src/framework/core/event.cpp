@@ -22,6 +22,30 @@
 
 #include "event.h"
 
+static stdext::block_pool<sizeof(Event)>& eventPool()
+{
+    // never destroyed, events may still be released during static destruction
+    static auto *pool = new stdext::block_pool<sizeof(Event)>(false);
+    return *pool;
+}
+
+void *Event::operator new(size_t size)
+{
+    if(size != sizeof(Event))
+        return ::operator new(size);
+    return eventPool().allocate();
+}
+
+void Event::operator delete(void *p, size_t size)
+{
+    if(!p)
+        return;
+    if(size != sizeof(Event))
+        ::operator delete(p);
+    else
+        eventPool().deallocate(p);
+}
+
 Event::Event(const std::function<void()>& callback) :
     m_callback(callback),
     m_canceled(false),
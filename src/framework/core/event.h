@@ -32,6 +32,9 @@ public:
     Event(const std::function<void()>& callback);
     virtual ~Event();
 
+    static void *operator new(size_t size);
+    static void operator delete(void *p, size_t size);
+
     virtual void execute();
     void cancel();
 
@@ -24,39 +24,51 @@
 
 #include <framework/core/clock.h>
 #include "timer.h"
+#include "profiler.h"
 
 EventDispatcher g_dispatcher;
 
+EventDispatcher::EventDispatcher()
+{
+    m_eventQueueHead = 0;
+    m_eventQueueSize = 0;
+    m_pollEventsSize = 0;
+}
+
 void EventDispatcher::shutdown()
 {
-    while(!m_eventList.empty())
+    while(m_eventQueueSize > 0)
         poll();
 
-    while(!m_scheduledEventList.empty()) {
-        ScheduledEventPtr scheduledEvent = m_scheduledEventList.top();
+    std::vector<ScheduledEventPtr> scheduledEvents;
+    m_scheduledEvents.takeAll(scheduledEvents);
+    for(const ScheduledEventPtr& scheduledEvent : scheduledEvents)
         scheduledEvent->cancel();
-        m_scheduledEventList.pop();
-    }
     m_disabled = true;
 }
 
 void EventDispatcher::poll()
 {
+    PROFILE_SCOPE("EventDispatcher::poll");
+
     int loops = 0;
-    for(int count = 0, max = m_scheduledEventList.size(); count < max && !m_scheduledEventList.empty(); ++count) {
-        ScheduledEventPtr scheduledEvent = m_scheduledEventList.top();
-        if(scheduledEvent->remainingTicks() > 0)
-            break;
-        m_scheduledEventList.pop();
+
+    // events may poll again, so the due list is taken out while running it
+    std::vector<ScheduledEventPtr> dueEvents;
+    dueEvents.swap(m_dueEvents);
+    m_scheduledEvents.advance(g_clock.millis(), dueEvents);
+    for(ScheduledEventPtr& scheduledEvent : dueEvents) {
         scheduledEvent->execute();
 
         if(scheduledEvent->nextCycle())
-            m_scheduledEventList.push(scheduledEvent);
+            m_scheduledEvents.add(scheduledEvent);
     }
+    dueEvents.clear();
+    m_dueEvents.swap(dueEvents);
 
     // execute events list until all events are out, this is needed because some events can schedule new events that would
     // change the UIWidgets layout, in this case we must execute these new events before we continue rendering,
-    m_pollEventsSize = m_eventList.size();
+    m_pollEventsSize = m_eventQueueSize;
     loops = 0;
     while(m_pollEventsSize > 0) {
         if(loops > 50) {
@@ -69,11 +81,10 @@ void EventDispatcher::poll()
         }
 
         for(int i=0;i<m_pollEventsSize;++i) {
-            EventPtr event = m_eventList.front();
-            m_eventList.pop_front();
+            EventPtr event = popEvent();
             event->execute();
         }
-        m_pollEventsSize = m_eventList.size();
+        m_pollEventsSize = m_eventQueueSize;
     }
 }
 
@@ -84,7 +95,7 @@ ScheduledEventPtr EventDispatcher::scheduleEvent(const std::function<void()>& ca
 
     assert(delay >= 0);
     ScheduledEventPtr scheduledEvent(new ScheduledEvent(callback, delay, 1));
-    m_scheduledEventList.push(scheduledEvent);
+    m_scheduledEvents.add(scheduledEvent);
     return scheduledEvent;
 }
 
@@ -95,7 +106,7 @@ ScheduledEventPtr EventDispatcher::cycleEvent(const std::function<void()>& callb
 
     assert(delay > 0);
     ScheduledEventPtr scheduledEvent(new ScheduledEvent(callback, delay, 0));
-    m_scheduledEventList.push(scheduledEvent);
+    m_scheduledEvents.add(scheduledEvent);
     return scheduledEvent;
 }
 
@@ -107,11 +118,39 @@ EventPtr EventDispatcher::addEvent(const std::function<void()>& callback, bool p
     EventPtr event(new Event(callback));
     // front pushing is a way to execute an event before others
     if(pushFront) {
-        m_eventList.push_front(event);
+        pushEvent(event, true);
         // the poll event list only grows when pushing into front
         m_pollEventsSize++;
     } else
-        m_eventList.push_back(event);
+        pushEvent(event, false);
     return event;
 }
 
+void EventDispatcher::pushEvent(EventPtr event, bool pushFront)
+{
+    if(m_eventQueueSize == m_eventQueue.size()) {
+        // unroll the ring into a bigger one
+        std::vector<EventPtr> eventQueue(std::max<std::size_t>(m_eventQueue.size() * 2, 64));
+        for(std::size_t i = 0; i < m_eventQueueSize; ++i)
+            eventQueue[i] = std::move(m_eventQueue[(m_eventQueueHead + i) & (m_eventQueue.size() - 1)]);
+        m_eventQueue.swap(eventQueue);
+        m_eventQueueHead = 0;
+    }
+
+    std::size_t mask = m_eventQueue.size() - 1;
+    if(pushFront) {
+        m_eventQueueHead = (m_eventQueueHead - 1) & mask;
+        m_eventQueue[m_eventQueueHead] = std::move(event);
+    } else
+        m_eventQueue[(m_eventQueueHead + m_eventQueueSize) & mask] = std::move(event);
+    m_eventQueueSize++;
+}
+
+EventPtr EventDispatcher::popEvent()
+{
+    assert(m_eventQueueSize > 0);
+    EventPtr event = std::move(m_eventQueue[m_eventQueueHead]);
+    m_eventQueueHead = (m_eventQueueHead + 1) & (m_eventQueue.size() - 1);
+    m_eventQueueSize--;
+    return event;
+}
@@ -25,13 +25,14 @@
 
 #include "clock.h"
 #include "scheduledevent.h"
-
-#include <queue>
+#include "timerwheel.h"
 
 // @bindsingleton g_dispatcher
 class EventDispatcher
 {
 public:
+    EventDispatcher();
+
     void shutdown();
     void poll();
 
@@ -40,10 +41,17 @@ public:
     ScheduledEventPtr cycleEvent(const std::function<void()>& callback, int delay);
 
 private:
-    std::list<EventPtr> m_eventList;
+    void pushEvent(EventPtr event, bool pushFront);
+    EventPtr popEvent();
+
+    // immediate events, a ring over a power of two sized vector
+    std::vector<EventPtr> m_eventQueue;
+    std::size_t m_eventQueueHead;
+    std::size_t m_eventQueueSize;
     int m_pollEventsSize;
     stdext::boolean<false> m_disabled;
-    std::priority_queue<ScheduledEventPtr, std::vector<ScheduledEventPtr>, lessScheduledEvent> m_scheduledEventList;
+    TimerWheel m_scheduledEvents;
+    std::vector<ScheduledEventPtr> m_dueEvents;
 };
 
 extern EventDispatcher g_dispatcher;
@@ -24,6 +24,7 @@
 #include "graphicalapplication.h"
 #include <framework/core/clock.h>
 #include <framework/core/eventdispatcher.h>
+#include <framework/core/profiler.h>
 #include <framework/platform/platformwindow.h>
 #include <framework/ui/uimanager.h>
 #include <framework/graphics/graphics.h>
@@ -122,6 +123,8 @@ void GraphicalApplication::run()
     g_lua.callGlobalField("g_app", "onRun");
 
     while(!m_stopping) {
+        g_profiler.beginFrame();
+
         // poll all events before rendering
         poll();
 
@@ -131,22 +134,44 @@ void GraphicalApplication::run()
             // foreground pane - steady pane with few animated stuff (UI)
             bool redraw = false;
             bool updateForeground = false;
+            bool partialForeground = false;
 
-            bool cacheForeground = g_graphics.canCacheBackbuffer() && m_foregroundFrameCounter.getMaxFps() != 0;
+            // a foreground with a framerate limit is cached and redrawn whole at that rate, one without a limit
+            // is cached too when widgets report their changes as damaged rects, otherwise it is drawn every frame
+            bool limitForeground = m_foregroundFrameCounter.getMaxFps() != 0;
+            bool cacheForeground = g_graphics.canCacheBackbuffer() && (limitForeground || g_ui.isPartialRedraw());
 
             if(m_backgroundFrameCounter.shouldProcessNextFrame()) {
                 redraw = true;
 
-                if(m_mustRepaint || m_foregroundFrameCounter.shouldProcessNextFrame()) {
+                if(m_mustRepaint || (limitForeground && m_foregroundFrameCounter.shouldProcessNextFrame())) {
                     m_mustRepaint = false;
                     updateForeground = true;
-                }
+                } else if(g_ui.hasDamage())
+                    partialForeground = true;
             }
 
             if(redraw) {
                 if(cacheForeground) {
                     Rect viewportRect(0, 0, g_painter->getResolution());
 
+                    // redraw only the damaged regions of the cached foreground
+                    if(partialForeground) {
+                        g_painter->setAlphaWriting(true);
+
+                        for(const Rect& rect : g_ui.takeDamagedRects()) {
+                            g_painter->clearRect(Color::alpha, rect);
+                            g_ui.render(Fw::ForegroundPane, rect);
+
+                            // the foreground texture is upside down, rows are addressed from the bottom like the screen
+                            Rect screenRect(rect.left(), viewportRect.height() - rect.bottom() - 1, rect.width(), rect.height());
+                            m_foreground->copyFromScreen(screenRect, screenRect.topLeft());
+                        }
+
+                        g_painter->clear(Color::black);
+                        g_painter->setAlphaWriting(false);
+                    }
+
                     // draw the foreground into a texture
                     if(updateForeground) {
                         m_foregroundFrameCounter.processNextFrame();
@@ -177,7 +202,9 @@ void GraphicalApplication::run()
                     g_ui.render(Fw::BothPanes);
                 }
 
-                // update screen pixels
+                // send pending batched draws and update screen pixels
+                PROFILE_SCOPE("swapBuffers");
+                g_painter->endFrame();
                 g_window.swapBuffers();
             }
 
@@ -188,11 +215,16 @@ void GraphicalApplication::run()
                 g_lua.callGlobalField("g_app", "onFps", m_backgroundFrameCounter.getLastFps());
             m_foregroundFrameCounter.update();
 
+            // sleeping is not part of the frame
+            g_profiler.endFrame(redraw);
+
             int sleepMicros = m_backgroundFrameCounter.getMaximumSleepMicros();
             if(sleepMicros >= AdaptativeFrameCounter::MINIMUM_MICROS_SLEEP)
                 stdext::microsleep(sleepMicros);
 
         } else {
+            g_profiler.endFrame(false);
+
             // sleeps until next poll to avoid massive cpu usage
             stdext::millisleep(POLL_CYCLE_DELAY+1);
             g_clock.update();
@@ -34,10 +34,87 @@
 
 Logger g_logger;
 
-void Logger::log(Fw::LogLevel level, const std::string& message)
+Logger::Logger()
+{
+    for(std::size_t i = 0; i < LOG_RING_SIZE; ++i)
+        m_ring[i].sequence = i;
+    m_enqueuePos = 0;
+    m_dequeuePos = 0;
+    m_writtenPos = 0;
+    m_dropped = 0;
+    m_totalDropped = 0;
+    m_overflowPolicy = Fw::LogOverflowDrop;
+    m_writerSleeping = false;
+    m_running = false;
+    m_drainWaiters = 0;
+    m_polledDropped = 0;
+}
+
+Logger::~Logger()
+{
+    terminate();
+}
+
+void Logger::init()
 {
+    if(m_running)
+        return;
+
+    m_running = true;
+    m_writerThread = std::thread(std::bind(&Logger::writeLoop, this));
+}
+
+void Logger::terminate()
+{
+    if(!m_running)
+        return;
+
+    {
+        std::lock_guard<std::mutex> lock(m_writerMutex);
+        m_running = false;
+        m_writerCondition.notify_one();
+    }
+    m_writerThread.join();
+
+    // from now on messages are written right away, the writer is gone so this thread can empty the ring
     std::lock_guard<std::recursive_mutex> lock(m_mutex);
+    std::vector<LogMessage> messages;
+    while(tryPop(messages));
+    for(const LogMessage& logMessage : messages)
+        writeMessage(logMessage.message);
+
+    // messages not polled yet are only kept, the callback may not be usable anymore
+    std::lock_guard<std::mutex> pollLock(m_pollMutex);
+    messages.insert(messages.begin(), m_polledMessages.begin(), m_polledMessages.end());
+    m_polledMessages.clear();
+    for(const LogMessage& logMessage : messages)
+        addHistory(logMessage.level, logMessage.message, logMessage.when);
+}
+
+void Logger::poll()
+{
+    std::vector<LogMessage> messages;
+    int dropped;
+    {
+        std::lock_guard<std::mutex> lock(m_pollMutex);
+        messages.swap(m_polledMessages);
+        dropped = m_polledDropped;
+        m_polledDropped = 0;
+    }
 
+    if(dropped > 0)
+        messages.insert(messages.begin(), LogMessage(Fw::LogWarning, stdext::format("WARNING: %d log messages were only written to the log file, they came faster than they were polled", dropped), std::time(NULL)));
+
+    // the callback can run lua code, so it's only fired from the main thread
+    for(const LogMessage& logMessage : messages) {
+        addHistory(logMessage.level, logMessage.message, logMessage.when);
+        if(m_onLog)
+            m_onLog(logMessage.level, logMessage.message, logMessage.when);
+    }
+}
+
+void Logger::log(Fw::LogLevel level, const std::string& message)
+{
 #ifdef NDEBUG
     if(level == Fw::LogDebug)
         return;
@@ -67,27 +144,36 @@ void Logger::log(Fw::LogLevel level, const std::string& message)
 #endif
     */
 
-    std::cout << outmsg << std::endl;
+    std::size_t now = std::time(NULL);
 
-    if(m_outFile.good()) {
-        m_outFile << outmsg << std::endl;
-        m_outFile.flush();
-    }
+    if(!m_running) {
+        std::lock_guard<std::recursive_mutex> lock(m_mutex);
 
-    std::size_t now = std::time(NULL);
-    m_logMessages.push_back(LogMessage(level, outmsg, now));
-    if(m_logMessages.size() > MAX_LOG_HISTORY)
-        m_logMessages.pop_front();
+        writeMessage(outmsg);
+        addHistory(level, outmsg, now);
 
-    if(m_onLog) {
-        // schedule log callback, because this callback can run lua code that may affect the current state
-        g_dispatcher.addEvent([=] {
-            if(m_onLog)
-                m_onLog(level, outmsg, now);
-        });
+        if(m_onLog) {
+            // schedule log callback, because this callback can run lua code that may affect the current state
+            g_dispatcher.addEvent([=] {
+                if(m_onLog)
+                    m_onLog(level, outmsg, now);
+            });
+        }
+    } else if(level == Fw::LogFatal || m_overflowPolicy == Fw::LogOverflowBlock) {
+        pushBlocking(level, outmsg, now);
+    } else if(tryPush(level, outmsg, now)) {
+        if(m_writerSleeping) {
+            std::lock_guard<std::mutex> lock(m_writerMutex);
+            m_writerCondition.notify_one();
+        }
+    } else {
+        m_dropped++;
+        m_totalDropped++;
     }
 
     if(level == Fw::LogFatal) {
+        // the message must be in the log file before exiting
+        flush();
 #ifdef FW_GRAPHICS
         g_window.displayFatalError(message);
 #endif
@@ -98,8 +184,6 @@ void Logger::log(Fw::LogLevel level, const std::string& message)
 
 void Logger::logFunc(Fw::LogLevel level, const std::string& message, std::string prettyFunction)
 {
-    std::lock_guard<std::recursive_mutex> lock(m_mutex);
-
     prettyFunction = prettyFunction.substr(0, prettyFunction.find_first_of('('));
     if(prettyFunction.find_last_of(' ') != std::string::npos)
         prettyFunction = prettyFunction.substr(prettyFunction.find_last_of(' ') + 1);
@@ -117,12 +201,63 @@ void Logger::logFunc(Fw::LogLevel level, const std::string& message, std::string
     log(level, ss.str());
 }
 
-void Logger::fireOldMessages()
+void Logger::flush()
 {
-    std::lock_guard<std::recursive_mutex> lock(m_mutex);
+    if(!m_running) {
+        std::lock_guard<std::recursive_mutex> lock(m_mutex);
+        std::cout.flush();
+        if(m_outFile.good())
+            m_outFile.flush();
+        return;
+    }
+
+    // waits until the writer has written every message queued so far
+    std::size_t target = m_enqueuePos;
+    std::unique_lock<std::mutex> lock(m_writerMutex);
+    m_drainWaiters++;
+    while(m_writtenPos < target) {
+        m_writerCondition.notify_one();
+        m_drainCondition.wait(lock);
+    }
+    m_drainWaiters--;
+}
 
+bool Logger::tryFlush(int timeout)
+{
+    // unlike flush it never waits on a lock, the thread holding it or the writer itself may be dead
+    ticks_t deadline = stdext::millis() + timeout;
+
+    if(!m_running) {
+        while(!m_mutex.try_lock()) {
+            if(stdext::millis() >= deadline)
+                return false;
+            stdext::millisleep(1);
+        }
+        std::cout.flush();
+        if(m_outFile.good())
+            m_outFile.flush();
+        m_mutex.unlock();
+        return true;
+    }
+
+    std::size_t target = m_enqueuePos;
+    while(m_writtenPos < target) {
+        if(stdext::millis() >= deadline)
+            return false;
+        m_writerCondition.notify_one();
+        stdext::millisleep(1);
+    }
+    return true;
+}
+
+void Logger::fireOldMessages()
+{
     if(m_onLog) {
-        auto backup = m_logMessages;
+        std::list<LogMessage> backup;
+        {
+            std::lock_guard<std::recursive_mutex> lock(m_mutex);
+            backup = m_logMessages;
+        }
         for(const LogMessage& logMessage : backup) {
             m_onLog(logMessage.level, logMessage.message, logMessage.when);
         }
@@ -131,12 +266,150 @@ void Logger::fireOldMessages()
 
 void Logger::setLogFile(const std::string& file)
 {
-    std::lock_guard<std::recursive_mutex> lock(m_mutex);
+    bool opened;
+    {
+        std::lock_guard<std::recursive_mutex> lock(m_mutex);
+        m_outFile.open(stdext::utf8_to_latin1(file.c_str()).c_str(), std::ios::out | std::ios::app);
+        opened = m_outFile.is_open() && m_outFile.good();
+        if(opened)
+            m_outFile.flush();
+    }
 
-    m_outFile.open(stdext::utf8_to_latin1(file.c_str()).c_str(), std::ios::out | std::ios::app);
-    if(!m_outFile.is_open() || !m_outFile.good()) {
+    // logged outside the lock, the writer thread needs it to write this message
+    if(!opened)
         g_logger.error(stdext::format("Unable to save log to '%s'", file));
-        return;
+}
+
+void Logger::writeMessage(const std::string& message)
+{
+    std::cout << message << std::endl;
+
+    if(m_outFile.good()) {
+        m_outFile << message << std::endl;
+        m_outFile.flush();
+    }
+}
+
+void Logger::addHistory(Fw::LogLevel level, const std::string& message, std::size_t when)
+{
+    std::lock_guard<std::recursive_mutex> lock(m_mutex);
+
+    m_logMessages.push_back(LogMessage(level, message, when));
+    if(m_logMessages.size() > MAX_LOG_HISTORY)
+        m_logMessages.pop_front();
+}
+
+bool Logger::tryPush(Fw::LogLevel level, const std::string& message, std::size_t when)
+{
+    // bounded multi producer queue, a slot sequence tells whether it's free or holds a message for that position
+    std::size_t pos = m_enqueuePos.load(std::memory_order_relaxed);
+    LogSlot *slot;
+    while(true) {
+        slot = &m_ring[pos % LOG_RING_SIZE];
+        std::size_t sequence = slot->sequence.load(std::memory_order_acquire);
+        intptr_t diff = (intptr_t)sequence - (intptr_t)pos;
+        if(diff == 0) {
+            if(m_enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                break;
+        } else if(diff < 0)
+            return false;
+        else
+            pos = m_enqueuePos.load(std::memory_order_relaxed);
+    }
+
+    slot->level = level;
+    slot->message = message;
+    slot->when = when;
+    // sequentially consistent, so either the writer sees it before sleeping or the pusher sees the writer asleep
+    slot->sequence.store(pos + 1);
+    return true;
+}
+
+bool Logger::tryPop(std::vector<LogMessage>& messages)
+{
+    LogSlot& slot = m_ring[m_dequeuePos % LOG_RING_SIZE];
+    if(slot.sequence.load(std::memory_order_acquire) != m_dequeuePos + 1)
+        return false;
+
+    messages.push_back(LogMessage(slot.level, std::string(), slot.when));
+    messages.back().message.swap(slot.message);
+    slot.sequence.store(m_dequeuePos + LOG_RING_SIZE, std::memory_order_release);
+    m_dequeuePos++;
+    return true;
+}
+
+bool Logger::isRingEmpty()
+{
+    return m_ring[m_dequeuePos % LOG_RING_SIZE].sequence.load() != m_dequeuePos + 1;
+}
+
+void Logger::pushBlocking(Fw::LogLevel level, const std::string& message, std::size_t when)
+{
+    std::unique_lock<std::mutex> lock(m_writerMutex);
+    m_drainWaiters++;
+    while(!tryPush(level, message, when)) {
+        m_writerCondition.notify_one();
+        m_drainCondition.wait(lock);
+    }
+    m_drainWaiters--;
+    m_writerCondition.notify_one();
+}
+
+void Logger::writeLoop()
+{
+    std::vector<LogMessage> batch;
+    std::string buffer;
+
+    while(true) {
+        batch.clear();
+        while(batch.size() < MAX_LOG_BATCH && tryPop(batch));
+        std::size_t popped = batch.size();
+
+        int dropped = m_dropped.exchange(0);
+        if(dropped > 0)
+            batch.push_back(LogMessage(Fw::LogWarning, stdext::format("WARNING: %d log messages were dropped because the log queue was full", dropped), std::time(NULL)));
+
+        if(batch.empty()) {
+            std::unique_lock<std::mutex> lock(m_writerMutex);
+            if(!m_running)
+                break;
+            m_writerSleeping = true;
+            if(isRingEmpty() && m_dropped == 0)
+                m_writerCondition.wait(lock);
+            m_writerSleeping = false;
+            continue;
+        }
+
+        // the whole batch goes out in a single write and flush
+        buffer.clear();
+        for(const LogMessage& logMessage : batch) {
+            buffer += logMessage.message;
+            buffer += '\n';
+        }
+
+        {
+            std::lock_guard<std::recursive_mutex> lock(m_mutex);
+            std::cout << buffer << std::flush;
+            if(m_outFile.good()) {
+                m_outFile << buffer;
+                m_outFile.flush();
+            }
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(m_pollMutex);
+            m_polledMessages.insert(m_polledMessages.end(), batch.begin(), batch.end());
+            if(m_polledMessages.size() > MAX_LOG_HISTORY) {
+                // the oldest ones are counted, poll reports how many the callbacks missed
+                std::size_t trimmed = m_polledMessages.size() - MAX_LOG_HISTORY;
+                m_polledDropped += trimmed;
+                m_polledMessages.erase(m_polledMessages.begin(), m_polledMessages.begin() + trimmed);
+            }
+        }
+
+        std::lock_guard<std::mutex> lock(m_writerMutex);
+        m_writtenPos += popped;
+        if(m_drainWaiters > 0)
+            m_drainCondition.notify_all();
     }
-    m_outFile.flush();
 }
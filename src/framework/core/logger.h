@@ -27,6 +27,7 @@
 
 #include <framework/stdext/thread.h>
 #include <fstream>
+#include <atomic>
 
 struct LogMessage {
     LogMessage(Fw::LogLevel level, const std::string& message, std::size_t when) : level(level), message(message), when(when) { }
@@ -36,15 +37,33 @@ struct LogMessage {
 };
 
 // @bindsingleton g_logger
+// Once initialized, messages are queued into a bounded lock-free ring and written
+// in batches by a background thread, the log callbacks run later in the main thread
 class Logger
 {
     enum {
-        MAX_LOG_HISTORY = 1000
+        MAX_LOG_HISTORY = 1000,
+        LOG_RING_SIZE = 4096,
+        MAX_LOG_BATCH = 256
+    };
+
+    struct LogSlot {
+        std::atomic<std::size_t> sequence;
+        Fw::LogLevel level;
+        std::string message;
+        std::size_t when;
     };
 
     typedef std::function<void(Fw::LogLevel, const std::string&, int64)> OnLogCallback;
 
 public:
+    Logger();
+    ~Logger();
+
+    void init();
+    void terminate();
+    void poll();
+
     void log(Fw::LogLevel level, const std::string& message);
     void logFunc(Fw::LogLevel level, const std::string& message, std::string prettyFunction);
 
@@ -54,15 +73,50 @@ public:
     void error(const std::string& what) { log(Fw::LogError, what); }
     void fatal(const std::string& what) { log(Fw::LogFatal, what); }
 
+    void flush();
+    bool tryFlush(int timeout);
     void fireOldMessages();
     void setLogFile(const std::string& file);
     void setOnLog(const OnLogCallback& onLog) { m_onLog = onLog; }
+    void setOverflowPolicy(Fw::LogOverflowPolicy policy) { m_overflowPolicy = policy; }
+    Fw::LogOverflowPolicy getOverflowPolicy() { return m_overflowPolicy; }
+    int getDroppedMessages() { return m_totalDropped; }
 
 private:
+    void writeMessage(const std::string& message);
+    void addHistory(Fw::LogLevel level, const std::string& message, std::size_t when);
+    bool tryPush(Fw::LogLevel level, const std::string& message, std::size_t when);
+    bool tryPop(std::vector<LogMessage>& messages);
+    bool isRingEmpty();
+    void pushBlocking(Fw::LogLevel level, const std::string& message, std::size_t when);
+    void writeLoop();
+
     std::list<LogMessage> m_logMessages;
     OnLogCallback m_onLog;
     std::ofstream m_outFile;
     std::recursive_mutex m_mutex;
+
+    // ring of queued messages, any thread pushes and only the writer thread pops
+    LogSlot m_ring[LOG_RING_SIZE];
+    std::atomic<std::size_t> m_enqueuePos;
+    std::size_t m_dequeuePos;
+    std::atomic<std::size_t> m_writtenPos;
+    std::atomic<int> m_dropped;
+    std::atomic<int> m_totalDropped;
+    std::atomic<Fw::LogOverflowPolicy> m_overflowPolicy;
+
+    std::thread m_writerThread;
+    std::mutex m_writerMutex;
+    std::condition_variable m_writerCondition;
+    std::condition_variable m_drainCondition;
+    std::atomic<bool> m_writerSleeping;
+    std::atomic<bool> m_running;
+    int m_drainWaiters;
+
+    // written messages waiting for the main thread to keep and fire them
+    std::mutex m_pollMutex;
+    std::vector<LogMessage> m_polledMessages;
+    int m_polledDropped;
 };
 
 extern Logger g_logger;
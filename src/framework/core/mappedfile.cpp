@@ -0,0 +1,112 @@
+/*
+ * Copyright (c) 2010-2013 OTClient <https://github.com/edubart/otclient>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+#include "mappedfile.h"
+
+#ifdef WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#ifdef WIN32
+
+MappedFile::MappedFile(const std::string& path) :
+    m_name(path),
+    m_data(nullptr),
+    m_size(0),
+    m_fileHandle(INVALID_HANDLE_VALUE),
+    m_mappingHandle(NULL)
+{
+    std::string file = path;
+    stdext::replace_all(file, "/", "\\");
+    std::wstring wfile = stdext::utf8_to_utf16(file);
+
+    m_fileHandle = CreateFileW(wfile.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if(m_fileHandle == INVALID_HANDLE_VALUE)
+        stdext::throw_exception(stdext::format("unable to open file '%s'", path));
+
+    LARGE_INTEGER size;
+    if(!GetFileSizeEx(m_fileHandle, &size) || size.HighPart != 0 || size.LowPart == 0) {
+        CloseHandle(m_fileHandle);
+        stdext::throw_exception(stdext::format("unable to map file '%s': invalid size", path));
+    }
+
+    m_mappingHandle = CreateFileMappingW(m_fileHandle, NULL, PAGE_READONLY, 0, 0, NULL);
+    if(m_mappingHandle)
+        m_data = (uint8*)MapViewOfFile(m_mappingHandle, FILE_MAP_READ, 0, 0, 0);
+
+    if(!m_data) {
+        if(m_mappingHandle)
+            CloseHandle(m_mappingHandle);
+        CloseHandle(m_fileHandle);
+        stdext::throw_exception(stdext::format("unable to map file '%s'", path));
+    }
+    m_size = size.LowPart;
+}
+
+MappedFile::~MappedFile()
+{
+    UnmapViewOfFile(m_data);
+    CloseHandle(m_mappingHandle);
+    CloseHandle(m_fileHandle);
+}
+
+#else
+
+MappedFile::MappedFile(const std::string& path) :
+    m_name(path),
+    m_data(nullptr),
+    m_size(0),
+    m_fd(-1)
+{
+    m_fd = open(path.c_str(), O_RDONLY);
+    if(m_fd == -1)
+        stdext::throw_exception(stdext::format("unable to open file '%s': %s", path, strerror(errno)));
+
+    struct stat st;
+    if(fstat(m_fd, &st) != 0 || st.st_size <= 0 || (uint64)st.st_size > 0xFFFFFFFFul) {
+        close(m_fd);
+        stdext::throw_exception(stdext::format("unable to map file '%s': invalid size", path));
+    }
+
+    void *data = mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, m_fd, 0);
+    if(data == MAP_FAILED) {
+        close(m_fd);
+        stdext::throw_exception(stdext::format("unable to map file '%s': %s", path, strerror(errno)));
+    }
+
+    m_data = (uint8*)data;
+    m_size = st.st_size;
+}
+
+MappedFile::~MappedFile()
+{
+    munmap(m_data, m_size);
+    close(m_fd);
+}
+
+#endif
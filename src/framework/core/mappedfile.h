@@ -0,0 +1,54 @@
+/*
+ * Copyright (c) 2010-2013 OTClient <https://github.com/edubart/otclient>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+#ifndef MAPPEDFILE_H
+#define MAPPEDFILE_H
+
+#include "declarations.h"
+
+// read only memory mapped view of a file on the native filesystem
+class MappedFile : public stdext::shared_object
+{
+public:
+    MappedFile(const std::string& path);
+    ~MappedFile();
+
+    const uint8 *data() { return m_data; }
+    uint size() { return m_size; }
+    std::string name() { return m_name; }
+
+    bool canRead(uint pos, uint len) { return pos <= m_size && len <= m_size - pos; }
+
+private:
+    std::string m_name;
+    uint8 *m_data;
+    uint m_size;
+#ifdef WIN32
+    void *m_fileHandle;
+    void *m_mappingHandle;
+#else
+    int m_fd;
+#endif
+};
+
+#endif
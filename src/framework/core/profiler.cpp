@@ -0,0 +1,225 @@
+/*
+ * Copyright (c) 2010-2013 OTClient <https://github.com/edubart/otclient>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "profiler.h"
+#include "resourcemanager.h"
+#include <framework/stdext/time.h>
+
+#include <algorithm>
+#include <cstring>
+
+Profiler g_profiler;
+
+Profiler::Profiler() : m_threadRing(&Profiler::keepThreadRing)
+{
+    m_enabled = false;
+    m_clearTime = 0;
+    m_frameRing = nullptr;
+    m_mainRing = nullptr;
+    m_frameStartPos = 0;
+    m_frameStart = 0;
+    m_frameTime = 0;
+}
+
+void Profiler::setEnabled(bool enabled)
+{
+    m_enabled.store(enabled, std::memory_order_relaxed);
+}
+
+void Profiler::beginFrame()
+{
+    if(!isEnabled()) {
+        m_frameRing = nullptr;
+        return;
+    }
+
+    m_frameRing = getThreadRing();
+    m_mainRing = m_frameRing;
+    m_frameStartPos = m_frameRing->writePos.load(std::memory_order_relaxed);
+    m_frameStart = beginScope();
+}
+
+void Profiler::endFrame(bool rendered)
+{
+    if(!m_frameRing)
+        return;
+
+    // iterations that only polled would replace the numbers of the last drawn frame
+    if(!rendered) {
+        m_frameRing->depth--;
+        m_frameRing = nullptr;
+        return;
+    }
+
+    endScope("frame", m_frameStart);
+    m_frameTime = stdext::micros() - m_frameStart;
+
+    std::vector<ScopeRecord> records;
+    readRing(m_frameRing, m_frameStartPos, records);
+    collectFrameScopes(records);
+    m_frameRing = nullptr;
+}
+
+ticks_t Profiler::beginScope()
+{
+    getThreadRing()->depth++;
+    return stdext::micros();
+}
+
+void Profiler::endScope(const char* name, ticks_t start)
+{
+    ticks_t now = stdext::micros();
+    ThreadRing *ring = getThreadRing();
+    ring->depth--;
+
+    std::size_t pos = ring->writePos.load(std::memory_order_relaxed);
+    ScopeRecord& record = ring->records[pos & (THREAD_RING_SIZE - 1)];
+    record.name = name;
+    record.start = start;
+    record.duration = now - start;
+    record.depth = ring->depth;
+    ring->writePos.store(pos + 1, std::memory_order_release);
+}
+
+void Profiler::clear()
+{
+    m_clearTime = stdext::micros();
+    m_frameTime = 0;
+    m_frameScopes.clear();
+}
+
+bool Profiler::exportTrace(const std::string& fileName)
+{
+    std::stringstream ss;
+    ss << "{\"traceEvents\":[";
+
+    bool first = true;
+    std::vector<ScopeRecord> records;
+    std::lock_guard<std::mutex> lock(m_threadRingsMutex);
+    for(const std::unique_ptr<ThreadRing>& ring : m_threadRings) {
+        if(!first)
+            ss << ",";
+        first = false;
+
+        std::string threadName = ring.get() == m_mainRing ? "main" : stdext::format("thread %d", ring->id);
+        ss << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":" << ring->id << ",\"args\":{\"name\":\"" << threadName << "\"}}";
+
+        records.clear();
+        readRing(ring.get(), 0, records);
+        for(const ScopeRecord& record : records) {
+            if(record.start < m_clearTime)
+                continue;
+            // scope names are literals in the sources, there is nothing to escape
+            ss << ",{\"name\":\"" << record.name << "\",\"ph\":\"X\",\"ts\":" << record.start << ",\"dur\":" << record.duration
+               << ",\"pid\":0,\"tid\":" << ring->id << "}";
+        }
+    }
+
+    ss << "],\"displayTimeUnit\":\"ms\"}";
+    return g_resources.writeFileContents(fileName, ss.str());
+}
+
+Profiler::ThreadRing *Profiler::getThreadRing()
+{
+    ThreadRing *ring = m_threadRing.get();
+    if(!ring) {
+        ring = new ThreadRing;
+        ring->depth = 0;
+        ring->writePos = 0;
+
+        std::lock_guard<std::mutex> lock(m_threadRingsMutex);
+        ring->id = m_threadRings.size();
+        m_threadRings.push_back(std::unique_ptr<ThreadRing>(ring));
+        m_threadRing.reset(ring);
+    }
+    return ring;
+}
+
+void Profiler::readRing(ThreadRing *ring, std::size_t from, std::vector<ScopeRecord>& records)
+{
+    std::size_t end = ring->writePos.load(std::memory_order_acquire);
+    if(end > THREAD_RING_SIZE)
+        from = std::max<std::size_t>(from, end - THREAD_RING_SIZE);
+
+    std::size_t first = records.size();
+    for(std::size_t pos = from; pos < end; ++pos)
+        records.push_back(ring->records[pos & (THREAD_RING_SIZE - 1)]);
+
+    // the owner thread may have lapped the oldest records while they were copied
+    std::size_t after = ring->writePos.load(std::memory_order_acquire);
+    if(after >= THREAD_RING_SIZE && after - THREAD_RING_SIZE >= from) {
+        std::size_t lapped = std::min(after - THREAD_RING_SIZE + 1 - from, end - from);
+        records.erase(records.begin() + first, records.begin() + first + lapped);
+    }
+}
+
+void Profiler::collectFrameScopes(std::vector<ScopeRecord>& records)
+{
+    // records are written when scopes end, sorting by start puts parents before their children
+    std::stable_sort(records.begin(), records.end(), [](const ScopeRecord& a, const ScopeRecord& b) {
+        return a.start < b.start || (a.start == b.start && a.depth < b.depth);
+    });
+
+    struct ScopeNode {
+        const char* name;
+        int depth;
+        ticks_t time;
+        int calls;
+        std::vector<int> children;
+    };
+
+    // equal scopes under the same parent are merged
+    std::vector<ScopeNode> nodes;
+    std::vector<int> roots;
+    std::vector<int> path;
+    int baseDepth = records.empty() ? 0 : records.front().depth;
+    for(const ScopeRecord& record : records) {
+        int level = std::max(record.depth - baseDepth, 0);
+        path.resize(std::min<std::size_t>(level, path.size()));
+
+        std::vector<int>& siblings = path.empty() ? roots : nodes[path.back()].children;
+        auto it = std::find_if(siblings.begin(), siblings.end(), [&](int i) {
+            return nodes[i].name == record.name || std::strcmp(nodes[i].name, record.name) == 0;
+        });
+
+        int index;
+        if(it == siblings.end()) {
+            index = nodes.size();
+            siblings.push_back(index);
+            nodes.push_back({ record.name, (int)path.size(), 0, 0, {} });
+        } else
+            index = *it;
+
+        nodes[index].time += record.duration;
+        nodes[index].calls++;
+        path.push_back(index);
+    }
+
+    m_frameScopes.clear();
+    std::vector<int> pending(roots.rbegin(), roots.rend());
+    while(!pending.empty()) {
+        const ScopeNode& node = nodes[pending.back()];
+        pending.pop_back();
+        m_frameScopes.push_back(std::make_tuple(std::string(node.name), node.depth, node.time / 1000.0, node.calls));
+        pending.insert(pending.end(), node.children.rbegin(), node.children.rend());
+    }
+}
@@ -0,0 +1,123 @@
+/*
+ * Copyright (c) 2010-2013 OTClient <https://github.com/edubart/otclient>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include "declarations.h"
+#include <framework/stdext/thread.h>
+#include <boost/thread/tss.hpp>
+#include <atomic>
+
+// Measures named scopes while enabled, each thread records into its own ring so no locking is needed.
+// Scope names are kept as plain pointers, they must be string literals.
+// @bindsingleton g_profiler
+class Profiler
+{
+public:
+    enum {
+        THREAD_RING_SIZE = 32768 // must be a power of two
+    };
+
+    Profiler();
+
+    void setEnabled(bool enabled);
+    bool isEnabled() { return m_enabled.load(std::memory_order_relaxed); }
+
+    // the main loop wraps every iteration with these, the scopes of the last drawn frame are kept for lua
+    void beginFrame();
+    void endFrame(bool rendered);
+
+    ticks_t beginScope();
+    void endScope(const char* name, ticks_t start);
+
+    // forgets everything recorded until now
+    void clear();
+    // saves the recorded scopes of all threads in chrome trace event format
+    bool exportTrace(const std::string& fileName);
+
+    double getFrameTime() { return m_frameTime / 1000.0; }
+    // name, depth, milliseconds and calls of each scope of the last drawn frame, in tree order
+    std::vector<std::tuple<std::string, int, double, int>> getFrameScopes() { return m_frameScopes; }
+
+private:
+    struct ScopeRecord {
+        const char* name;
+        ticks_t start;
+        ticks_t duration;
+        int depth;
+    };
+
+    struct ThreadRing {
+        int id;
+        int depth;
+        // only the owner thread writes, readers drop whatever may have been overwritten while copying
+        std::atomic<std::size_t> writePos;
+        ScopeRecord records[THREAD_RING_SIZE];
+    };
+
+    // rings outlive their threads, they are owned by the profiler
+    static void keepThreadRing(ThreadRing*) { }
+
+    ThreadRing *getThreadRing();
+    void readRing(ThreadRing *ring, std::size_t from, std::vector<ScopeRecord>& records);
+    void collectFrameScopes(std::vector<ScopeRecord>& records);
+
+    std::atomic<bool> m_enabled;
+    boost::thread_specific_ptr<ThreadRing> m_threadRing;
+    std::vector<std::unique_ptr<ThreadRing>> m_threadRings;
+    std::mutex m_threadRingsMutex;
+    ticks_t m_clearTime;
+
+    ThreadRing *m_frameRing;
+    ThreadRing *m_mainRing;
+    std::size_t m_frameStartPos;
+    ticks_t m_frameStart;
+    ticks_t m_frameTime;
+    std::vector<std::tuple<std::string, int, double, int>> m_frameScopes;
+};
+
+extern Profiler g_profiler;
+
+class ProfileScope
+{
+public:
+    ProfileScope(const char* name) {
+        if(g_profiler.isEnabled()) {
+            m_name = name;
+            m_start = g_profiler.beginScope();
+        } else
+            m_name = nullptr;
+    }
+    ~ProfileScope() {
+        if(m_name)
+            g_profiler.endScope(m_name, m_start);
+    }
+
+private:
+    const char* m_name;
+    ticks_t m_start;
+};
+
+#define PROFILE_SCOPE(name) ProfileScope profileScope(name)
+
+#endif
@@ -22,6 +22,7 @@
 
 #include "resourcemanager.h"
 #include "filestream.h"
+#include "mappedfile.h"
 
 #include <framework/core/application.h>
 #include <framework/luaengine/luainterface.h>
@@ -249,6 +250,21 @@ FileStreamPtr ResourceManager::createFile(const std::string& fileName)
     return FileStreamPtr(new FileStream(fileName, file, true));
 }
 
+MappedFilePtr ResourceManager::mapFile(const std::string& fileName)
+{
+    std::string fullPath = resolvePath(fileName);
+
+    // files inside packages can't be mapped, only the ones lying on a native directory
+    const char *realDir = PHYSFS_getRealDir(fullPath.c_str());
+    if(!realDir)
+        stdext::throw_exception(stdext::format("unable to map file '%s': file not found", fullPath));
+
+    std::string realPath = std::string(realDir) + fullPath;
+    if(!g_platform.fileExists(realPath))
+        return nullptr;
+    return MappedFilePtr(new MappedFile(realPath));
+}
+
 bool ResourceManager::deleteFile(const std::string& fileName)
 {
     return PHYSFS_delete(resolvePath(fileName).c_str()) != 0;
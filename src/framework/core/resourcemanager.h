@@ -58,6 +58,8 @@ public:
     FileStreamPtr appendFile(const std::string& fileName);
     FileStreamPtr createFile(const std::string& fileName);
     bool deleteFile(const std::string& fileName);
+    // @dontbind
+    MappedFilePtr mapFile(const std::string& fileName);
 
     bool makeDir(const std::string directory);
     std::list<std::string> listDirectoryFiles(const std::string& directoryPath = "");
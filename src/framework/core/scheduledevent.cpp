@@ -22,6 +22,30 @@
 
 #include "scheduledevent.h"
 
+static stdext::block_pool<sizeof(ScheduledEvent)>& scheduledEventPool()
+{
+    // never destroyed, events may still be released during static destruction
+    static auto *pool = new stdext::block_pool<sizeof(ScheduledEvent)>(false);
+    return *pool;
+}
+
+void *ScheduledEvent::operator new(size_t size)
+{
+    if(size != sizeof(ScheduledEvent))
+        return ::operator new(size);
+    return scheduledEventPool().allocate();
+}
+
+void ScheduledEvent::operator delete(void *p, size_t size)
+{
+    if(!p)
+        return;
+    if(size != sizeof(ScheduledEvent))
+        ::operator delete(p);
+    else
+        scheduledEventPool().deallocate(p);
+}
+
 ScheduledEvent::ScheduledEvent(const std::function<void()>& callback, int delay, int maxCycles) : Event(callback)
 {
     m_ticks = g_clock.millis() + delay;
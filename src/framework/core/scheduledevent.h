@@ -31,10 +31,14 @@ class ScheduledEvent : public Event
 {
 public:
     ScheduledEvent(const std::function<void()>& callback, int delay, int maxCycles);
+
+    static void *operator new(size_t size);
+    static void operator delete(void *p, size_t size);
+
     void execute();
     bool nextCycle();
 
-    int ticks() { return m_ticks; }
+    ticks_t ticks() { return m_ticks; }
     int remainingTicks() { return m_ticks - g_clock.millis(); }
     int delay() { return m_delay; }
     int cyclesExecuted() { return m_cyclesExecuted; }
@@ -0,0 +1,162 @@
+/*
+ * Copyright (c) 2010-2013 OTClient <https://github.com/edubart/otclient>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "timerwheel.h"
+
+TimerWheel::TimerWheel()
+{
+    for(int level = 0; level < LEVELS; ++level)
+        m_levelSizes[level] = 0;
+    m_size = 0;
+    m_time = -1;
+}
+
+void TimerWheel::add(const ScheduledEventPtr& event)
+{
+    // the wheel starts turning with the first event
+    if(m_time == -1)
+        m_time = g_clock.millis();
+
+    m_size++;
+    insert(event);
+}
+
+void TimerWheel::advance(ticks_t now, std::vector<ScheduledEventPtr>& dueEvents)
+{
+    if(m_time == -1)
+        m_time = now;
+
+    // events added with an already passed time come first
+    if(!m_expired.empty()) {
+        std::stable_sort(m_expired.begin(), m_expired.end(), [](const ScheduledEventPtr& a, const ScheduledEventPtr& b) {
+            return a->ticks() < b->ticks();
+        });
+        for(ScheduledEventPtr& event : m_expired)
+            dueEvents.push_back(std::move(event));
+        m_size -= m_expired.size();
+        m_expired.clear();
+    }
+
+    while(m_time < now) {
+        if(m_size == 0) {
+            m_time = now;
+            break;
+        }
+
+        // nothing in the lowest levels, skip to the end of their turn
+        int emptyLevels = 0;
+        while(emptyLevels < LEVELS && m_levelSizes[emptyLevels] == 0)
+            emptyLevels++;
+        if(emptyLevels > 0) {
+            ticks_t turnEnd = m_time | ((ticks_t(1) << (SLOT_BITS * emptyLevels)) - 1);
+            if(turnEnd >= now) {
+                m_time = now;
+                break;
+            }
+            m_time = turnEnd;
+        }
+
+        m_time++;
+
+        // when a level completes a turn, the current slot of the level above is spread into the levels below
+        if((m_time & SLOT_MASK) == 0) {
+            int topLevel = 1;
+            while(topLevel < LEVELS && (m_time & ((ticks_t(1) << (SLOT_BITS * (topLevel + 1))) - 1)) == 0)
+                topLevel++;
+
+            if(topLevel == LEVELS)
+                cascade(m_overflow);
+
+            for(int level = std::min<int>(topLevel, LEVELS - 1); level >= 1; --level) {
+                std::vector<ScheduledEventPtr>& slot = m_slots[level][(m_time >> (SLOT_BITS * level)) & SLOT_MASK];
+                m_levelSizes[level] -= slot.size();
+                cascade(slot);
+            }
+        }
+
+        std::vector<ScheduledEventPtr>& slot = m_slots[0][m_time & SLOT_MASK];
+        if(!slot.empty()) {
+            for(ScheduledEventPtr& event : slot)
+                dueEvents.push_back(std::move(event));
+            m_levelSizes[0] -= slot.size();
+            m_size -= slot.size();
+            slot.clear();
+        }
+    }
+}
+
+void TimerWheel::takeAll(std::vector<ScheduledEventPtr>& events)
+{
+    auto take = [&](std::vector<ScheduledEventPtr>& list) {
+        for(ScheduledEventPtr& event : list)
+            events.push_back(std::move(event));
+        list.clear();
+    };
+
+    for(int level = 0; level < LEVELS; ++level) {
+        for(int slot = 0; slot < SLOTS; ++slot)
+            take(m_slots[level][slot]);
+        m_levelSizes[level] = 0;
+    }
+    take(m_overflow);
+    take(m_expired);
+    m_size = 0;
+}
+
+void TimerWheel::insert(ScheduledEventPtr event)
+{
+    ticks_t ticks = event->ticks();
+    if(ticks <= m_time) {
+        m_expired.push_back(std::move(event));
+        return;
+    }
+
+    // the lowest level where the event time only differs from the wheel time in the level bits
+    for(int level = 0; level < LEVELS; ++level) {
+        int shift = SLOT_BITS * (level + 1);
+        if((ticks >> shift) == (m_time >> shift)) {
+            m_slots[level][(ticks >> (SLOT_BITS * level)) & SLOT_MASK].push_back(std::move(event));
+            m_levelSizes[level]++;
+            return;
+        }
+    }
+
+    m_overflow.push_back(std::move(event));
+}
+
+void TimerWheel::cascade(std::vector<ScheduledEventPtr>& slot)
+{
+    if(slot.empty())
+        return;
+
+    // swapping keeps the capacity of both vectors around for the next turns
+    m_cascading.swap(slot);
+    for(ScheduledEventPtr& event : m_cascading) {
+        // events due right now go to the lowest level slot that is about to be run
+        if(event->ticks() == m_time) {
+            m_slots[0][m_time & SLOT_MASK].push_back(std::move(event));
+            m_levelSizes[0]++;
+        } else
+            insert(std::move(event));
+    }
+    m_cascading.clear();
+}
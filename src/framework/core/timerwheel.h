@@ -0,0 +1,64 @@
+/*
+ * Copyright (c) 2010-2013 OTClient <https://github.com/edubart/otclient>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef TIMERWHEEL_H
+#define TIMERWHEEL_H
+
+#include "scheduledevent.h"
+
+// Hierarchical timing wheel, each level covers 64 times the range of the level below it.
+// Adding an event is constant time, events move down one level at a time as their time gets near.
+class TimerWheel
+{
+    enum {
+        LEVELS = 5,
+        SLOT_BITS = 6,
+        SLOTS = 1 << SLOT_BITS,
+        SLOT_MASK = SLOTS - 1
+    };
+
+public:
+    TimerWheel();
+
+    void add(const ScheduledEventPtr& event);
+    // moves the events due up to the given time into the list, sorted by their ticks
+    void advance(ticks_t now, std::vector<ScheduledEventPtr>& dueEvents);
+    // moves every event into the list, in no particular order
+    void takeAll(std::vector<ScheduledEventPtr>& events);
+
+    std::size_t size() { return m_size; }
+    bool empty() { return m_size == 0; }
+
+private:
+    void insert(ScheduledEventPtr event);
+    void cascade(std::vector<ScheduledEventPtr>& slot);
+
+    std::vector<ScheduledEventPtr> m_slots[LEVELS][SLOTS];
+    std::size_t m_levelSizes[LEVELS];
+    std::vector<ScheduledEventPtr> m_overflow;
+    std::vector<ScheduledEventPtr> m_expired;
+    std::vector<ScheduledEventPtr> m_cascading;
+    std::size_t m_size;
+    ticks_t m_time;
+};
+
+#endif
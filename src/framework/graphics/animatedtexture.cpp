@@ -46,6 +46,14 @@ AnimatedTexture::~AnimatedTexture()
 
 }
 
+int AnimatedTexture::getMemoryUsage()
+{
+    int bytes = 0;
+    for(const TexturePtr& frame : m_frames)
+        bytes += frame->getMemoryUsage();
+    return bytes;
+}
+
 bool AnimatedTexture::buildHardwareMipmaps()
 {
     if(!g_graphics.canUseHardwareMipmaps())
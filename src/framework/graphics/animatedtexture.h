@@ -33,6 +33,7 @@ public:
     virtual ~AnimatedTexture();
 
     virtual bool buildHardwareMipmaps();
+    virtual int getMemoryUsage();
 
     virtual void setSmooth(bool smooth);
     virtual void setRepeat(bool repeat);
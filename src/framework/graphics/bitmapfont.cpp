@@ -27,6 +27,50 @@
 
 #include <framework/otml/otml.h>
 
+namespace {
+
+// measures text width the same way calculateGlyphsPositions does, but can be fed piece by piece
+class TextMeasure
+{
+public:
+    TextMeasure(const Size *glyphsSize, int spacing) :
+        m_glyphsSize(glyphsSize), m_spacing(spacing), m_maxWidth(0), m_lineWidth(0), m_lines(0), m_pendingSpacing(false) { }
+
+    void add(uchar glyph) {
+        // spacing goes after every glyph that is not the last one or before a \n
+        if(m_pendingSpacing && glyph != (uchar)'\n')
+            m_lineWidth += m_spacing;
+        m_pendingSpacing = false;
+
+        if(glyph == (uchar)'\n') {
+            m_maxWidth = std::max(m_maxWidth, m_lineWidth);
+            m_lineWidth = 0;
+            m_lines++;
+        } else if(glyph >= 32) {
+            m_lineWidth += m_glyphsSize[glyph].width();
+            m_pendingSpacing = true;
+        }
+    }
+
+    void add(const char *text, int length) {
+        for(int i = 0; i < length; ++i)
+            add((uchar)text[i]);
+    }
+
+    int width() const { return std::max(m_maxWidth, m_lineWidth); }
+    int lines() const { return m_lines; }
+
+private:
+    const Size *m_glyphsSize;
+    int m_spacing;
+    int m_maxWidth;
+    int m_lineWidth;
+    int m_lines;
+    bool m_pendingSpacing;
+};
+
+}
+
 void BitmapFont::load(const OTMLNodePtr& fontNode)
 {
     OTMLNodePtr textureNode = fontNode->at("texture");
@@ -99,6 +143,27 @@ void BitmapFont::calculateDrawTextCoords(CoordsBuffer& coordsBuffer, const std::
     if(!screenCoords.isValid() || !m_texture)
         return;
 
+    const TextLayout& layout = getTextLayout(text, align);
+    if(layout.vertices.size() == 0)
+        return;
+
+    Point alignOffset;
+    if(align & Fw::AlignBottom)
+        alignOffset.y = screenCoords.height() - layout.textBoxSize.height();
+    else if(align & Fw::AlignVerticalCenter)
+        alignOffset.y = (screenCoords.height() - layout.textBoxSize.height()) / 2;
+    if(align & Fw::AlignRight)
+        alignOffset.x = screenCoords.width() - layout.textBoxSize.width();
+    else if(align & Fw::AlignHorizontalCenter)
+        alignOffset.x = (screenCoords.width() - layout.textBoxSize.width()) / 2;
+
+    // the whole text fits, no glyph needs clipping so the cached quads are copied at once
+    Rect bounds = layout.bounds.translated(alignOffset);
+    if(layout.exact && bounds.left() >= 0 && bounds.top() >= 0 && bounds.right() < screenCoords.width() && bounds.bottom() < screenCoords.height()) {
+        coordsBuffer.append(layout.vertices, layout.textureCoords, screenCoords.topLeft() + alignOffset);
+        return;
+    }
+
     int textLenght = text.length();
 
     // map glyphs positions
@@ -255,9 +320,86 @@ const std::vector<Point>& BitmapFont::calculateGlyphsPositions(const std::string
 
 Size BitmapFont::calculateTextRectSize(const std::string& text)
 {
-    Size size;
-    calculateGlyphsPositions(text, Fw::AlignTopLeft, &size);
-    return size;
+    if(text.empty())
+        return Size(0, m_glyphHeight);
+
+    TextMeasure measure(m_glyphsSize, m_glyphSpacing.width());
+    measure.add(text.c_str(), text.length());
+    return Size(measure.width(), m_yOffset + measure.lines() * (m_glyphHeight + m_glyphSpacing.height()) + m_glyphHeight);
+}
+
+const BitmapFont::TextLayout& BitmapFont::getTextLayout(const std::string& text, Fw::AlignmentFlag align)
+{
+    size_t hash = std::hash<std::string>()(text) * 31 + align;
+
+    auto it = m_textLayouts.find(hash);
+    if(it != m_textLayouts.end() && it->second->align == align && it->second->text == text) {
+        it->second->lastUse = ++m_textLayoutUses;
+        return *it->second;
+    }
+
+    if(it == m_textLayouts.end() && m_textLayouts.size() >= MAX_TEXT_LAYOUTS)
+        evictTextLayouts();
+
+    // hash collisions just replace the older layout
+    std::unique_ptr<TextLayout>& layout = m_textLayouts[hash];
+    if(!layout)
+        layout.reset(new TextLayout);
+    layout->text = text;
+    layout->align = align;
+    layout->exact = true;
+    layout->lastUse = ++m_textLayoutUses;
+    layout->vertices.clear();
+    layout->textureCoords.clear();
+
+    const std::vector<Point>& glyphsPositions = calculateGlyphsPositions(text, align, &layout->textBoxSize);
+
+    int left = 0, top = 0, right = -1, bottom = -1;
+    for(int i = 0; i < (int)text.length(); ++i) {
+        int glyph = (uchar)text[i];
+        if(glyph < 32)
+            continue;
+
+        Rect glyphScreenCoords(glyphsPositions[i], m_glyphsSize[glyph]);
+        if(!glyphScreenCoords.isValid())
+            layout->exact = false;
+
+        if(layout->vertices.size() == 0) {
+            left = glyphScreenCoords.left();
+            top = glyphScreenCoords.top();
+            right = glyphScreenCoords.right();
+            bottom = glyphScreenCoords.bottom();
+        } else {
+            left = std::min(left, glyphScreenCoords.left());
+            top = std::min(top, glyphScreenCoords.top());
+            right = std::max(right, glyphScreenCoords.right());
+            bottom = std::max(bottom, glyphScreenCoords.bottom());
+        }
+
+        layout->vertices.addRect(glyphScreenCoords);
+        layout->textureCoords.addRect(m_glyphsTextureCoords[glyph]);
+    }
+    layout->bounds = Rect(Point(left, top), Point(right, bottom));
+
+    return *layout;
+}
+
+void BitmapFont::evictTextLayouts()
+{
+    // drop the least recently used half
+    std::vector<uint> uses;
+    uses.reserve(m_textLayouts.size());
+    for(const auto& it : m_textLayouts)
+        uses.push_back(it.second->lastUse);
+    std::nth_element(uses.begin(), uses.begin() + uses.size() / 2, uses.end());
+    uint median = uses[uses.size() / 2];
+
+    for(auto it = m_textLayouts.begin(); it != m_textLayouts.end();) {
+        if(it->second->lastUse < median)
+            it = m_textLayouts.erase(it);
+        else
+            ++it;
+    }
 }
 
 void BitmapFont::calculateGlyphsWidthsAutomatically(const ImagePtr& image, const Size& glyphSize)
@@ -293,52 +435,79 @@ void BitmapFont::calculateGlyphsWidthsAutomatically(const ImagePtr& image, const
 std::string BitmapFont::wrapText(const std::string& text, int maxWidth)
 {
     std::string outText;
-    std::string line;
-    std::vector<std::string> words;
-    std::vector<std::string> wordsSplit = stdext::split(text);
-
-    // break huge words into small ones
-    for(uint i=0;i<wordsSplit.size();++i) {
-        const std::string& word = wordsSplit[i];
-        int wordWidth = calculateTextRectSize(word).width();
-        if(wordWidth > maxWidth) {
-            std::string newWord;
-            for(uint j=0;j<word.length();++j) {
-                std::string candidate = newWord + word[j];
-                if(j != word.length() - 1)
-                    candidate += "-";
-                int candidateWidth = calculateTextRectSize(candidate).width();
-
-                if(candidateWidth > maxWidth) {
-                    newWord += "-";
-                    words.push_back(newWord);
-                    newWord = "";
+    outText.reserve(text.length() + text.length() / 8 + 1);
+
+    const int spacing = m_glyphSpacing.width();
+    TextMeasure line(m_glyphsSize, spacing);
+    bool lineEmpty = true;
+
+    // appends a word to the current line, breaking the line before it when it does not fit
+    auto addWord = [&](const char *word, int length, bool hyphen) {
+        TextMeasure candidate = line;
+        candidate.add(word, length);
+        if(hyphen)
+            candidate.add('-');
+
+        if(candidate.width() > maxWidth) {
+            // replace the trailing space of the line
+            if(!lineEmpty)
+                outText[outText.length() - 1] = '\n';
+            line = TextMeasure(m_glyphsSize, spacing);
+        }
+
+        outText.append(word, length);
+        line.add(word, length);
+        if(hyphen) {
+            outText += '-';
+            line.add('-');
+        }
+        outText += ' ';
+        line.add(' ');
+        lineEmpty = false;
+    };
+
+    const char *str = text.c_str();
+    int textLength = text.length();
+    int wordStart = 0;
+    while(wordStart <= textLength) {
+        int wordEnd = wordStart;
+        while(wordEnd < textLength && str[wordEnd] != ' ')
+            ++wordEnd;
+
+        const char *word = str + wordStart;
+        int wordLength = wordEnd - wordStart;
+
+        TextMeasure wordMeasure(m_glyphsSize, spacing);
+        wordMeasure.add(word, wordLength);
+
+        // break huge words into small ones
+        if(wordMeasure.width() > maxWidth) {
+            TextMeasure piece(m_glyphsSize, spacing);
+            int pieceStart = 0;
+            for(int j = 0; j < wordLength; ++j) {
+                TextMeasure candidate = piece;
+                candidate.add((uchar)word[j]);
+                if(j != wordLength - 1)
+                    candidate.add('-');
+
+                if(candidate.width() > maxWidth) {
+                    addWord(word + pieceStart, j - pieceStart, true);
+                    piece = TextMeasure(m_glyphsSize, spacing);
+                    pieceStart = j;
                 }
 
-                newWord += word[j];
+                piece.add((uchar)word[j]);
             }
-
-            words.push_back(newWord);
+            addWord(word + pieceStart, wordLength - pieceStart, false);
         } else
-            words.push_back(word);
-    }
-
-    // compose lines
-    for(uint i=0;i<words.size();++i) {
-        std::string candidate = line + words[i];
-        int candidateWidth = calculateTextRectSize(candidate).width();
-
-        if(candidateWidth > maxWidth) {
-            if(!line.empty())
-                outText += line.substr(0, line.length()-1) + "\n";
-            line = "";
-        }
+            addWord(word, wordLength, false);
 
-        line += words[i] + " ";
+        wordStart = wordEnd + 1;
     }
 
-    outText += line;
-    outText = outText.substr(0, outText.length()-1);
+    // remove the trailing space
+    if(!outText.empty())
+        outText.resize(outText.length() - 1);
 
     return outText;
 }
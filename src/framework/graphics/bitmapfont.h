@@ -31,8 +31,24 @@
 
 class BitmapFont : public stdext::shared_object
 {
+    enum {
+        MAX_TEXT_LAYOUTS = 1024
+    };
+
+    /// Glyph quads of a text relative to its text box, reused while the text is drawn at other places
+    struct TextLayout {
+        std::string text;
+        Fw::AlignmentFlag align;
+        Size textBoxSize;
+        Rect bounds;
+        bool exact;
+        uint lastUse;
+        VertexArray vertices;
+        VertexArray textureCoords;
+    };
+
 public:
-    BitmapFont(const std::string& name) : m_name(name) { }
+    BitmapFont(const std::string& name) : m_name(name), m_textLayoutUses(0) { }
 
     /// Load font from otml node
     void load(const OTMLNodePtr& fontNode);
@@ -67,6 +83,9 @@ private:
     /// Calculates each font character by inspecting font bitmap
     void calculateGlyphsWidthsAutomatically(const ImagePtr& image, const Size& glyphSize);
 
+    const TextLayout& getTextLayout(const std::string& text, Fw::AlignmentFlag align);
+    void evictTextLayouts();
+
     std::string m_name;
     int m_glyphHeight;
     int m_firstGlyph;
@@ -75,6 +94,8 @@ private:
     TexturePtr m_texture;
     Rect m_glyphsTextureCoords[256];
     Size m_glyphsSize[256];
+    std::unordered_map<size_t, std::unique_ptr<TextLayout>> m_textLayouts;
+    uint m_textLayoutUses;
 };
 
 
@@ -65,6 +65,15 @@ public:
         m_hardwareCached = false;
     }
 
+    void append(const VertexArray& vertices, const VertexArray& textureCoords, const Point& offset) {
+        m_vertexArray.append(vertices, offset.x, offset.y);
+        m_textureCoordArray.append(textureCoords);
+        m_hardwareCached = false;
+    }
+    void append(const CoordsBuffer& other) {
+        append(other.m_vertexArray, other.m_textureCoordArray, Point(0, 0));
+    }
+
     void addBoudingRect(const Rect& dest, int innerLineWidth);
     void addRepeatedRects(const Rect& dest, const Rect& src);
 
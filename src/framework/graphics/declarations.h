@@ -28,6 +28,8 @@
 
 class Texture;
 class TextureManager;
+class TextureAtlas;
+class AtlasRegion;
 class Image;
 class AnimatedTexture;
 class BitmapFont;
@@ -37,7 +39,7 @@ class FrameBufferManager;
 class Shader;
 class ShaderProgram;
 class PainterShaderProgram;
-class Particle;
+class ParticlePool;
 class ParticleType;
 class ParticleEmitter;
 class ParticleAffector;
@@ -47,6 +49,7 @@ class ParticleEffectType;
 
 typedef stdext::shared_object_ptr<Image> ImagePtr;
 typedef stdext::shared_object_ptr<Texture> TexturePtr;
+typedef stdext::shared_object_ptr<AtlasRegion> AtlasRegionPtr;
 typedef stdext::shared_object_ptr<AnimatedTexture> AnimatedTexturePtr;
 typedef stdext::shared_object_ptr<BitmapFont> BitmapFontPtr;
 typedef stdext::shared_object_ptr<CachedText> CachedTextPtr;
@@ -54,7 +57,6 @@ typedef stdext::shared_object_ptr<FrameBuffer> FrameBufferPtr;
 typedef stdext::shared_object_ptr<Shader> ShaderPtr;
 typedef stdext::shared_object_ptr<ShaderProgram> ShaderProgramPtr;
 typedef stdext::shared_object_ptr<PainterShaderProgram> PainterShaderProgramPtr;
-typedef stdext::shared_object_ptr<Particle> ParticlePtr;
 typedef stdext::shared_object_ptr<ParticleType> ParticleTypePtr;
 typedef stdext::shared_object_ptr<ParticleEmitter> ParticleEmitterPtr;
 typedef stdext::shared_object_ptr<ParticleAffector> ParticleAffectorPtr;
@@ -112,6 +112,9 @@ void FrameBuffer::draw(const Rect& dest)
 
 void FrameBuffer::internalBind()
 {
+    // pending batched draws belong to the previous render target
+    g_painter->flush();
+
     if(m_fbo) {
         assert(boundFbo != m_fbo);
         glBindFramebuffer(GL_FRAMEBUFFER, m_fbo);
@@ -125,6 +128,8 @@ void FrameBuffer::internalBind()
 
 void FrameBuffer::internalRelease()
 {
+    g_painter->flush();
+
     if(m_fbo) {
         assert(boundFbo == m_fbo);
         glBindFramebuffer(GL_FRAMEBUFFER, m_prevBoundFbo);
@@ -140,6 +145,7 @@ void FrameBuffer::internalRelease()
             glDisable(GL_BLEND);
             g_painter->setColor(Color::white);
             g_painter->drawTexturedRect(screenRect, m_screenBackup, screenRect);
+            g_painter->flush();
             glEnable(GL_BLEND);
         }
     }
@@ -38,6 +38,7 @@
 #include <framework/graphics/graphics.h>
 #include <framework/graphics/texture.h>
 #include "texturemanager.h"
+#include "textureatlas.h"
 #include "framebuffermanager.h"
 #include <framework/platform/platformwindow.h>
 
@@ -106,6 +107,7 @@ void Graphics::init()
     selectPainterEngine(m_prefferedPainterEngine);
 
     g_textures.init();
+    g_atlas.init();
     g_framebuffers.init();
 }
 
@@ -113,6 +115,7 @@ void Graphics::terminate()
 {
     g_fonts.terminate();
     g_framebuffers.terminate();
+    g_atlas.terminate();
     g_textures.terminate();
 
 #ifdef PAINTER_OGL2
@@ -264,6 +267,32 @@ void Graphics::resize(const Size& size)
 #endif
 }
 
+void Graphics::setPainterBatching(bool enable)
+{
+    if(g_painter)
+        g_painter->setBatching(enable);
+}
+
+bool Graphics::isPainterBatching()
+{
+    return g_painter && g_painter->isBatching();
+}
+
+int Graphics::getDrawCalls()
+{
+    return g_painter ? g_painter->getDrawCalls() : 0;
+}
+
+int Graphics::getDrawBatches()
+{
+    return g_painter ? g_painter->getDrawBatches() : 0;
+}
+
+int Graphics::getDrawQuads()
+{
+    return g_painter ? g_painter->getDrawQuads() : 0;
+}
+
 bool Graphics::canUseDrawArrays()
 {
 #ifdef OPENGL_ES
@@ -62,6 +62,12 @@ public:
 
     void setShouldUseShaders(bool enable) { m_shouldUseShaders = enable; }
 
+    void setPainterBatching(bool enable);
+    bool isPainterBatching();
+    int getDrawCalls();
+    int getDrawBatches();
+    int getDrawQuads();
+
     bool ok() { return m_ok; }
     bool canUseDrawArrays();
     bool canUseShaders();
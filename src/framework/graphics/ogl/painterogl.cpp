@@ -22,6 +22,7 @@
 
 #include "painterogl.h"
 #include <framework/graphics/graphics.h>
+#include <framework/graphics/texturemanager.h>
 #include <framework/platform/platformwindow.h>
 
 PainterOGL::PainterOGL()
@@ -35,6 +36,7 @@ PainterOGL::PainterOGL()
     m_shaderProgram = nullptr;
     m_texture = nullptr;
     m_alphaWriting = false;
+    m_batchQuads = 0;
     setResolution(g_window.getSize());
 }
 
@@ -61,6 +63,22 @@ void PainterOGL::refreshState()
     updateGlAlphaWriting();
 }
 
+void PainterOGL::setColor(const Color& color)
+{
+    if(m_color == color)
+        return;
+    flush();
+    m_color = color;
+}
+
+void PainterOGL::setOpacity(float opacity)
+{
+    if(m_opacity == opacity)
+        return;
+    flush();
+    m_opacity = opacity;
+}
+
 void PainterOGL::saveState()
 {
     assert(m_oldStateIndex<10);
@@ -104,12 +122,14 @@ void PainterOGL::restoreSavedState()
 
 void PainterOGL::clear(const Color& color)
 {
+    flush();
     glClearColor(color.rF(), color.gF(), color.bF(), color.aF());
     glClear(GL_COLOR_BUFFER_BIT);
 }
 
 void PainterOGL::clearRect(const Color& color, const Rect& rect)
 {
+    flush();
     Rect oldClipRect = m_clipRect;
     setClipRect(rect);
     glClearColor(color.rF(), color.gF(), color.bF(), color.aF());
@@ -117,10 +137,36 @@ void PainterOGL::clearRect(const Color& color, const Rect& rect)
     setClipRect(oldClipRect);
 }
 
+void PainterOGL::flush()
+{
+    if(m_batchQuads == 0)
+        return;
+
+    // reset the counter first, drawCoords flushes before drawing
+    m_batchQuads = 0;
+    drawCoords(m_batchCoordsBuffer, Triangles);
+    m_batchCoordsBuffer.clear();
+    m_batchTexture = nullptr;
+    m_drawBatches++;
+}
+
+void PainterOGL::addBatchedQuad(const Rect& dest, const TexturePtr& texture, const Rect& src)
+{
+    // every state change flushes, so the pending quads always share the current state
+    if(m_batchQuads >= MAX_BATCH_QUADS)
+        flush();
+
+    m_batchTexture = texture;
+    m_batchCoordsBuffer.addRect(dest, src);
+    m_batchQuads++;
+    m_drawQuads++;
+}
+
 void PainterOGL::setCompositionMode(Painter::CompositionMode compositionMode)
 {
     if(m_compositionMode == compositionMode)
         return;
+    flush();
     m_compositionMode = compositionMode;
     updateGlCompositionMode();
 }
@@ -129,6 +175,7 @@ void PainterOGL::setBlendEquation(Painter::BlendEquation blendEquation)
 {
     if(m_blendEquation == blendEquation)
         return;
+    flush();
     m_blendEquation = blendEquation;
     updateGlBlendEquation();
 }
@@ -137,14 +184,36 @@ void PainterOGL::setClipRect(const Rect& clipRect)
 {
     if(m_clipRect == clipRect)
         return;
+    flush();
     m_clipRect = clipRect;
     updateGlClipRect();
 }
 
+void PainterOGL::setShaderProgram(PainterShaderProgram *shaderProgram)
+{
+    if(m_shaderProgram == shaderProgram)
+        return;
+    flush();
+    m_shaderProgram = shaderProgram;
+}
+
 void PainterOGL::setTexture(Texture* texture)
 {
+    if(texture) {
+        texture->touch();
+
+        // atlas pages get new images between draws, their mipmaps must follow before drawing again
+        if(texture->hasOutdatedMipmaps())
+            texture->buildHardwareMipmaps();
+    }
+
     if(m_texture == texture)
         return;
+    flush();
+
+    // textures evicted to save video memory are uploaded again when drawn
+    if(texture && texture->isEvicted())
+        g_textures.reloadTexture(texture);
 
     m_texture = texture;
 
@@ -165,6 +234,7 @@ void PainterOGL::setAlphaWriting(bool enable)
 {
     if(m_alphaWriting == enable)
         return;
+    flush();
 
     m_alphaWriting = enable;
     updateGlAlphaWriting();
@@ -189,6 +259,7 @@ void PainterOGL::setResolution(const Size& resolution)
                                  0.0f,                    -2.0f/resolution.height(),  0.0f,
                                 -1.0f,                     1.0f,                      1.0f };
 
+    flush();
     m_resolution = resolution;
 
     setProjectionMatrix(projectionMatrix);
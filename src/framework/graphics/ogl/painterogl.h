@@ -43,6 +43,10 @@ public:
         bool alphaWriting;
     };
 
+    enum {
+        MAX_BATCH_QUADS = 4096
+    };
+
     PainterOGL();
     virtual ~PainterOGL() { }
 
@@ -58,15 +62,19 @@ public:
     void clear(const Color& color);
     void clearRect(const Color& color, const Rect& rect);
 
-    virtual void setTransformMatrix(const Matrix3& transformMatrix) { m_transformMatrix = transformMatrix; }
-    virtual void setProjectionMatrix(const Matrix3& projectionMatrix) { m_projectionMatrix = projectionMatrix; }
-    virtual void setTextureMatrix(const Matrix3& textureMatrix) { m_textureMatrix = textureMatrix; }
+    void flush();
+
+    virtual void setTransformMatrix(const Matrix3& transformMatrix) { flush(); m_transformMatrix = transformMatrix; }
+    virtual void setProjectionMatrix(const Matrix3& projectionMatrix) { flush(); m_projectionMatrix = projectionMatrix; }
+    virtual void setTextureMatrix(const Matrix3& textureMatrix) { flush(); m_textureMatrix = textureMatrix; }
     virtual void setCompositionMode(CompositionMode compositionMode);
     virtual void setBlendEquation(BlendEquation blendEquation);
     virtual void setClipRect(const Rect& clipRect);
-    virtual void setShaderProgram(PainterShaderProgram *shaderProgram) { m_shaderProgram = shaderProgram; }
+    virtual void setShaderProgram(PainterShaderProgram *shaderProgram);
     virtual void setTexture(Texture *texture);
     virtual void setAlphaWriting(bool enable);
+    virtual void setColor(const Color& color);
+    virtual void setOpacity(float opacity);
 
     void setTexture(const TexturePtr& texture) { setTexture(texture.get()); }
     void setResolution(const Size& resolution);
@@ -92,6 +100,8 @@ public:
     void resetTransformMatrix() { setTransformMatrix(Matrix3()); }
 
 protected:
+    void addBatchedQuad(const Rect& dest, const TexturePtr& texture, const Rect& src);
+
     void updateGlTexture();
     void updateGlCompositionMode();
     void updateGlBlendEquation();
@@ -101,6 +111,11 @@ protected:
 
     CoordsBuffer m_coordsBuffer;
 
+    // textured quads drawn with the current state, not yet sent to GL
+    CoordsBuffer m_batchCoordsBuffer;
+    TexturePtr m_batchTexture;
+    int m_batchQuads;
+
     std::vector<Matrix3> m_transformMatrixStack;
     Matrix3 m_transformMatrix;
     Matrix3 m_projectionMatrix;
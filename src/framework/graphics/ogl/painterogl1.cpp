@@ -56,12 +56,15 @@ void PainterOGL1::bind()
 
 void PainterOGL1::unbind()
 {
+    flush();
     if(g_graphics.canUseDrawArrays())
         glDisableClientState(GL_VERTEX_ARRAY);
 }
 
 void PainterOGL1::drawCoords(CoordsBuffer& coordsBuffer, DrawMode drawMode)
 {
+    flush();
+
     int vertexCount = coordsBuffer.getVertexCount();
     if(vertexCount == 0)
         return;
@@ -72,6 +75,8 @@ void PainterOGL1::drawCoords(CoordsBuffer& coordsBuffer, DrawMode drawMode)
     if(textured && m_texture->isEmpty())
         return;
 
+    m_drawCalls++;
+
     if(textured != m_textureEnabled) {
         m_textureEnabled = textured;
         updateGlTextureState();
@@ -144,6 +149,12 @@ void PainterOGL1::drawTextureCoords(CoordsBuffer& coordsBuffer, const TexturePtr
     drawCoords(coordsBuffer);
 }
 
+void PainterOGL1::drawFilledCoords(CoordsBuffer& coordsBuffer)
+{
+    setTexture(nullptr);
+    drawCoords(coordsBuffer);
+}
+
 void PainterOGL1::drawTexturedRect(const Rect& dest, const TexturePtr& texture, const Rect& src)
 {
     if(dest.isEmpty() || src.isEmpty() || texture->isEmpty())
@@ -151,6 +162,11 @@ void PainterOGL1::drawTexturedRect(const Rect& dest, const TexturePtr& texture,
 
     setTexture(texture.get());
 
+    if(m_batching) {
+        addBatchedQuad(dest, texture, src);
+        return;
+    }
+
     m_coordsBuffer.clear();
     m_coordsBuffer.addQuad(dest, src);
     drawCoords(m_coordsBuffer, TriangleStrip);
@@ -226,6 +242,7 @@ void PainterOGL1::setMatrixMode(PainterOGL1::MatrixMode matrixMode)
 
 void PainterOGL1::setTransformMatrix(const Matrix3& transformMatrix)
 {
+    flush();
     m_transformMatrix = transformMatrix;
     if(g_painter == this)
         updateGlTransformMatrix();
@@ -233,6 +250,7 @@ void PainterOGL1::setTransformMatrix(const Matrix3& transformMatrix)
 
 void PainterOGL1::setProjectionMatrix(const Matrix3& projectionMatrix)
 {
+    flush();
     m_projectionMatrix = projectionMatrix;
     if(g_painter == this)
         updateGlProjectionMatrix();
@@ -243,6 +261,7 @@ void PainterOGL1::setTextureMatrix(const Matrix3& textureMatrix)
     // avoid re-updating texture matrix
     if(m_textureMatrix == textureMatrix)
         return;
+    flush();
     m_textureMatrix = textureMatrix;
     updateGlTextureMatrix();
 }
@@ -251,6 +270,7 @@ void PainterOGL1::setColor(const Color& color)
 {
     if(m_color == color)
         return;
+    flush();
     m_color = color;
     updateGlColor();
 }
@@ -259,6 +279,7 @@ void PainterOGL1::setOpacity(float opacity)
 {
     if(m_opacity == opacity)
         return;
+    flush();
     m_opacity = opacity;
     updateGlColor();
 }
@@ -51,6 +51,7 @@ public:
 
     void drawCoords(CoordsBuffer& coordsBuffer, DrawMode drawMode = Triangles);
     void drawTextureCoords(CoordsBuffer& coordsBuffer, const TexturePtr& texture);
+    void drawFilledCoords(CoordsBuffer& coordsBuffer);
     void drawTexturedRect(const Rect& dest, const TexturePtr& texture, const Rect& src);
     void drawUpsideDownTexturedRect(const Rect& dest, const TexturePtr& texture, const Rect& src);
     void drawRepeatedTexturedRect(const Rect& dest, const TexturePtr& texture, const Rect& src);
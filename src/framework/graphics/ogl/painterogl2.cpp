@@ -58,13 +58,24 @@ void PainterOGL2::bind()
 
 void PainterOGL2::unbind()
 {
+    flush();
     PainterShaderProgram::disableAttributeArray(PainterShaderProgram::VERTEX_ATTR);
     PainterShaderProgram::disableAttributeArray(PainterShaderProgram::TEXCOORD_ATTR);
     PainterShaderProgram::release();
 }
 
+void PainterOGL2::setDrawProgram(PainterShaderProgram *drawProgram)
+{
+    if(m_drawProgram == drawProgram)
+        return;
+    flush();
+    m_drawProgram = drawProgram;
+}
+
 void PainterOGL2::drawCoords(CoordsBuffer& coordsBuffer, DrawMode drawMode)
 {
+    flush();
+
     int vertexCount = coordsBuffer.getVertexCount();
     if(vertexCount == 0)
         return;
@@ -75,6 +86,8 @@ void PainterOGL2::drawCoords(CoordsBuffer& coordsBuffer, DrawMode drawMode)
     if(textured && m_texture->isEmpty())
         return;
 
+    m_drawCalls++;
+
     // update shader with the current painter state
     m_drawProgram->bind();
     m_drawProgram->setTransformMatrix(m_transformMatrix);
@@ -130,6 +143,12 @@ void PainterOGL2::drawTextureCoords(CoordsBuffer& coordsBuffer, const TexturePtr
     drawCoords(coordsBuffer);
 }
 
+void PainterOGL2::drawFilledCoords(CoordsBuffer& coordsBuffer)
+{
+    setDrawProgram(m_shaderProgram ? m_shaderProgram : m_drawSolidColorProgram.get());
+    drawCoords(coordsBuffer);
+}
+
 void PainterOGL2::drawTexturedRect(const Rect& dest, const TexturePtr& texture, const Rect& src)
 {
     if(dest.isEmpty() || src.isEmpty() || texture->isEmpty())
@@ -138,6 +157,11 @@ void PainterOGL2::drawTexturedRect(const Rect& dest, const TexturePtr& texture,
     setDrawProgram(m_shaderProgram ? m_shaderProgram : m_drawTexturedProgram.get());
     setTexture(texture);
 
+    if(m_batching) {
+        addBatchedQuad(dest, texture, src);
+        return;
+    }
+
     m_coordsBuffer.clear();
     m_coordsBuffer.addQuad(dest, src);
     drawCoords(m_coordsBuffer, TriangleStrip);
@@ -42,6 +42,7 @@ public:
 
     void drawCoords(CoordsBuffer& coordsBuffer, DrawMode drawMode = Triangles);
     void drawTextureCoords(CoordsBuffer& coordsBuffer, const TexturePtr& texture);
+    void drawFilledCoords(CoordsBuffer& coordsBuffer);
     void drawTexturedRect(const Rect& dest, const TexturePtr& texture, const Rect& src);
     void drawUpsideDownTexturedRect(const Rect& dest, const TexturePtr& texture, const Rect& src);
     void drawRepeatedTexturedRect(const Rect& dest, const TexturePtr& texture, const Rect& src);
@@ -49,7 +50,7 @@ public:
     void drawFilledTriangle(const Point& a, const Point& b, const Point& c);
     void drawBoundingRect(const Rect& dest, int innerLineWidth = 1);
 
-    void setDrawProgram(PainterShaderProgram *drawProgram) { m_drawProgram = drawProgram; }
+    void setDrawProgram(PainterShaderProgram *drawProgram);
 
     bool hasShaders() { return true; }
 
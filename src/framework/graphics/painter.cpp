@@ -29,5 +29,23 @@ Painter *g_painter = nullptr;
 
 Painter::Painter()
 {
+    m_batching = true;
+    m_drawCalls = 0;
+    m_drawBatches = 0;
+    m_drawQuads = 0;
+    m_lastDrawCalls = 0;
+    m_lastDrawBatches = 0;
+    m_lastDrawQuads = 0;
+}
+
+void Painter::endFrame()
+{
+    flush();
 
+    m_lastDrawCalls = m_drawCalls;
+    m_lastDrawBatches = m_drawBatches;
+    m_lastDrawQuads = m_drawQuads;
+    m_drawCalls = 0;
+    m_drawBatches = 0;
+    m_drawQuads = 0;
 }
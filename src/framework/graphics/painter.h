@@ -60,9 +60,14 @@ public:
     virtual void restoreSavedState() = 0;
 
     virtual void clear(const Color& color) = 0;
+    virtual void clearRect(const Color& color, const Rect& rect) = 0;
+
+    virtual void flush() { }
+    void endFrame();
 
     virtual void drawCoords(CoordsBuffer& coordsBuffer, DrawMode drawMode = Triangles) = 0;
     virtual void drawTextureCoords(CoordsBuffer& coordsBuffer, const TexturePtr& texture) = 0;
+    virtual void drawFilledCoords(CoordsBuffer& coordsBuffer) = 0;
     virtual void drawTexturedRect(const Rect& dest, const TexturePtr& texture, const Rect& src) = 0;
     void drawTexturedRect(const Rect& dest, const TexturePtr& texture) { drawTexturedRect(dest, texture, Rect(Point(0,0), texture->getSize())); }
     virtual void drawUpsideDownTexturedRect(const Rect& dest, const TexturePtr& texture, const Rect& src) = 0;
@@ -109,6 +114,13 @@ public:
 
     virtual bool hasShaders() = 0;
 
+    void setBatching(bool enable) { flush(); m_batching = enable; }
+    bool isBatching() { return m_batching; }
+
+    int getDrawCalls() { return m_lastDrawCalls; }
+    int getDrawBatches() { return m_lastDrawBatches; }
+    int getDrawQuads() { return m_lastDrawQuads; }
+
 protected:
     PainterShaderProgram *m_shaderProgram;
     CompositionMode m_compositionMode;
@@ -116,6 +128,15 @@ protected:
     Size m_resolution;
     float m_opacity;
     Rect m_clipRect;
+    bool m_batching;
+
+    // counters of the frame being drawn and of the last complete frame
+    int m_drawCalls;
+    int m_drawBatches;
+    int m_drawQuads;
+    int m_lastDrawCalls;
+    int m_lastDrawBatches;
+    int m_lastDrawQuads;
 };
 
 extern Painter *g_painter;
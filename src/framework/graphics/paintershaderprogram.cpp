@@ -157,6 +157,11 @@ void PainterShaderProgram::addMultiTexture(const std::string& file)
     if(!texture)
         return;
 
+    // bindMultiTextures binds them straight to their units, where the painter can't upload evicted pixels again
+    if(texture->isEvicted())
+        g_textures.reloadTexture(texture.get());
+    texture->setPinned(true);
+
     texture->setSmooth(true);
     texture->setRepeat(true);
 
@@ -21,96 +21,168 @@
  */
 
 #include "particle.h"
-#include "graphics.h"
-#include <framework/core/clock.h>
+#include "particletype.h"
+#include "painter.h"
+#include "texture.h"
 
-Particle::Particle(const Point& pos, const Size& startSize, const Size& finalSize, const PointF& velocity, const PointF& acceleration, float duration, float ignorePhysicsAfter, const std::vector<Color>& colors, const std::vector<float>& colorsStops, Painter::CompositionMode compositionMode, TexturePtr texture)
+void ParticlePool::add(const ParticleTypePtr& type, const PointF& position, const PointF& velocity, const PointF& acceleration, float duration)
 {
-    m_colors = colors;
-    m_colorsStops = colorsStops;
-
-    m_position = PointF(pos.x, pos.y);
-    m_startSize = startSize;
-    m_finalSize = finalSize;
-    m_velocity = velocity;
-    m_acceleration = acceleration;
-
-    m_compositionMode = compositionMode;
-    m_texture = texture;
-    m_duration = duration;
-    m_ignorePhysicsAfter = ignorePhysicsAfter;
-    m_elapsedTime = 0;
-    m_finished = false;
-}
-
-void Particle::render()
-{
-    g_painter->setColor(m_color);
-
-    if(!m_texture)
-        g_painter->drawFilledRect(m_rect);
-    else {
-        g_painter->setCompositionMode(m_compositionMode);
-        g_painter->drawTexturedRect(m_rect, m_texture);
+    uint typeIndex = std::find(m_types.begin(), m_types.end(), type) - m_types.begin();
+    if(typeIndex == m_types.size()) {
+        if(typeIndex > 255)
+            stdext::throw_exception("too many particle types in a single system");
+        m_types.push_back(type);
     }
+
+    // particles that ignore physics after some time are given a huge physics duration otherwise
+    float physicsDuration = type->getIgnorePhysicsAfter();
+    if(physicsDuration < 0)
+        physicsDuration = std::numeric_limits<float>::max();
+
+    m_positionX.push_back(position.x);
+    m_positionY.push_back(position.y);
+    m_velocityX.push_back(velocity.x);
+    m_velocityY.push_back(velocity.y);
+    m_accelerationX.push_back(acceleration.x);
+    m_accelerationY.push_back(acceleration.y);
+    m_age.push_back(0);
+    m_duration.push_back(duration);
+    m_physicsDuration.push_back(physicsDuration);
+    m_typeIndex.push_back(typeIndex);
 }
 
-void Particle::update(float elapsedTime)
+void ParticlePool::update(float elapsedTime)
 {
-    // check if finished
-    if(m_duration >= 0 && m_elapsedTime >= m_duration) {
-        m_finished = true;
-        return;
+    int count = size();
+    float *positionX = m_positionX.data();
+    float *positionY = m_positionY.data();
+    float *velocityX = m_velocityX.data();
+    float *velocityY = m_velocityY.data();
+    const float *accelerationX = m_accelerationX.data();
+    const float *accelerationY = m_accelerationY.data();
+    float *age = m_age.data();
+    const float *physicsDuration = m_physicsDuration.data();
+
+    // branchless loops, so the compiler can vectorize them
+    for(int i = 0; i < count; ++i) {
+        float step = age[i] < physicsDuration[i] ? elapsedTime : 0.0f;
+        positionX[i] += velocityX[i] * step;
+        // painter orientate Y axis in the inverse direction
+        positionY[i] -= velocityY[i] * step;
+        velocityX[i] += accelerationX[i] * step;
+        velocityY[i] += accelerationY[i] * step;
     }
 
-    updateColor();
-    updateSize();
-    updatePosition(elapsedTime);
+    for(int i = 0; i < count; ++i)
+        age[i] += elapsedTime;
 
-    m_elapsedTime += elapsedTime;
+    removeFinished();
 }
 
-void Particle::updatePosition(float elapsedTime)
+void ParticlePool::render()
 {
-    if(m_ignorePhysicsAfter < 0 || m_elapsedTime < m_ignorePhysicsAfter ) {
-        // update position
-        PointF delta = m_velocity * elapsedTime;
-        delta.y *= -1; // painter orientate Y axis in the inverse direction
-
-        PointF position = m_position + delta;
+    int count = size();
+    if(count == 0)
+        return;
 
-        if(m_position != position) {
-            m_position += delta;
+    // counting sort of the particles by type and color step, each group is a single draw
+    const int groups = m_types.size() * ParticleType::COLOR_STEPS;
+    m_groupStart.assign(groups + 1, 0);
+    m_particleGroups.resize(count);
+    m_sortedIndexes.resize(count);
+
+    for(int i = 0; i < count; ++i) {
+        const ParticleTypePtr& type = m_types[m_typeIndex[i]];
+        float life = m_duration[i] > 0 ? m_age[i] / m_duration[i] : 1.0f;
+        m_particleGroups[i] = m_typeIndex[i] * ParticleType::COLOR_STEPS + type->getColorStep(life);
+        m_groupStart[m_particleGroups[i] + 1]++;
+    }
+    for(int g = 0; g < groups; ++g)
+        m_groupStart[g + 1] += m_groupStart[g];
+    m_groupNext.assign(m_groupStart.begin(), m_groupStart.end() - 1);
+    for(int i = 0; i < count; ++i)
+        m_sortedIndexes[m_groupNext[m_particleGroups[i]]++] = i;
+
+    for(int g = 0; g < groups; ++g) {
+        int begin = m_groupStart[g];
+        int end = m_groupStart[g + 1];
+        if(begin == end)
+            continue;
+
+        const ParticleTypePtr& type = m_types[g / ParticleType::COLOR_STEPS];
+        const TexturePtr& texture = type->getTexture();
+
+        m_coordsBuffer.clear();
+        for(int k = begin; k < end; ++k) {
+            int i = m_sortedIndexes[k];
+            float life = m_duration[i] > 0 ? m_age[i] / m_duration[i] : 1.0f;
+            Size size = type->getSize(life);
+            Rect dest((int)m_positionX[i] - size.width() / 2, (int)m_positionY[i] - size.height() / 2, size);
+            if(texture)
+                m_coordsBuffer.addRect(dest, Rect(Point(0, 0), texture->getSize()));
+            else
+                m_coordsBuffer.addRect(dest);
         }
 
-        // update acceleration
-        m_velocity += m_acceleration * elapsedTime;
+        g_painter->setColor(type->getStepColor(g % ParticleType::COLOR_STEPS));
+        if(texture) {
+            g_painter->setCompositionMode(type->getCompositionMode());
+            g_painter->drawTextureCoords(m_coordsBuffer, texture);
+        } else
+            g_painter->drawFilledCoords(m_coordsBuffer);
     }
-
-    m_rect.move((int)m_position.x - m_size.width() / 2, (int)m_position.y - m_size.height() / 2);
 }
 
-void Particle::updateSize()
+void ParticlePool::clear()
 {
-    m_size = m_startSize + (m_finalSize - m_startSize) / m_duration * m_elapsedTime;
-    m_rect.resize(m_size);
+    m_positionX.clear();
+    m_positionY.clear();
+    m_velocityX.clear();
+    m_velocityY.clear();
+    m_accelerationX.clear();
+    m_accelerationY.clear();
+    m_age.clear();
+    m_duration.clear();
+    m_physicsDuration.clear();
+    m_typeIndex.clear();
+    m_types.clear();
 }
 
-void Particle::updateColor()
+void ParticlePool::removeFinished()
 {
-    float currentLife = m_elapsedTime / m_duration;
-    if(currentLife < m_colorsStops[1]) {
-        float range = m_colorsStops[1] - m_colorsStops[0];
-        float factor = (currentLife - m_colorsStops[0])/range;
-        m_color = m_colors[0] * (1.0f - factor) + m_colors[1] * factor;
-    } else {
-        if(m_colors.size() > 1) {
-            m_colors.erase(m_colors.begin());
-            m_colorsStops.erase(m_colorsStops.begin());
-        } else {
-            if(m_color != m_colors[0]) {
-                m_color = m_colors[0];
-            }
+    // compacts the arrays keeping the particles order, particles with negative duration never finish
+    int count = size();
+    int alive = 0;
+    for(int i = 0; i < count; ++i) {
+        if(m_duration[i] >= 0 && m_age[i] >= m_duration[i])
+            continue;
+
+        if(alive != i) {
+            m_positionX[alive] = m_positionX[i];
+            m_positionY[alive] = m_positionY[i];
+            m_velocityX[alive] = m_velocityX[i];
+            m_velocityY[alive] = m_velocityY[i];
+            m_accelerationX[alive] = m_accelerationX[i];
+            m_accelerationY[alive] = m_accelerationY[i];
+            m_age[alive] = m_age[i];
+            m_duration[alive] = m_duration[i];
+            m_physicsDuration[alive] = m_physicsDuration[i];
+            m_typeIndex[alive] = m_typeIndex[i];
         }
+        alive++;
     }
+
+    if(alive == count)
+        return;
+
+    m_positionX.resize(alive);
+    m_positionY.resize(alive);
+    m_velocityX.resize(alive);
+    m_velocityY.resize(alive);
+    m_accelerationX.resize(alive);
+    m_accelerationY.resize(alive);
+    m_age.resize(alive);
+    m_duration.resize(alive);
+    m_physicsDuration.resize(alive);
+    m_typeIndex.resize(alive);
 }
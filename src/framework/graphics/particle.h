@@ -24,42 +24,44 @@
 #define PARTICLE_H
 
 #include "declarations.h"
-#include "painter.h"
+#include "coordsbuffer.h"
 
-class Particle : public stdext::shared_object
+// Particles of a system kept as parallel arrays, so affectors and physics run over contiguous
+// memory, finished particles are compacted away and the storage is reused by the next ones
+class ParticlePool
 {
 public:
-    Particle(const Point& pos, const Size& startSize, const Size& finalSize, const PointF& velocity, const PointF& acceleration, float duration, float ignorePhysicsAfter, const std::vector<Color>& colors, const std::vector<float>& colorsStops, Painter::CompositionMode compositionMode = Painter::CompositionMode_Normal, TexturePtr texture = nullptr);
-
-    void render();
+    void add(const ParticleTypePtr& type, const PointF& position, const PointF& velocity, const PointF& acceleration, float duration);
     void update(float elapsedTime);
+    void render();
+    void clear();
 
-    bool hasFinished() { return m_finished; }
-
-    PointF getPosition() { return m_position; }
-    PointF getVelocity() { return m_velocity; }
+    int size() { return m_age.size(); }
+    bool isEmpty() { return m_age.empty(); }
 
-    void setPosition(const PointF& position) { m_position = position; }
-    void setVelocity(const PointF& velocity) { m_velocity = velocity; }
+    float *getPositionX() { return m_positionX.data(); }
+    float *getPositionY() { return m_positionY.data(); }
+    float *getVelocityX() { return m_velocityX.data(); }
+    float *getVelocityY() { return m_velocityY.data(); }
 
 private:
-    void updateColor();
-    void updatePosition(float elapsedTime);
-    void updateSize();
+    void removeFinished();
+
+    std::vector<float> m_positionX, m_positionY;
+    std::vector<float> m_velocityX, m_velocityY;
+    std::vector<float> m_accelerationX, m_accelerationY;
+    std::vector<float> m_age, m_duration, m_physicsDuration;
+    std::vector<uint8> m_typeIndex;
+
+    // particle types in use, colors, sizes and textures are shared by all particles of a type
+    std::vector<ParticleTypePtr> m_types;
 
-    Color m_color;
-    std::vector<Color> m_colors;
-    std::vector<float> m_colorsStops;
-    TexturePtr m_texture;
-    PointF m_position;
-    PointF m_velocity;
-    PointF m_acceleration;
-    Size m_size, m_startSize, m_finalSize;
-    Rect m_rect;
-    Painter::CompositionMode m_compositionMode;
-    float m_duration, m_ignorePhysicsAfter;
-    float m_elapsedTime;
-    bool m_finished;
+    // render scratch, particles are drawn grouped by type and color step
+    std::vector<int> m_groupStart;
+    std::vector<int> m_groupNext;
+    std::vector<int> m_particleGroups;
+    std::vector<int> m_sortedIndexes;
+    CoordsBuffer m_coordsBuffer;
 };
 
 #endif
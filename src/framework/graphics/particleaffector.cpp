@@ -87,14 +87,20 @@ void GravityAffector::load(const OTMLNodePtr& node)
     }
 }
 
-void GravityAffector::updateParticle(const ParticlePtr& particle, float elapsedTime)
+void GravityAffector::updateParticles(ParticlePool& particles, float elapsedTime)
 {
     if(!m_active)
         return;
 
-    PointF velocity = particle->getVelocity();
-    velocity += PointF(m_gravity * elapsedTime * std::cos(m_angle), m_gravity * elapsedTime * std::sin(m_angle));
-    particle->setVelocity(velocity);
+    float deltaX = m_gravity * elapsedTime * std::cos(m_angle);
+    float deltaY = m_gravity * elapsedTime * std::sin(m_angle);
+    int count = particles.size();
+    float *velocityX = particles.getVelocityX();
+    float *velocityY = particles.getVelocityY();
+    for(int i = 0; i < count; ++i) {
+        velocityX[i] += deltaX;
+        velocityY[i] += deltaY;
+    }
 }
 
 void AttractionAffector::load(const OTMLNodePtr& node)
@@ -117,20 +123,29 @@ void AttractionAffector::load(const OTMLNodePtr& node)
     }
 }
 
-void AttractionAffector::updateParticle(const ParticlePtr& particle, float elapsedTime)
+void AttractionAffector::updateParticles(ParticlePool& particles, float elapsedTime)
 {
     if(!m_active)
         return;
 
-    PointF pPosition = particle->getPosition();
-    PointF d = PointF(m_position.x - pPosition.x, pPosition.y - m_position.y);
-    if(d.length() == 0)
-        return;
-
-    PointF direction = PointF(1, 1);
+    float acceleration = m_acceleration * elapsedTime;
     if(m_repelish)
-        direction = PointF(-1, -1);
-
-    PointF pVelocity = particle->getVelocity() + (d / d.length() * m_acceleration * elapsedTime) * direction;
-    particle->setVelocity(pVelocity - pVelocity * m_reduction/100.0 * elapsedTime);
+        acceleration = -acceleration;
+    float keep = 1.0f - m_reduction/100.0f * elapsedTime;
+
+    int count = particles.size();
+    const float *positionX = particles.getPositionX();
+    const float *positionY = particles.getPositionY();
+    float *velocityX = particles.getVelocityX();
+    float *velocityY = particles.getVelocityY();
+    for(int i = 0; i < count; ++i) {
+        float dx = m_position.x - positionX[i];
+        float dy = positionY[i] - m_position.y;
+        float length = std::sqrt(dx * dx + dy * dy);
+        // particles right at the attraction point are left untouched
+        float factor = length > 0 ? acceleration / length : 0.0f;
+        float scale = length > 0 ? keep : 1.0f;
+        velocityX[i] = (velocityX[i] + dx * factor) * scale;
+        velocityY[i] = (velocityY[i] + dy * factor) * scale;
+    }
 }
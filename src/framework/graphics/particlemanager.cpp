@@ -22,6 +22,7 @@
 
 #include "particlemanager.h"
 #include <framework/core/resourcemanager.h>
+#include <framework/core/profiler.h>
 #include <framework/otml/otml.h>
 
 ParticleManager g_particles;
@@ -73,6 +74,8 @@ void ParticleManager::terminate()
 
 void ParticleManager::poll()
 {
+    PROFILE_SCOPE("ParticleManager::poll");
+
     for(auto it = m_effects.begin(); it != m_effects.end();) {
         const ParticleEffectPtr& particleEffect = *it;
 
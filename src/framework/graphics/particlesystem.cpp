@@ -23,6 +23,7 @@
 #include "particle.h"
 #include "particlesystem.h"
 #include <framework/core/clock.h>
+#include <framework/core/profiler.h>
 
 ParticleSystem::ParticleSystem()
 {
@@ -54,15 +55,16 @@ void ParticleSystem::load(const OTMLNodePtr& node)
     }
 }
 
-void ParticleSystem::addParticle(const ParticlePtr& particle)
+void ParticleSystem::addParticle(const ParticleTypePtr& type, const PointF& position, const PointF& velocity, const PointF& acceleration, float duration)
 {
-    m_particles.push_back(particle);
+    m_particles.add(type, position, velocity, acceleration, duration);
 }
 
 void ParticleSystem::render()
 {
-    for(auto it = m_particles.begin(), end = m_particles.end(); it != end; ++it)
-        (*it)->render();
+    PROFILE_SCOPE("ParticleSystem::render");
+
+    m_particles.render();
     g_painter->resetCompositionMode();
 }
 
@@ -76,7 +78,7 @@ void ParticleSystem::update()
         return;
 
     // check if finished
-    if(m_particles.empty() && m_emitters.empty()) {
+    if(m_particles.isEmpty() && m_emitters.empty()) {
         m_finished = true;
         return;
     }
@@ -108,19 +110,11 @@ void ParticleSystem::update()
             }
         }
 
-        // update particles
-        for(auto it = m_particles.begin(); it != m_particles.end();) {
-            const ParticlePtr& particle = *it;
-            if(particle->hasFinished()) {
-                it = m_particles.erase(it);
-            } else {
-                // pass particles through affectors
-                for(const ParticleAffectorPtr& particleAffector : m_affectors)
-                    particleAffector->updateParticle(particle, delay);
+        // pass particles through affectors
+        for(const ParticleAffectorPtr& particleAffector : m_affectors)
+            particleAffector->updateParticles(m_particles, delay);
 
-                particle->update(delay);
-                ++it;
-            }
-        }
+        // update particles
+        m_particles.update(delay);
     }
 }
@@ -34,7 +34,7 @@ public:
 
     void load(const OTMLNodePtr& node);
 
-    void addParticle(const ParticlePtr& particle);
+    void addParticle(const ParticleTypePtr& type, const PointF& position, const PointF& velocity, const PointF& acceleration, float duration);
 
     void render();
     void update();
@@ -44,7 +44,7 @@ public:
 private:
     bool m_finished;
     float m_lastUpdateTime;
-    std::list<ParticlePtr> m_particles;
+    ParticlePool m_particles;
     std::list<ParticleEmitterPtr> m_emitters;
     std::list<ParticleAffectorPtr> m_affectors;
 };
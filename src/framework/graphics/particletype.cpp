@@ -43,6 +43,7 @@ ParticleType::ParticleType()
     pMaxAcceleration = 64;
     pMinAccelerationAngle = 0;
     pMaxAccelerationAngle = 360;
+    pCompositionMode = Painter::CompositionMode_Normal;
 }
 
 void ParticleType::load(const OTMLNodePtr& node)
@@ -149,6 +150,23 @@ void ParticleType::load(const OTMLNodePtr& node)
     if(pColors.size() != pColorsStops.size())
         stdext::throw_exception("particle colors must be equal to colorstops-1");
 
-    pTexture->setSmooth(true);
-    pTexture->buildHardwareMipmaps();
+    // each color is blended into the next one between their stops, the last color stays until the end
+    pColorSteps.resize(COLOR_STEPS);
+    for(int step = 0; step < COLOR_STEPS; ++step) {
+        float life = (step + 0.5f) / COLOR_STEPS;
+        uint i = 0;
+        while(i + 1 < pColorsStops.size() && life >= pColorsStops[i + 1])
+            ++i;
+
+        if(i + 1 < pColors.size()) {
+            float factor = std::max<float>(life - pColorsStops[i], 0) / (pColorsStops[i + 1] - pColorsStops[i]);
+            pColorSteps[step] = pColors[i] * (1.0f - factor) + pColors[i + 1] * factor;
+        } else
+            pColorSteps[step] = pColors[i];
+    }
+
+    if(pTexture) {
+        pTexture->setSmooth(true);
+        pTexture->buildHardwareMipmaps();
+    }
 }
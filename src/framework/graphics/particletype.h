@@ -31,12 +31,26 @@
 class ParticleType : public LuaObject
 {
 public:
+    enum {
+        // the color gradient is sampled once per type into this many steps
+        COLOR_STEPS = 32
+    };
+
     ParticleType();
 
     void load(const OTMLNodePtr& node);
 
     std::string getName() { return pName; }
 
+    // life goes from 0 when the particle is born to 1 when it finishes
+    int getColorStep(float life) { return std::max<int>(std::min<int>(life * COLOR_STEPS, COLOR_STEPS - 1), 0); }
+    const Color& getStepColor(int step) { return pColorSteps[step]; }
+    Size getSize(float life) { return Size(pStartSize.width() + (pFinalSize.width() - pStartSize.width()) * life,
+                                           pStartSize.height() + (pFinalSize.height() - pStartSize.height()) * life); }
+    float getIgnorePhysicsAfter() { return pIgnorePhysicsAfter; }
+    const TexturePtr& getTexture() { return pTexture; }
+    Painter::CompositionMode getCompositionMode() { return pCompositionMode; }
+
 protected:
     // name
     std::string pName;
@@ -62,6 +76,7 @@ protected:
     // visual ralated
     std::vector<Color> pColors;
     std::vector<float> pColorsStops;
+    std::vector<Color> pColorSteps;
     TexturePtr pTexture;
     ParticleTypePtr particleType;
     Painter::CompositionMode pCompositionMode;
@@ -26,17 +26,20 @@
 #include "image.h"
 
 #include <framework/core/application.h>
+#include <framework/core/profiler.h>
 
 Texture::Texture()
 {
     m_id = 0;
     m_time = 0;
+    m_lastUse = 0;
 }
 
 Texture::Texture(const Size& size)
 {
     m_id = 0;
     m_time = 0;
+    m_lastUse = 0;
 
     if(!setupSize(size))
         return;
@@ -52,6 +55,7 @@ Texture::Texture(const ImagePtr& image, bool buildMipmaps, bool compress)
 {
     m_id = 0;
     m_time = 0;
+    m_lastUse = 0;
 
     createTexture();
 
@@ -70,6 +74,8 @@ Texture::~Texture()
 
 void Texture::uploadPixels(const ImagePtr& image, bool buildMipmaps, bool compress)
 {
+    PROFILE_SCOPE("Texture::uploadPixels");
+
     if(!setupSize(image->getSize(), buildMipmaps))
         return;
 
@@ -95,9 +101,51 @@ void Texture::uploadPixels(const ImagePtr& image, bool buildMipmaps, bool compre
     setupFilters();
 }
 
+void Texture::releasePixels()
+{
+    if(m_id == 0)
+        return;
+
+    // the painter must not keep the old texture bound
+    g_painter->setTexture(nullptr);
+
+    // a new texture object without storage, so the id stays valid for who holds this texture
+    glDeleteTextures(1, &m_id);
+    createTexture();
+}
+
+int Texture::getMemoryUsage()
+{
+    if(m_id == 0 || m_evicted)
+        return 0;
+
+    int bytes = m_glSize.area() * 4;
+    // the mipmap chain adds up to a third of the base level
+    if(m_hasMipmaps)
+        bytes += bytes / 3;
+    return bytes;
+}
+
+void Texture::uploadSubPixels(const Point& dest, const ImagePtr& image)
+{
+    PROFILE_SCOPE("Texture::uploadSubPixels");
+
+    if(m_id == 0 || !Rect(Point(0, 0), m_size).contains(Rect(dest, image->getSize())))
+        return;
+
+    assert(image->getBpp() == 4);
+    bind();
+    glTexSubImage2D(GL_TEXTURE_2D, 0, dest.x, dest.y, image->getWidth(), image->getHeight(), GL_RGBA, GL_UNSIGNED_BYTE, image->getPixelData());
+
+    // the painter rebuilds them before drawing from this texture again
+    if(m_hasMipmaps)
+        m_mipmapsOutdated = true;
+}
+
 void Texture::bind()
 {
-    // must reset painter texture state
+    // must reset painter texture state, batched draws may still be using this texture
+    g_painter->flush();
     g_painter->setTexture(this);
     glBindTexture(GL_TEXTURE_2D, m_id);
 }
@@ -108,8 +156,17 @@ void Texture::copyFromScreen(const Rect& screenRect)
     glCopyTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, screenRect.x(), screenRect.y(), screenRect.width(), screenRect.height());
 }
 
+void Texture::copyFromScreen(const Rect& screenRect, const Point& dest)
+{
+    bind();
+    glCopyTexSubImage2D(GL_TEXTURE_2D, 0, dest.x, dest.y, screenRect.x(), screenRect.y(), screenRect.width(), screenRect.height());
+}
+
 bool Texture::buildHardwareMipmaps()
 {
+    // cleared first, binding goes through the painter which rebuilds outdated mipmaps
+    m_mipmapsOutdated = false;
+
     if(!g_graphics.canUseHardwareMipmaps())
         return false;
 
@@ -124,6 +181,14 @@ bool Texture::buildHardwareMipmaps()
     return true;
 }
 
+void Texture::setMaxMipmapLevel(int level)
+{
+#ifndef OPENGL_ES
+    bind();
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, level);
+#endif
+}
+
 void Texture::setSmooth(bool smooth)
 {
     if(smooth && !g_graphics.canUseBilinearFiltering())
@@ -24,6 +24,7 @@
 #define TEXTURE_H
 
 #include "declarations.h"
+#include <framework/core/clock.h>
 
 class Texture : public stdext::shared_object
 {
@@ -34,17 +35,29 @@ public:
     virtual ~Texture();
 
     void uploadPixels(const ImagePtr& image, bool buildMipmaps = false, bool compress = false);
+    void uploadSubPixels(const Point& dest, const ImagePtr& image);
     void bind();
     void copyFromScreen(const Rect& screenRect);
+    void copyFromScreen(const Rect& screenRect, const Point& dest);
     virtual bool buildHardwareMipmaps();
+    // levels above this one are never sampled, mipmaps of packed images don't blend their neighbours up to it
+    void setMaxMipmapLevel(int level);
+    // frees the video memory but keeps the texture usable, pixels must be uploaded again before drawing
+    void releasePixels();
+    void touch() { m_lastUse = g_clock.millis(); }
 
     virtual void setSmooth(bool smooth);
     virtual void setRepeat(bool repeat);
     void setUpsideDown(bool upsideDown);
     void setTime(ticks_t time) { m_time = time; }
+    void setEvicted(bool evicted) { m_evicted = evicted; }
+    // pinned textures are never evicted, for the ones bound outside of the painter
+    void setPinned(bool pinned) { m_pinned = pinned; }
 
     uint getId() { return m_id; }
     ticks_t getTime() { return m_time; }
+    ticks_t getLastUse() { return m_lastUse; }
+    virtual int getMemoryUsage();
     int getWidth() { return m_size.width(); }
     int getHeight() { return m_size.height(); }
     const Size& getSize() { return m_size; }
@@ -53,6 +66,9 @@ public:
     bool isEmpty() { return m_id == 0; }
     bool hasRepeat() { return m_repeat; }
     bool hasMipmaps() { return m_hasMipmaps; }
+    bool hasOutdatedMipmaps() { return m_mipmapsOutdated; }
+    bool isEvicted() { return m_evicted; }
+    bool isPinned() { return m_pinned; }
     virtual bool isAnimatedTexture() { return false; }
 
 protected:
@@ -65,13 +81,17 @@ protected:
 
     uint m_id;
     ticks_t m_time;
+    ticks_t m_lastUse;
     Size m_size;
     Size m_glSize;
     Matrix3 m_transformMatrix;
     stdext::boolean<false> m_hasMipmaps;
+    stdext::boolean<false> m_mipmapsOutdated;
     stdext::boolean<false> m_smooth;
     stdext::boolean<false> m_upsideDown;
     stdext::boolean<false> m_repeat;
+    stdext::boolean<false> m_evicted;
+    stdext::boolean<false> m_pinned;
 };
 
 #endif
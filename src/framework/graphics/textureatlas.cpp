@@ -0,0 +1,236 @@
+/*
+ * Copyright (c) 2010-2013 OTClient <https://github.com/edubart/otclient>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "textureatlas.h"
+#include "graphics.h"
+#include "image.h"
+
+TextureAtlas g_atlas;
+
+TextureAtlas::TextureAtlas()
+{
+    m_maxPages = DEFAULT_MAX_PAGES;
+    m_evictions = 0;
+    m_overflows = 0;
+}
+
+void TextureAtlas::init()
+{
+    m_evictions = 0;
+    m_overflows = 0;
+}
+
+void TextureAtlas::terminate()
+{
+    clear();
+}
+
+AtlasRegionPtr TextureAtlas::add(const ImagePtr& image)
+{
+    int pageSize = getPageSize();
+
+    // the space taken in the page, with the transparent gutter used by the mipmaps
+    Size size = image->getSize();
+    Size allocSize((size.width() + REGION_ALIGN * 2 - 1) & ~(REGION_ALIGN - 1),
+                   (size.height() + REGION_ALIGN * 2 - 1) & ~(REGION_ALIGN - 1));
+
+    if(m_maxPages <= 0 || allocSize.width() > pageSize || allocSize.height() > pageSize)
+        return addStandalone(image);
+
+    Point pos;
+    Page *page = nullptr;
+    for(Page& candidate : m_pages) {
+        if(allocate(candidate, allocSize, pos)) {
+            page = &candidate;
+            break;
+        }
+    }
+
+    if(!page) {
+        if((int)m_pages.size() < m_maxPages) {
+            m_pages.push_back(Page());
+            page = &m_pages.back();
+            // pages start fully transparent, images are expected to carry their own padding
+            page->texture = TexturePtr(new Texture(ImagePtr(new Image(Size(pageSize, pageSize)))));
+            page->texture->setSmooth(true);
+            if(g_graphics.canUseHardwareMipmaps()) {
+                page->texture->setMaxMipmapLevel(MIPMAP_LEVELS);
+                page->texture->buildHardwareMipmaps();
+            }
+        } else {
+            // all pages are full, reuse the one drawn the longest time ago
+            ticks_t oldestUse = std::numeric_limits<ticks_t>::max();
+            for(Page& candidate : m_pages) {
+                ticks_t lastUse = 0;
+                for(const AtlasRegionPtr& region : candidate.regions) {
+                    // regions only referenced by the page are not used by anyone anymore
+                    if(region->ref_count() > 1)
+                        lastUse = std::max(lastUse, region->getLastUse());
+                }
+                if(lastUse < oldestUse) {
+                    oldestUse = lastUse;
+                    page = &candidate;
+                }
+            }
+
+            // every page is still being drawn, throwing one away would only have its images
+            // added again on the next frame, so this image goes to a texture of its own instead
+            if(oldestUse != 0 && g_clock.millis() - oldestUse < PAGE_IDLE_TIME) {
+                m_overflows++;
+                return addStandalone(image);
+            }
+            m_evictions++;
+        }
+
+        resetPage(*page);
+        if(!allocate(*page, allocSize, pos)) {
+            m_overflows++;
+            return addStandalone(image);
+        }
+    }
+
+    // the gutter is uploaded too, it may still hold pixels of evicted images
+    ImagePtr paddedImage(new Image(allocSize));
+    paddedImage->paste(image);
+    page->texture->uploadSubPixels(pos, paddedImage);
+
+    AtlasRegionPtr region(new AtlasRegion(page->texture, Rect(pos, size)));
+    region->touch();
+    page->regions.push_back(region);
+    return region;
+}
+
+void TextureAtlas::clear()
+{
+    for(Page& page : m_pages)
+        resetPage(page);
+    m_pages.clear();
+}
+
+void TextureAtlas::setMaxPages(int maxPages)
+{
+    m_maxPages = std::max<int>(maxPages, 0);
+    while((int)m_pages.size() > m_maxPages) {
+        resetPage(m_pages.back());
+        m_pages.pop_back();
+    }
+}
+
+int TextureAtlas::getRegionCount()
+{
+    int count = 0;
+    for(Page& page : m_pages)
+        count += page.regions.size();
+    return count;
+}
+
+bool TextureAtlas::allocate(Page& page, const Size& size, Point& pos)
+{
+    int pageSize = page.texture->getWidth();
+    int bestIndex = -1;
+    int bestY = pageSize;
+    int bestWidth = pageSize;
+
+    // bottom-left skyline packing, the image is placed on top of the lowest nodes it spans
+    for(uint i = 0; i < page.skyline.size(); ++i) {
+        const SkylineNode& node = page.skyline[i];
+        if(node.x + size.width() > pageSize)
+            break;
+
+        int y = node.y;
+        int widthLeft = size.width();
+        for(uint j = i; widthLeft > 0; ++j) {
+            y = std::max(y, page.skyline[j].y);
+            if(y + size.height() > pageSize)
+                break;
+            widthLeft -= page.skyline[j].width;
+        }
+
+        if(widthLeft > 0)
+            continue;
+
+        if(y < bestY || (y == bestY && node.width < bestWidth)) {
+            bestIndex = i;
+            bestY = y;
+            bestWidth = node.width;
+        }
+    }
+
+    if(bestIndex == -1)
+        return false;
+
+    pos = Point(page.skyline[bestIndex].x, bestY);
+
+    SkylineNode newNode = { pos.x, pos.y + size.height(), size.width() };
+    page.skyline.insert(page.skyline.begin() + bestIndex, newNode);
+
+    // cut the nodes now hidden below the new one
+    for(uint i = bestIndex + 1; i < page.skyline.size();) {
+        const SkylineNode& prev = page.skyline[i - 1];
+        SkylineNode& node = page.skyline[i];
+        int shrink = prev.x + prev.width - node.x;
+        if(shrink <= 0)
+            break;
+
+        node.x += shrink;
+        node.width -= shrink;
+        if(node.width > 0)
+            break;
+        page.skyline.erase(page.skyline.begin() + i);
+    }
+
+    // merge neighbours with the same height
+    for(uint i = 0; i + 1 < page.skyline.size();) {
+        if(page.skyline[i].y == page.skyline[i + 1].y) {
+            page.skyline[i].width += page.skyline[i + 1].width;
+            page.skyline.erase(page.skyline.begin() + i + 1);
+        } else
+            ++i;
+    }
+
+    return true;
+}
+
+void TextureAtlas::resetPage(Page& page)
+{
+    // owners of the regions will notice and add their images again
+    for(const AtlasRegionPtr& region : page.regions)
+        region->m_valid = false;
+    page.regions.clear();
+
+    page.skyline.clear();
+    page.skyline.push_back({ 0, 0, page.texture->getWidth() });
+}
+
+AtlasRegionPtr TextureAtlas::addStandalone(const ImagePtr& image)
+{
+    TexturePtr texture(new Texture(image, true));
+    texture->setSmooth(true);
+    AtlasRegionPtr region(new AtlasRegion(texture, Rect(Point(0, 0), image->getSize())));
+    region->touch();
+    return region;
+}
+
+int TextureAtlas::getPageSize()
+{
+    return std::min<int>(PAGE_SIZE, g_graphics.getMaxTextureSize());
+}
@@ -0,0 +1,107 @@
+/*
+ * Copyright (c) 2010-2013 OTClient <https://github.com/edubart/otclient>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef TEXTUREATLAS_H
+#define TEXTUREATLAS_H
+
+#include "texture.h"
+#include <framework/core/clock.h>
+
+// Area of a shared texture holding one uploaded image
+class AtlasRegion : public stdext::shared_object
+{
+public:
+    AtlasRegion(const TexturePtr& texture, const Rect& rect) : m_texture(texture), m_rect(rect), m_lastUse(0), m_valid(true) { }
+
+    void touch() { m_lastUse = g_clock.millis(); }
+
+    const TexturePtr& getTexture() { return m_texture; }
+    const Rect& getRect() { return m_rect; }
+    Point getOffset() { return m_rect.topLeft(); }
+    ticks_t getLastUse() { return m_lastUse; }
+    bool isValid() { return m_valid; }
+
+private:
+    TexturePtr m_texture;
+    Rect m_rect;
+    ticks_t m_lastUse;
+    bool m_valid;
+
+    friend class TextureAtlas;
+};
+
+// Packs many small images into a few large textures, so they can be drawn with the same texture bound
+class TextureAtlas
+{
+    struct SkylineNode {
+        int x, y, width;
+    };
+
+    struct Page {
+        TexturePtr texture;
+        std::vector<SkylineNode> skyline;
+        std::vector<AtlasRegionPtr> regions;
+    };
+
+public:
+    enum {
+        PAGE_SIZE = 2048,
+        DEFAULT_MAX_PAGES = 8,
+        // regions start on multiples of REGION_ALIGN and keep that many transparent pixels after them,
+        // so the first MIPMAP_LEVELS mipmap levels never mix two images
+        MIPMAP_LEVELS = 3,
+        REGION_ALIGN = 1 << MIPMAP_LEVELS,
+        // a full page is only reused after none of its images was drawn for this long
+        PAGE_IDLE_TIME = 3000
+    };
+
+    TextureAtlas();
+
+    void init();
+    void terminate();
+
+    // the returned region is never null, images that don't fit get a texture of their own
+    AtlasRegionPtr add(const ImagePtr& image);
+    void clear();
+
+    void setMaxPages(int maxPages);
+    int getMaxPages() { return m_maxPages; }
+    int getPageCount() { return m_pages.size(); }
+    int getRegionCount();
+    int getEvictions() { return m_evictions; }
+    int getOverflows() { return m_overflows; }
+
+private:
+    bool allocate(Page& page, const Size& size, Point& pos);
+    void resetPage(Page& page);
+    int getPageSize();
+    AtlasRegionPtr addStandalone(const ImagePtr& image);
+
+    std::vector<Page> m_pages;
+    int m_maxPages;
+    int m_evictions;
+    int m_overflows;
+};
+
+extern TextureAtlas g_atlas;
+
+#endif
@@ -24,6 +24,7 @@
 #include "animatedtexture.h"
 #include "graphics.h"
 #include "image.h"
+#include "textureatlas.h"
 
 #include <framework/core/resourcemanager.h>
 #include <framework/core/clock.h>
@@ -32,6 +33,14 @@
 
 TextureManager g_textures;
 
+TextureManager::TextureManager()
+{
+    m_memoryBudget = DEFAULT_MEMORY_BUDGET;
+    m_evictions = 0;
+    m_reloads = 0;
+    m_lastResidencyCheck = 0;
+}
+
 void TextureManager::init()
 {
     m_emptyTexture = TexturePtr(new Texture);
@@ -44,15 +53,22 @@ void TextureManager::terminate()
         m_liveReloadEvent = nullptr;
     }
     m_textures.clear();
+    m_evictedTextures.clear();
+    m_atlasRegions.clear();
     m_animatedTextures.clear();
     m_emptyTexture = nullptr;
 }
 
 void TextureManager::poll()
 {
+    ticks_t now = g_clock.millis();
+    if(now - m_lastResidencyCheck >= RESIDENCY_CHECK_INTERVAL) {
+        m_lastResidencyCheck = now;
+        evictTextures();
+    }
+
     // update only every 16msec, this allows upto 60 fps for animated textures
     static ticks_t lastUpdate = 0;
-    ticks_t now = g_clock.millis();
     if(now - lastUpdate < 16)
         return;
     lastUpdate = now;
@@ -65,6 +81,8 @@ void TextureManager::clearCache()
 {
     m_animatedTextures.clear();
     m_textures.clear();
+    // evicted textures are kept, they must still be reloaded when drawn
+    m_atlasRegions.clear();
 }
 
 void TextureManager::liveReload()
@@ -98,6 +116,14 @@ TexturePtr TextureManager::getTexture(const std::string& fileName)
     auto it = m_textures.find(filePath);
     if(it != m_textures.end()) {
         texture = it->second;
+    } else {
+        // evicted textures go back to the cache, their pixels are uploaded when drawn
+        auto evictedIt = m_evictedTextures.find(filePath);
+        if(evictedIt != m_evictedTextures.end()) {
+            texture = evictedIt->second;
+            m_textures[filePath] = texture;
+            m_evictedTextures.erase(evictedIt);
+        }
     }
 
     // texture not found, load it
@@ -117,6 +143,7 @@ TexturePtr TextureManager::getTexture(const std::string& fileName)
         if(texture) {
             texture->setTime(stdext::time());
             texture->setSmooth(true);
+            texture->touch();
             m_textures[filePath] = texture;
         }
     }
@@ -124,6 +151,144 @@ TexturePtr TextureManager::getTexture(const std::string& fileName)
     return texture;
 }
 
+void TextureManager::reloadTexture(Texture *texture)
+{
+    texture->setEvicted(false);
+
+    std::string filePath;
+    for(auto& it : m_textures) {
+        if(it.second.get() == texture) {
+            filePath = it.first;
+            break;
+        }
+    }
+    for(auto it = m_evictedTextures.begin(); it != m_evictedTextures.end(); ++it) {
+        if(it->second.get() == texture) {
+            filePath = it->first;
+            m_textures[filePath] = it->second;
+            m_evictedTextures.erase(it);
+            break;
+        }
+    }
+    if(filePath.empty())
+        return;
+
+    ImagePtr image = Image::load(g_resources.guessFilePath(filePath, "png"));
+    if(!image) {
+        g_logger.error(stdext::format("Unable to reload texture '%s'", filePath));
+        return;
+    }
+    texture->uploadPixels(image, texture->hasMipmaps());
+    m_reloads++;
+}
+
+int TextureManager::getMemoryUsage()
+{
+    int bytes = 0;
+    for(auto& it : m_textures)
+        bytes += it.second->getMemoryUsage();
+    return bytes;
+}
+
+void TextureManager::evictTextures()
+{
+    // evicted textures nobody else holds anymore are forgotten
+    for(auto it = m_evictedTextures.begin(); it != m_evictedTextures.end();) {
+        if(it->second.is_unique())
+            it = m_evictedTextures.erase(it);
+        else
+            ++it;
+    }
+
+    int usage = getMemoryUsage();
+    if(usage <= m_memoryBudget)
+        return;
+
+    ticks_t now = g_clock.millis();
+    std::vector<std::pair<ticks_t, std::string>> candidates;
+    for(auto& it : m_textures) {
+        const TexturePtr& texture = it.second;
+        if(texture->isAnimatedTexture() || texture->isEvicted() || texture->isPinned() || texture == m_emptyTexture)
+            continue;
+        if(now - texture->getLastUse() < MIN_IDLE_TIME)
+            continue;
+        candidates.push_back(std::make_pair(texture->getLastUse(), it.first));
+    }
+    std::sort(candidates.begin(), candidates.end());
+
+    // coldest first, until the budget is met
+    for(const auto& candidate : candidates) {
+        if(usage <= m_memoryBudget)
+            break;
+
+        auto it = m_textures.find(candidate.second);
+        TexturePtr texture = it->second;
+        m_textures.erase(it);
+        usage -= texture->getMemoryUsage();
+        m_evictions++;
+
+        // a texture only the cache holds is simply freed, getTexture loads it again
+        if(texture.is_unique())
+            continue;
+
+        texture->releasePixels();
+        texture->setEvicted(true);
+        m_evictedTextures[candidate.second] = texture;
+    }
+}
+
+AtlasRegionPtr TextureManager::getAtlasRegion(const std::string& fileName)
+{
+    std::string filePath = g_resources.resolvePath(fileName);
+
+    auto it = m_atlasRegions.find(filePath);
+    if(it != m_atlasRegions.end()) {
+        AtlasEntry& entry = it->second;
+        // images that failed to load are remembered as null regions
+        if(!entry.region)
+            return nullptr;
+        // its atlas page was reused for other images, the decoded image is kept so the file isn't read again while drawing
+        if(!entry.region->isValid())
+            entry.region = g_atlas.add(entry.image);
+        entry.region->touch();
+        return entry.region;
+    }
+
+    AtlasEntry entry;
+    try {
+        std::stringstream fin;
+        g_resources.readFileStream(g_resources.guessFilePath(filePath, "png"), fin);
+
+        apng_data apng;
+        if(load_apng(fin, &apng) == 0) {
+            Size imageSize(apng.width, apng.height);
+            TexturePtr texture;
+            if(apng.num_frames > 1) {
+                // the atlas would only hold the first frame, animated images keep a texture of their own
+                texture = loadAnimatedTexture(apng);
+            } else {
+                ImagePtr image(new Image(imageSize, apng.bpp, apng.pdata));
+                if(image->getBpp() == 4) {
+                    entry.image = image;
+                    entry.region = g_atlas.add(image);
+                } else
+                    texture = TexturePtr(new Texture(image));
+            }
+            free_apng(&apng);
+
+            if(texture) {
+                texture->setSmooth(true);
+                entry.region = AtlasRegionPtr(new AtlasRegion(texture, Rect(Point(0, 0), imageSize)));
+            }
+        }
+    } catch(stdext::exception& e) {
+        g_logger.error(stdext::format("unable to load image '%s': %s", fileName, e.what()));
+    }
+
+    m_atlasRegions[filePath] = entry;
+    return entry.region;
+}
+
 TexturePtr TextureManager::loadTexture(std::stringstream& file)
 {
     TexturePtr texture;
@@ -132,18 +297,7 @@ TexturePtr TextureManager::loadTexture(std::stringstream& file)
     if(load_apng(file, &apng) == 0) {
         Size imageSize(apng.width, apng.height);
         if(apng.num_frames > 1) { // animated texture
-            std::vector<ImagePtr> frames;
-            std::vector<int> framesDelay;
-            for(uint i=0;i<apng.num_frames;++i) {
-                uchar *frameData = apng.pdata + ((apng.first_frame+i) * imageSize.area() * apng.bpp);
-                int frameDelay = apng.frames_delay[i];
-
-                framesDelay.push_back(frameDelay);
-                frames.push_back(ImagePtr(new Image(imageSize, apng.bpp, frameData)));
-            }
-            AnimatedTexturePtr animatedTexture = new AnimatedTexture(imageSize, frames, framesDelay);
-            m_animatedTextures.push_back(animatedTexture);
-            texture = animatedTexture;
+            texture = loadAnimatedTexture(apng);
         } else {
             ImagePtr image = ImagePtr(new Image(imageSize, apng.bpp, apng.pdata));
             texture = TexturePtr(new Texture(image));
@@ -153,3 +307,20 @@ TexturePtr TextureManager::loadTexture(std::stringstream& file)
 
     return texture;
 }
+
+TexturePtr TextureManager::loadAnimatedTexture(apng_data& apng)
+{
+    Size imageSize(apng.width, apng.height);
+    std::vector<ImagePtr> frames;
+    std::vector<int> framesDelay;
+    for(uint i=0;i<apng.num_frames;++i) {
+        uchar *frameData = apng.pdata + ((apng.first_frame+i) * imageSize.area() * apng.bpp);
+        int frameDelay = apng.frames_delay[i];
+
+        framesDelay.push_back(frameDelay);
+        frames.push_back(ImagePtr(new Image(imageSize, apng.bpp, frameData)));
+    }
+    AnimatedTexturePtr animatedTexture = new AnimatedTexture(imageSize, frames, framesDelay);
+    m_animatedTextures.push_back(animatedTexture);
+    return animatedTexture;
+}
@@ -26,9 +26,28 @@
 #include "texture.h"
 #include <framework/core/declarations.h>
 
+struct apng_data;
+
+// Caches the textures loaded from files, when they take more video memory than the budget
+// the ones not drawn for a while are dropped, or released and uploaded again when drawn
 class TextureManager
 {
+    enum {
+        DEFAULT_MEMORY_BUDGET = 256 * 1024 * 1024,
+        RESIDENCY_CHECK_INTERVAL = 1000,
+        // textures drawn within this time are never evicted
+        MIN_IDLE_TIME = 5000
+    };
+
+    struct AtlasEntry {
+        AtlasRegionPtr region;
+        // decoded pixels, to add the image again when its atlas page is reused
+        ImagePtr image;
+    };
+
 public:
+    TextureManager();
+
     void init();
     void terminate();
     void poll();
@@ -38,15 +57,36 @@ public:
 
     void preload(const std::string& fileName) { getTexture(fileName); }
     TexturePtr getTexture(const std::string& fileName);
+    // small static images drawn together, like icons, can be packed in the shared atlas instead
+    AtlasRegionPtr getAtlasRegion(const std::string& fileName);
     const TexturePtr& getEmptyTexture() { return m_emptyTexture; }
+    // uploads again the pixels of an evicted texture, the painter calls it before drawing with one
+    void reloadTexture(Texture *texture);
+
+    void setMemoryBudget(int bytes) { m_memoryBudget = bytes; }
+    int getMemoryBudget() { return m_memoryBudget; }
+    int getMemoryUsage();
+    int getTextureCount() { return m_textures.size(); }
+    int getEvictedCount() { return m_evictedTextures.size(); }
+    int getEvictions() { return m_evictions; }
+    int getReloads() { return m_reloads; }
 
 private:
     TexturePtr loadTexture(std::stringstream& file);
+    TexturePtr loadAnimatedTexture(apng_data& apng);
+    void evictTextures();
 
     std::unordered_map<std::string, TexturePtr> m_textures;
+    // released textures still held somewhere else, by file path
+    std::unordered_map<std::string, TexturePtr> m_evictedTextures;
+    std::unordered_map<std::string, AtlasEntry> m_atlasRegions;
     std::vector<AnimatedTexturePtr> m_animatedTextures;
     TexturePtr m_emptyTexture;
     ScheduledEventPtr m_liveReloadEvent;
+    int m_memoryBudget;
+    int m_evictions;
+    int m_reloads;
+    ticks_t m_lastResidencyCheck;
 };
 
 extern TextureManager g_textures;
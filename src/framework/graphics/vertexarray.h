@@ -73,6 +73,19 @@ public:
         addVertex(right, top);
     }
 
+    inline void append(const VertexArray& other, float dx = 0, float dy = 0) {
+        int offset = m_buffer.size();
+        int size = other.size();
+        m_buffer.grow(offset + size);
+
+        float *dest = m_buffer.data() + offset;
+        const float *src = other.vertices();
+        for(int i = 0; i < size; i += 2) {
+            dest[i] = src[i] + dx;
+            dest[i+1] = src[i+1] + dy;
+        }
+    }
+
     void clear() { m_buffer.reset(); }
     float *vertices() const { return m_buffer.data(); }
     int vertexCount() const { return m_buffer.size() / 2; }
@@ -24,6 +24,7 @@
 #include "luaobject.h"
 
 #include <framework/core/resourcemanager.h>
+#include <framework/core/profiler.h>
 #include <lua.hpp>
 
 #include "lbitlib.h"
@@ -37,6 +38,7 @@ LuaInterface::LuaInterface()
     m_weakTableRef = 0;
     m_totalObjRefs = 0;
     m_totalFuncRefs = 0;
+    m_internedKeysRef = 0;
 }
 
 LuaInterface::~LuaInterface()
@@ -120,6 +122,13 @@ void LuaInterface::registerClass(const std::string& className, const std::string
     pushValue(klass_fieldmethods);
     setField("fieldmethods", klass_mt);
 
+    // the class id indexes the cached field methods, methods are also kept at a fixed slot for faster lookups
+    pushInteger(m_classFieldMethods.size());
+    rawSeti(1, klass_mt);
+    pushValue(klass);
+    rawSeti(2, klass_mt);
+    m_classFieldMethods.push_back(ClassFieldMethods());
+
     // redirect methods and fieldmethods to the base class ones
     if(!className.empty() && className != "LuaObject") {
         // the following code is what create classes hierarchy for lua, by reproducing:
@@ -182,6 +191,9 @@ void LuaInterface::registerClassMemberField(const std::string& className,
     }
 
     pop();
+
+    // derived classes may have cached the previous field methods
+    clearFieldMethods();
 }
 
 void LuaInterface::registerGlobalFunction(const std::string& functionName, const LuaCppFunction& function)
@@ -190,44 +202,152 @@ void LuaInterface::registerGlobalFunction(const std::string& functionName, const
     setGlobal(functionName);
 }
 
+int LuaInterface::internKey(const std::string& key)
+{
+    auto it = m_internedKeyIds.find(key);
+    if(it != m_internedKeyIds.end())
+        return it->second;
+
+    // ids start at 1 so the names fill the array part of the interned keys table
+    m_internedKeys.push_back(key);
+    int keyId = m_internedKeys.size();
+    m_internedKeyIds[key] = keyId;
+
+    if(L) {
+        getRef(m_internedKeysRef);
+        pushString(key);
+        pushInteger(keyId);
+        rawSet(-3);
+        pushString(key);
+        rawSeti(keyId);
+        pop();
+    }
+    return keyId;
+}
+
+void LuaInterface::pushInternedKey(int keyId)
+{
+    assert(keyId > 0 && keyId <= (int)m_internedKeys.size());
+    getRef(m_internedKeysRef);
+    rawGeti(keyId);
+    remove(-2);
+}
+
+int LuaInterface::getKeyId(int index)
+{
+    if(lua_type(L, index) != LUA_TSTRING)
+        return -1;
+
+    getRef(m_internedKeysRef);
+    pushValue(index);
+    rawGet(-2);
+    int keyId = isNumber() ? toInteger() : -1;
+    pop(2);
+
+    // keys coming from scripts are bounded, they could be generated
+    if(keyId < 0 && m_internedKeys.size() < MAX_INTERNED_KEYS)
+        keyId = internKey(toString(index));
+    return keyId;
+}
+
+bool LuaInterface::pushFieldMethod(int objIndex, int keyIndex, bool getter)
+{
+    int keyId = getKeyId(keyIndex);
+
+    getMetatable(objIndex);
+    rawGeti(1);
+    int classId = isNumber() ? toInteger() : -1;
+    pop(2);
+
+    int *cached = nullptr;
+    if(keyId > 0 && classId >= 0 && classId < (int)m_classFieldMethods.size()) {
+        std::vector<int>& methods = getter ? m_classFieldMethods[classId].getters : m_classFieldMethods[classId].setters;
+        if(keyId >= (int)methods.size())
+            methods.resize(keyId + 1, 0);
+        cached = &methods[keyId];
+
+        if(*cached == NO_FIELD_METHOD)
+            return false;
+        if(*cached != 0) {
+            getRef(*cached);
+            return true;
+        }
+    }
+
+    // resolve through the fieldmethods tables, they redirect to the base classes ones
+    getMetatable(objIndex); // pushes obj metatable
+    getField("fieldmethods"); // push obj fieldmethods
+    remove(-2); // removes obj metatable
+    getField((getter ? "get_" : "set_") + toString(keyIndex)); // pushes the method
+    remove(-2); // remove obj fieldmethods
+
+    if(isNil()) {
+        pop();
+        if(cached)
+            *cached = NO_FIELD_METHOD;
+        return false;
+    }
+
+    if(cached) {
+        pushValue();
+        *cached = ref();
+    }
+    return true;
+}
+
+void LuaInterface::clearFieldMethods()
+{
+    for(ClassFieldMethods& classMethods : m_classFieldMethods) {
+        for(int methodRef : classMethods.getters) {
+            if(methodRef > 0)
+                unref(methodRef);
+        }
+        for(int methodRef : classMethods.setters) {
+            if(methodRef > 0)
+                unref(methodRef);
+        }
+        classMethods.getters.clear();
+        classMethods.setters.clear();
+    }
+}
+
 int LuaInterface::luaObjectGetEvent(LuaInterface* lua)
 {
     // stack: obj, key
-    LuaObjectPtr obj = lua->toObject(-2);
-    std::string key = lua->toString(-1);
+    LuaObjectPtr obj = lua->toObject(1);
     assert(obj);
 
-    lua->remove(-1); // removes key
-
     // if a get method for this key exists, calls it
-    lua->getMetatable(); // pushes obj metatable
-    lua->getField("fieldmethods"); // push obj fieldmethods
-    lua->remove(-2); // removes obj metatable
-    lua->getField("get_" + key); // pushes get method
-    lua->remove(-2); // remove obj fieldmethods
-    if(!lua->isNil()) { // is the get method not nil?
-        lua->insert(-2); // moves obj to the top
+    if(lua->pushFieldMethod(1, 2, true)) { // pushes get method
+        lua->remove(2); // removes key
+        lua->insert(1); // moves get method below obj
         lua->signalCall(1, 1); // calls get method, arguments: obj
         return 1;
     }
-    lua->pop(); // pops the nil get method
 
     // if the field for this key exists, returns it
-    obj->luaGetField(key);
+    obj->luaGetFieldsTable(); // pushes obj fields table
     if(!lua->isNil()) {
-        lua->remove(-2); // removes the obj
+        lua->pushValue(2); // pushes key
+        lua->getTable(); // pushes field value
+        lua->remove(-2); // removes obj fields table
+    }
+    if(!lua->isNil()) {
+        lua->remove(1); // removes obj
+        lua->remove(1); // removes key
         // field value is on the stack
         return 1;
     }
     lua->pop(); // pops the nil field
 
     // pushes the method assigned by this key
-    lua->getMetatable();  // pushes obj metatable
-    lua->getField("methods"); // push obj methods
+    lua->getMetatable(1); // pushes obj metatable
+    lua->rawGeti(2); // pushes obj methods
     lua->remove(-2); // removes obj metatable
-    lua->getField(key); // pushes obj method
-    lua->remove(-2); // remove obj methods
-    lua->remove(-2); // removes obj
+    lua->insert(2); // moves obj methods below key
+    lua->getTable(2); // pushes obj method
+    lua->remove(1); // removes obj
+    lua->remove(1); // removes obj methods
 
     // the result value is on the stack
     return 1;
@@ -236,29 +356,21 @@ int LuaInterface::luaObjectGetEvent(LuaInterface* lua)
 int LuaInterface::luaObjectSetEvent(LuaInterface* lua)
 {
     // stack: obj, key, value
-    LuaObjectPtr obj = lua->toObject(-3);
-    std::string key = lua->toString(-2);
+    LuaObjectPtr obj = lua->toObject(1);
     assert(obj);
 
-    lua->remove(-2); // removes key
-    lua->insert(-2); // moves obj to the top
-
     // check if a set method for this field exists and call it
-    lua->getMetatable(); // pushes obj metatable
-    lua->getField("fieldmethods"); // push obj fieldmethods
-    lua->remove(-2); // removes obj metatable
-    lua->getField("set_" + key); // pushes set method
-    lua->remove(-2); // remove obj fieldmethods
-    if(!lua->isNil()) { // is the set method not nil?
-        lua->insert(-3); // moves func to -3
-        lua->insert(-2); // moves obj to -2, and value to -1
+    if(lua->pushFieldMethod(1, 2, false)) { // pushes set method
+        lua->insert(1); // moves set method below obj
+        lua->remove(3); // removes key
         lua->signalCall(2, 0); // calls set method, arguments: obj, value
         return 0;
     }
-    lua->pop(); // pops the nil set method
 
     // no set method exists, then treats as an field and set it
-    lua->pop(); // pops the object
+    std::string key = lua->toString(2);
+    lua->remove(1); // removes obj
+    lua->remove(1); // removes key
     obj->luaSetField(key); // sets the obj field
     return 0;
 }
@@ -431,6 +543,8 @@ std::string LuaInterface::getCurrentSourcePath(int level)
 
 int LuaInterface::safeCall(int numArgs, int numRets)
 {
+    PROFILE_SCOPE("LuaInterface::safeCall");
+
     assert(hasIndex(-numArgs-1));
 
     // saves the current stack size for calculating the number of results later
@@ -682,6 +796,19 @@ void LuaInterface::createLuaState()
     setMetatable();
     m_weakTableRef = ref();
 
+    // creates interned keys table, keys interned before this state was created are restored
+    newTable();
+    m_internedKeysRef = ref();
+    getRef(m_internedKeysRef);
+    for(int i = 0; i < (int)m_internedKeys.size(); ++i) {
+        pushString(m_internedKeys[i]);
+        pushInteger(i + 1);
+        rawSet(-3);
+        pushString(m_internedKeys[i]);
+        rawSeti(i + 1);
+    }
+    pop();
+
     // installs script loader
     getGlobal("package");
     getField("loaders");
@@ -709,6 +836,9 @@ void LuaInterface::closeLuaState()
         lua_close(L);
         L = NULL;
     }
+
+    // the cached references died with the state
+    m_classFieldMethods.clear();
 }
 
 void LuaInterface::collectGarbage()
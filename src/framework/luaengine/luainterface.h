@@ -31,6 +31,16 @@ typedef int (*LuaCFunction) (lua_State *L);
 /// Class that manages LUA stuff
 class LuaInterface
 {
+    enum {
+        MAX_INTERNED_KEYS = 16384,
+        NO_FIELD_METHOD = -1
+    };
+
+    struct ClassFieldMethods {
+        std::vector<int> getters;
+        std::vector<int> setters;
+    };
+
 public:
     LuaInterface();
     ~LuaInterface();
@@ -118,7 +128,19 @@ public:
     template<typename F>
     void bindGlobalFunction(const std::string& functionName, const F& function);
 
+    /// Maps a field name to a small id valid for the whole session, pushing an interned
+    /// name avoids building and hashing the string again on hot paths
+    int internKey(const std::string& key);
+    /// Pushes the name of an interned key
+    void pushInternedKey(int keyId);
+
 private:
+    /// Returns the id of the string key at the given stack index, interning it if needed, or -1
+    int getKeyId(int index);
+    /// Pushes the cached get or set method of an object field, returns false when it has none
+    bool pushFieldMethod(int objIndex, int keyIndex, bool getter);
+    void clearFieldMethods();
+
     /// Metamethod that will retrieve fields values (that include functions) from the object when using '.' or ':'
     static int luaObjectGetEvent(LuaInterface* lua);
     /// Metamethod that is called when setting a field of the object by using the keyword '='
@@ -344,6 +366,10 @@ private:
     int m_totalObjRefs;
     int m_totalFuncRefs;
     int m_globalEnv;
+    int m_internedKeysRef;
+    std::vector<std::string> m_internedKeys;
+    std::unordered_map<std::string, int> m_internedKeyIds;
+    std::vector<ClassFieldMethods> m_classFieldMethods;
 };
 
 extern LuaInterface g_lua;
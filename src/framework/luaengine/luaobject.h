@@ -41,11 +41,18 @@ public:
     /// @return the number of results
     template<typename... T>
     int luaCallLuaField(const std::string& field, const T&... args);
+    /// Same as above, but the field is an id from LuaInterface::internKey
+    template<typename... T>
+    int luaCallLuaField(int fieldId, const T&... args);
 
     template<typename R, typename... T>
     R callLuaField(const std::string& field, const T&... args);
     template<typename... T>
     void callLuaField(const std::string& field, const T&... args);
+    template<typename R, typename... T>
+    R callLuaField(int fieldId, const T&... args);
+    template<typename... T>
+    void callLuaField(int fieldId, const T&... args);
 
     /// Returns true if the lua field exists
     bool hasLuaField(const std::string& field);
@@ -85,6 +92,9 @@ public:
     void operator=(const LuaObject& other) { }
 
 private:
+    template<typename... T>
+    int luaCallPushedField(const T&... args);
+
     int m_fieldsTableRef;
 };
 
@@ -156,7 +166,20 @@ int LuaObject::luaCallLuaField(const std::string& field, const T&... args) {
     // push field
     g_lua.pushObject(asLuaObject());
     g_lua.getField(field);
+    return luaCallPushedField(args...);
+}
 
+template<typename... T>
+int LuaObject::luaCallLuaField(int fieldId, const T&... args) {
+    g_lua.pushObject(asLuaObject());
+    g_lua.pushInternedKey(fieldId);
+    g_lua.getTable();
+    return luaCallPushedField(args...);
+}
+
+template<typename... T>
+int LuaObject::luaCallPushedField(const T&... args) {
+    // stack: self, field
     if(!g_lua.isNil()) {
         // the first argument is always this object (self)
         g_lua.insert(-2);
@@ -187,6 +210,25 @@ void LuaObject::callLuaField(const std::string& field, const T&... args) {
         g_lua.pop(rets);
 }
 
+template<typename R, typename... T>
+R LuaObject::callLuaField(int fieldId, const T&... args) {
+    R result;
+    int rets = luaCallLuaField(fieldId, args...);
+    if(rets > 0) {
+        assert(rets == 1);
+        result = g_lua.polymorphicPop<R>();
+    } else
+        result = R();
+    return result;
+}
+
+template<typename... T>
+void LuaObject::callLuaField(int fieldId, const T&... args) {
+    int rets = luaCallLuaField(fieldId, args...);
+    if(rets > 0)
+        g_lua.pop(rets);
+}
+
 template<typename T>
 void LuaObject::setLuaField(const std::string& key, const T& value) {
     g_lua.polymorphicPush(value);
@@ -23,6 +23,7 @@
 #include <framework/core/application.h>
 #include <framework/luaengine/luainterface.h>
 #include <framework/core/eventdispatcher.h>
+#include <framework/core/profiler.h>
 #include <framework/core/configmanager.h>
 #include <framework/otml/otml.h>
 #include <framework/core/modulemanager.h>
@@ -30,6 +31,7 @@
 #include <framework/util/crypt.h>
 #include <framework/core/resourcemanager.h>
 #include <framework/graphics/texturemanager.h>
+#include <framework/graphics/textureatlas.h>
 #include <framework/stdext/net.h>
 #include <framework/platform/platform.h>
 
@@ -75,6 +77,7 @@ void Application::registerLuaFunctions()
     g_lua.bindGlobalFunction("stringtoip", [](const std::string& v) { return stdext::string_to_ip(v); });
     g_lua.bindGlobalFunction("listSubnetAddresses", [](uint32 a, uint8 b) { return stdext::listSubnetAddresses(a, b); });
     g_lua.bindGlobalFunction("ucwords", [](std::string s) { return stdext::ucwords(s); });
+    g_lua.bindGlobalFunction("parseOtml", [](const std::string& fileName) { return OTMLDocument::parse(fileName)->size(); });
 
     // Platform
     g_lua.registerSingletonClass("g_platform");
@@ -133,6 +136,15 @@ void Application::registerLuaFunctions()
     g_lua.bindSingletonFunction("g_clock", "millis", &Clock::millis, &g_clock);
     g_lua.bindSingletonFunction("g_clock", "seconds", &Clock::seconds, &g_clock);
 
+    // Profiler
+    g_lua.registerSingletonClass("g_profiler");
+    g_lua.bindSingletonFunction("g_profiler", "setEnabled", &Profiler::setEnabled, &g_profiler);
+    g_lua.bindSingletonFunction("g_profiler", "isEnabled", &Profiler::isEnabled, &g_profiler);
+    g_lua.bindSingletonFunction("g_profiler", "clear", &Profiler::clear, &g_profiler);
+    g_lua.bindSingletonFunction("g_profiler", "exportTrace", &Profiler::exportTrace, &g_profiler);
+    g_lua.bindSingletonFunction("g_profiler", "getFrameTime", &Profiler::getFrameTime, &g_profiler);
+    g_lua.bindSingletonFunction("g_profiler", "getFrameScopes", &Profiler::getFrameScopes, &g_profiler);
+
     // ConfigManager
     g_lua.registerSingletonClass("g_configs");
     g_lua.bindSingletonFunction("g_configs", "load", &ConfigManager::load, &g_configs);
@@ -158,6 +170,10 @@ void Application::registerLuaFunctions()
     g_lua.bindSingletonFunction("g_logger", "warning", &Logger::warning, &g_logger);
     g_lua.bindSingletonFunction("g_logger", "error", &Logger::error, &g_logger);
     g_lua.bindSingletonFunction("g_logger", "fatal", &Logger::fatal, &g_logger);
+    g_lua.bindSingletonFunction("g_logger", "flush", &Logger::flush, &g_logger);
+    g_lua.bindSingletonFunction("g_logger", "setOverflowPolicy", &Logger::setOverflowPolicy, &g_logger);
+    g_lua.bindSingletonFunction("g_logger", "getOverflowPolicy", &Logger::getOverflowPolicy, &g_logger);
+    g_lua.bindSingletonFunction("g_logger", "getDroppedMessages", &Logger::getDroppedMessages, &g_logger);
 
     // ModuleManager
     g_lua.registerSingletonClass("g_modules");
@@ -298,6 +314,11 @@ void Application::registerLuaFunctions()
     g_lua.bindSingletonFunction("g_graphics", "setShouldUseShaders", &Graphics::setShouldUseShaders, &g_graphics);
     g_lua.bindSingletonFunction("g_graphics", "getPainterEngine", &Graphics::getPainterEngine, &g_graphics);
     g_lua.bindSingletonFunction("g_graphics", "getViewportSize", &Graphics::getViewportSize, &g_graphics);
+    g_lua.bindSingletonFunction("g_graphics", "setPainterBatching", &Graphics::setPainterBatching, &g_graphics);
+    g_lua.bindSingletonFunction("g_graphics", "isPainterBatching", &Graphics::isPainterBatching, &g_graphics);
+    g_lua.bindSingletonFunction("g_graphics", "getDrawCalls", &Graphics::getDrawCalls, &g_graphics);
+    g_lua.bindSingletonFunction("g_graphics", "getDrawBatches", &Graphics::getDrawBatches, &g_graphics);
+    g_lua.bindSingletonFunction("g_graphics", "getDrawQuads", &Graphics::getDrawQuads, &g_graphics);
     g_lua.bindSingletonFunction("g_graphics", "getVendor", &Graphics::getVendor, &g_graphics);
     g_lua.bindSingletonFunction("g_graphics", "getRenderer", &Graphics::getRenderer, &g_graphics);
     g_lua.bindSingletonFunction("g_graphics", "getVersion", &Graphics::getVersion, &g_graphics);
@@ -307,6 +328,23 @@ void Application::registerLuaFunctions()
     g_lua.bindSingletonFunction("g_textures", "preload", &TextureManager::preload, &g_textures);
     g_lua.bindSingletonFunction("g_textures", "clearCache", &TextureManager::clearCache, &g_textures);
     g_lua.bindSingletonFunction("g_textures", "liveReload", &TextureManager::liveReload, &g_textures);
+    g_lua.bindSingletonFunction("g_textures", "setMemoryBudget", &TextureManager::setMemoryBudget, &g_textures);
+    g_lua.bindSingletonFunction("g_textures", "getMemoryBudget", &TextureManager::getMemoryBudget, &g_textures);
+    g_lua.bindSingletonFunction("g_textures", "getMemoryUsage", &TextureManager::getMemoryUsage, &g_textures);
+    g_lua.bindSingletonFunction("g_textures", "getTextureCount", &TextureManager::getTextureCount, &g_textures);
+    g_lua.bindSingletonFunction("g_textures", "getEvictedCount", &TextureManager::getEvictedCount, &g_textures);
+    g_lua.bindSingletonFunction("g_textures", "getEvictions", &TextureManager::getEvictions, &g_textures);
+    g_lua.bindSingletonFunction("g_textures", "getReloads", &TextureManager::getReloads, &g_textures);
+
+    // TextureAtlas
+    g_lua.registerSingletonClass("g_atlas");
+    g_lua.bindSingletonFunction("g_atlas", "clear", &TextureAtlas::clear, &g_atlas);
+    g_lua.bindSingletonFunction("g_atlas", "setMaxPages", &TextureAtlas::setMaxPages, &g_atlas);
+    g_lua.bindSingletonFunction("g_atlas", "getMaxPages", &TextureAtlas::getMaxPages, &g_atlas);
+    g_lua.bindSingletonFunction("g_atlas", "getPageCount", &TextureAtlas::getPageCount, &g_atlas);
+    g_lua.bindSingletonFunction("g_atlas", "getRegionCount", &TextureAtlas::getRegionCount, &g_atlas);
+    g_lua.bindSingletonFunction("g_atlas", "getEvictions", &TextureAtlas::getEvictions, &g_atlas);
+    g_lua.bindSingletonFunction("g_atlas", "getOverflows", &TextureAtlas::getOverflows, &g_atlas);
 
     // UI
     g_lua.registerSingletonClass("g_ui");
@@ -325,6 +363,13 @@ void Application::registerLuaFunctions()
     g_lua.bindSingletonFunction("g_ui", "isDrawingDebugBoxes", &UIManager::isDrawingDebugBoxes, &g_ui);
     g_lua.bindSingletonFunction("g_ui", "isMouseGrabbed", &UIManager::isMouseGrabbed, &g_ui);
     g_lua.bindSingletonFunction("g_ui", "isKeyboardGrabbed", &UIManager::isKeyboardGrabbed, &g_ui);
+    g_lua.bindSingletonFunction("g_ui", "setPartialRedraw", &UIManager::setPartialRedraw, &g_ui);
+    g_lua.bindSingletonFunction("g_ui", "isPartialRedraw", &UIManager::isPartialRedraw, &g_ui);
+    g_lua.bindSingletonFunction("g_ui", "getFullRedraws", &UIManager::getFullRedraws, &g_ui);
+    g_lua.bindSingletonFunction("g_ui", "getPartialRedraws", &UIManager::getPartialRedraws, &g_ui);
+    g_lua.bindSingletonFunction("g_ui", "getDamagedRects", &UIManager::getDamagedRects, &g_ui);
+    g_lua.bindSingletonFunction("g_ui", "getDrawnWidgets", &UIManager::getDrawnWidgets, &g_ui);
+    g_lua.bindSingletonFunction("g_ui", "resetRenderStats", &UIManager::resetRenderStats, &g_ui);
 
     // FontManager
     g_lua.registerSingletonClass("g_fonts");
@@ -24,6 +24,7 @@
 
 #include <framework/core/application.h>
 #include <framework/core/eventdispatcher.h>
+#include <framework/core/profiler.h>
 #include <boost/asio.hpp>
 
 asio::io_service g_ioService;
@@ -50,6 +51,8 @@ Connection::~Connection()
 
 void Connection::poll()
 {
+    PROFILE_SCOPE("Connection::poll");
+
     // reset must always be called prior to poll
     g_ioService.reset();
     g_ioService.poll();
@@ -35,10 +35,16 @@ OTMLDocumentPtr OTMLDocument::create()
 
 OTMLDocumentPtr OTMLDocument::parse(const std::string& fileName)
 {
-    std::stringstream fin;
+    // the parser works straight over the file contents, without stream copies
     std::string source = g_resources.resolvePath(fileName);
-    g_resources.readFileStream(source, fin);
-    return parse(fin, source);
+    std::string buffer = g_resources.readFileContents(source);
+    OTMLDocumentPtr doc(new OTMLDocument);
+    doc->setSource(source);
+    if(buffer.empty())
+        throw OTMLException(doc, "cannot read from input stream");
+    OTMLParser parser(doc, buffer);
+    parser.parse();
+    return doc;
 }
 
 OTMLDocumentPtr OTMLDocument::parse(std::istream& in, const std::string& source)
@@ -57,7 +63,7 @@ std::string OTMLDocument::emit()
 
 bool OTMLDocument::save(const std::string& fileName)
 {
-    m_source = fileName;
+    setSource(fileName);
     return g_resources.writeFileContents(fileName, emit());
 }
 
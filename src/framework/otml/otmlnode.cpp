@@ -41,6 +41,15 @@ OTMLNodePtr OTMLNode::create(std::string tag, std::string value)
     return node;
 }
 
+std::string OTMLNode::source()
+{
+    if(!m_sourceFile)
+        return std::string();
+    if(m_sourceLine == 0)
+        return *m_sourceFile;
+    return *m_sourceFile + ":" + stdext::to_string(m_sourceLine);
+}
+
 bool OTMLNode::hasChildren()
 {
     int count = 0;
@@ -148,7 +157,7 @@ void OTMLNode::copy(const OTMLNodePtr& node)
     setValue(node->rawValue());
     setUnique(node->isUnique());
     setNull(node->isNull());
-    setSource(node->source());
+    setSource(node->m_sourceFile, node->m_sourceLine);
     clear();
     for(const OTMLNodePtr& child : node->m_children)
         addChild(child->clone());
@@ -159,7 +168,7 @@ void OTMLNode::merge(const OTMLNodePtr& node)
     for(const OTMLNodePtr& child : node->m_children)
         addChild(child->clone());
     setTag(node->tag());
-    setSource(node->source());
+    setSource(node->m_sourceFile, node->m_sourceLine);
 }
 
 void OTMLNode::clear()
@@ -183,7 +192,7 @@ OTMLNodePtr OTMLNode::clone()
     myClone->setValue(m_value);
     myClone->setUnique(m_unique);
     myClone->setNull(m_null);
-    myClone->setSource(m_source);
+    myClone->setSource(m_sourceFile, m_sourceLine);
     for(const OTMLNodePtr& child : m_children)
         myClone->addChild(child->clone());
     return myClone;
@@ -35,7 +35,7 @@ public:
 
     std::string tag() { return m_tag; }
     int size() { return m_children.size(); }
-    std::string source() { return m_source; }
+    std::string source();
     std::string rawValue() { return m_value; }
 
     bool isUnique() { return m_unique; }
@@ -51,7 +51,8 @@ public:
     void setValue(const std::string& value) { m_value = value; }
     void setNull(bool null) { m_null = null; }
     void setUnique(bool unique) { m_unique = unique; }
-    void setSource(const std::string& source) { m_source = source; }
+    void setSource(const std::string& source) { m_sourceFile = std::make_shared<std::string>(source); m_sourceLine = 0; }
+    void setSource(const std::shared_ptr<std::string>& sourceFile, int sourceLine) { m_sourceFile = sourceFile; m_sourceLine = sourceLine; }
 
     OTMLNodePtr get(const std::string& childTag);
     OTMLNodePtr getIndex(int childIndex);
@@ -92,12 +93,14 @@ public:
     OTMLNodePtr asOTMLNode() { return static_self_cast<OTMLNode>(); }
 
 protected:
-    OTMLNode() : m_unique(false), m_null(false) { }
+    OTMLNode() : m_sourceLine(0), m_unique(false), m_null(false) { }
 
     OTMLNodeList m_children;
     std::string m_tag;
     std::string m_value;
-    std::string m_source;
+    // the file name is shared by all nodes of a document, "file:line" is only built when asked
+    std::shared_ptr<std::string> m_sourceFile;
+    int m_sourceLine;
     bool m_unique;
     bool m_null;
 };
@@ -25,35 +25,68 @@
 #include "otmlexception.h"
 #include <boost/tokenizer.hpp>
 
+static inline bool isSpace(char c)
+{
+    return c == ' ' || c == '\t' || c == '\n' || c == '\v' || c == '\f' || c == '\r';
+}
+
+void OTMLParser::TextRange::trim()
+{
+    while(begin != end && isSpace(*begin))
+        ++begin;
+    while(begin != end && isSpace(*(end - 1)))
+        --end;
+}
+
 OTMLParser::OTMLParser(OTMLDocumentPtr doc, std::istream& in) :
     currentDepth(0), currentLine(0),
-    doc(doc), currentParent(doc), previousNode(0),
-    in(in)
+    doc(doc), previousNode(0)
+{
+    if(!in.good())
+        throw OTMLException(doc, "cannot read from input stream");
+
+    ownedBuffer.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    pos = ownedBuffer.data();
+    end = pos + ownedBuffer.size();
+    finished = false;
+}
+
+OTMLParser::OTMLParser(OTMLDocumentPtr doc, const std::string& buffer) :
+    currentDepth(0), currentLine(0),
+    doc(doc), previousNode(0)
 {
+    pos = buffer.data();
+    end = pos + buffer.size();
+    finished = false;
 }
 
 void OTMLParser::parse()
 {
-    if(!in.good())
-        throw OTMLException(doc, "cannot read from input stream");
+    // every node of the document shares the same file name
+    sourceFile = std::make_shared<std::string>(doc->source());
+    parents.assign(1, doc);
 
-    while(!in.eof())
+    while(!finished)
         parseLine(getNextLine());
 }
 
-std::string OTMLParser::getNextLine()
+OTMLParser::TextRange OTMLParser::getNextLine()
 {
     currentLine++;
-    std::string line;
-    std::getline(in, line);
+    const char *lineEnd = std::find(pos, end, '\n');
+    TextRange line(pos, lineEnd);
+    if(lineEnd == end)
+        finished = true;
+    else
+        pos = lineEnd + 1;
     return line;
 }
 
-int OTMLParser::getLineDepth(const std::string& line, bool multilining)
+int OTMLParser::getLineDepth(const TextRange& line, bool multilining)
 {
     // count number of spaces at the line beginning
     std::size_t spaces = 0;
-    while(line[spaces] == ' ')
+    while(spaces < line.size() && line.begin[spaces] == ' ')
         spaces++;
 
     // pre calculate depth
@@ -61,7 +94,7 @@ int OTMLParser::getLineDepth(const std::string& line, bool multilining)
 
     if(!multilining || depth <= currentDepth) {
         // check the next character is a tab
-        if(line[spaces] == '\t')
+        if(spaces < line.size() && line.begin[spaces] == '\t')
             throw OTMLException(doc, "indentation with tabs are not allowed", currentLine);
 
         // must indent every 2 spaces
@@ -72,31 +105,30 @@ int OTMLParser::getLineDepth(const std::string& line, bool multilining)
     return depth;
 }
 
-void OTMLParser::parseLine(std::string line)
+void OTMLParser::parseLine(TextRange line)
 {
     int depth = getLineDepth(line);
 
-    if(depth == -1)
-        return;
-
     // remove line sides spaces
-    stdext::trim(line);
+    line.trim();
 
     // skip empty lines
     if(line.empty())
         return;
 
     // skip comments
-    if(stdext::starts_with(line, "//"))
+    if(line.startsWith("//"))
         return;
 
     // a depth above, change current parent to the previous added node
     if(depth == currentDepth+1) {
-        currentParent = previousNode;
+        if(!previousNode)
+            throw OTMLException(doc, "invalid indentation depth, are you indenting correctly?", currentLine);
+        parents.resize(depth + 1);
+        parents[depth] = previousNode;
     // a depth below, change parent to previous parent
     } else if(depth < currentDepth) {
-        for(int i=0;i<currentDepth-depth;++i)
-            currentParent = parentMap[currentParent];
+        parents.resize(depth + 1);
     // if it isn't the current depth, it's a syntax error
     } else if(depth != currentDepth)
         throw OTMLException(doc, "invalid indentation depth, are you indenting correctly?", currentLine);
@@ -109,97 +141,97 @@ void OTMLParser::parseLine(std::string line)
     parseNode(line);
 }
 
-void OTMLParser::parseNode(const std::string& data)
+void OTMLParser::parseNode(const TextRange& data)
 {
-    std::string tag;
-    std::string value;
-    std::size_t dotsPos = data.find_first_of(':');
+    TextRange tag;
+    TextRange value;
+    const char *dotsPos = std::find(data.begin, data.end, ':');
+    bool hasDots = dotsPos != data.end;
     int nodeLine = currentLine;
 
     // node that has no tag and may have a value
-    if(!data.empty() && data[0] == '-') {
-        value = data.substr(1);
-        stdext::trim(value);
+    if(!data.empty() && data.begin[0] == '-') {
+        value = TextRange(data.begin + 1, data.end);
     // node that has tag and possible a value
-    } else if(dotsPos != std::string::npos) {
-        tag = data.substr(0, dotsPos);
-        if(data.size() > dotsPos+1)
-            value = data.substr(dotsPos+1);
+    } else if(hasDots) {
+        tag = TextRange(data.begin, dotsPos);
+        value = TextRange(dotsPos + 1, data.end);
     // node that has only a tag
     } else {
         tag = data;
     }
 
-    stdext::trim(tag);
-    stdext::trim(value);
+    tag.trim();
+    value.trim();
+
+    // create the node
+    OTMLNodePtr node = OTMLNode::create(tag.str());
+
+    node->setUnique(hasDots);
+    node->setSource(sourceFile, nodeLine);
 
     // process multitine values
-    if(value == "|" || value == "|-" || value == "|+") {
+    std::string valueData;
+    if(value.equals("|") || value.equals("|-") || value.equals("|+")) {
         // reads next lines until we can a value below the same depth
         std::string multiLineData;
         do {
-            size_t lastPos = in.tellg();
-            std::string line = getNextLine();
+            const char *lastPos = pos;
+            bool lastFinished = finished;
+            TextRange line = getNextLine();
             int depth = getLineDepth(line, true);
 
             // depth above current depth, add the text to the multiline
             if(depth > currentDepth) {
-                multiLineData += line.substr((currentDepth+1)*2);
+                multiLineData.append(line.begin + (currentDepth+1)*2, line.end);
             // it has contents below the current depth
             } else {
                 // if not empty, its a node
-                stdext::trim(line);
+                line.trim();
                 if(!line.empty()) {
                     // rewind and break
-                    in.seekg(lastPos, std::ios::beg);
+                    pos = lastPos;
+                    finished = lastFinished;
                     currentLine--;
                     break;
                 }
             }
             multiLineData += "\n";
-        } while(!in.eof());
+        } while(!finished);
 
         /* determine how to treat new lines at the end
          * | strip all new lines at the end and add just a new one
          * |- strip all new lines at the end
          * |+ keep all the new lines at the end (the new lines until next node)
          */
-        if(value == "|" || value == "|-") {
+        if(!value.equals("|+")) {
             // remove all new lines at the end
-            int lastPos = multiLineData.length();
-            while(multiLineData[--lastPos] == '\n')
-                multiLineData.erase(lastPos, 1);
+            while(!multiLineData.empty() && multiLineData[multiLineData.length() - 1] == '\n')
+                multiLineData.erase(multiLineData.length() - 1);
 
-            if(value == "|")
+            if(value.equals("|"))
                 multiLineData.append("\n");
-        } // else it's |+
-
-        value = multiLineData;
-    }
-
-    // create the node
-    OTMLNodePtr node = OTMLNode::create(tag);
+        }
 
-    node->setUnique(dotsPos != std::string::npos);
-    node->setTag(tag);
-    node->setSource(doc->source() + ":" + stdext::unsafe_cast<std::string>(nodeLine));
+        valueData.swap(multiLineData);
+    } else
+        valueData = value.str();
 
     // ~ is considered the null value
-    if(value == "~")
+    if(valueData == "~")
         node->setNull(true);
     else {
-        if(stdext::starts_with(value, "[") && stdext::ends_with(value, "]")) {
-            std::string tmp = value.substr(1, value.length()-2);
+        if(stdext::starts_with(valueData, "[") && stdext::ends_with(valueData, "]")) {
+            std::string tmp = valueData.substr(1, valueData.length()-2);
             boost::tokenizer<boost::escaped_list_separator<char>> tokens(tmp);
             for(std::string v : tokens) {
                 stdext::trim(v);
                 node->writeIn(v);
             }
         } else
-            node->setValue(value);
+            node->setValue(valueData);
     }
 
-    currentParent->addChild(node);
-    parentMap[node] = currentParent;
+    parents[currentDepth]->addChild(node);
     previousNode = node;
 }
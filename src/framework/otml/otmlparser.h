@@ -27,30 +27,51 @@
 
 class OTMLParser
 {
+    /// Piece of the input buffer, lines, tags and values are never copied until a node is created
+    struct TextRange {
+        TextRange() : begin(nullptr), end(nullptr) { }
+        TextRange(const char *begin, const char *end) : begin(begin), end(end) { }
+
+        bool empty() const { return begin == end; }
+        std::size_t size() const { return end - begin; }
+        bool equals(const char *str) const { return size() == strlen(str) && std::equal(begin, end, str); }
+        bool startsWith(const char *str) const { return size() >= strlen(str) && std::equal(str, str + strlen(str), begin); }
+        std::string str() const { return std::string(begin, end); }
+        void trim();
+
+        const char *begin;
+        const char *end;
+    };
+
 public:
     OTMLParser(OTMLDocumentPtr doc, std::istream& in);
+    /// Parses straight from the buffer, it must outlive the parser
+    OTMLParser(OTMLDocumentPtr doc, const std::string& buffer);
 
     /// Parse the entire document
     void parse();
 
 private:
-    /// Retrieve next line from the input stream
-    std::string getNextLine();
+    /// Retrieve next line from the input buffer
+    TextRange getNextLine();
     /// Counts depth of a line (every 2 spaces increments one depth)
-    int getLineDepth(const std::string& line, bool multilining = false);
+    int getLineDepth(const TextRange& line, bool multilining = false);
 
-    /// Parse each line of the input stream
-    void parseLine(std::string line);
+    /// Parse each line of the input buffer
+    void parseLine(TextRange line);
     /// Parse nodes tag and value
-    void parseNode(const std::string& data);
+    void parseNode(const TextRange& data);
 
     int currentDepth;
     int currentLine;
     OTMLDocumentPtr doc;
-    OTMLNodePtr currentParent;
-    std::unordered_map<OTMLNodePtr, OTMLNodePtr> parentMap;
+    std::shared_ptr<std::string> sourceFile;
+    std::vector<OTMLNodePtr> parents;
     OTMLNodePtr previousNode;
-    std::istream& in;
+    std::string ownedBuffer;
+    const char *pos;
+    const char *end;
+    bool finished;
 };
 
 #endif
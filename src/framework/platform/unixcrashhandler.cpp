@@ -32,8 +32,10 @@
 
 #include <execinfo.h>
 #include <ucontext.h>
+#include <unistd.h>
 
 #define MAX_BACKTRACE_DEPTH 128
+#define CRASH_LOG_FLUSH_TIMEOUT 1000
 #define DEMANGLE_BACKTRACE_SYMBOLS
 
 void crashHandler(int signum, siginfo_t* info, void* secret)
@@ -115,6 +117,14 @@ void crashHandler(int signum, siginfo_t* info, void* secret)
     } else
         g_logger.error("Failed to save crash report!");
 
+    // the process won't live long enough for the log writer to catch up, but the crash may have left
+    // the logger locks held, so if it doesn't finish in time the report goes straight to stderr
+    if(!g_logger.tryFlush(CRASH_LOG_FLUSH_TIMEOUT)) {
+        std::string report = ss.str();
+        ssize_t written = write(STDERR_FILENO, report.data(), report.size());
+        (void)written;
+    }
+
     signal(SIGILL, SIG_DFL);
     signal(SIGSEGV, SIG_DFL);
     signal(SIGFPE, SIG_DFL);
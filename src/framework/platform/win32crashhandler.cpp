@@ -30,6 +30,8 @@
 #include <process.h>
 #include <imagehlp.h>
 
+#define CRASH_LOG_FLUSH_TIMEOUT 1000
+
 const char *getExceptionName(DWORD exceptionCode)
 {
     switch (exceptionCode) {
@@ -140,6 +142,9 @@ LONG CALLBACK ExceptionHandler(LPEXCEPTION_POINTERS e)
     } else
         g_logger.error("Failed to save crash report!");
 
+    // the process won't live long enough for the log writer to catch up, the crash may have left a logger lock held
+    g_logger.tryFlush(CRASH_LOG_FLUSH_TIMEOUT);
+
     // inform the user
     std::string msg = stdext::format(
         "The application has crashed.\n\n"
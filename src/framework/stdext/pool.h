@@ -0,0 +1,93 @@
+/*
+ * Copyright (c) 2010-2013 OTClient <https://github.com/edubart/otclient>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+#ifndef STDEXT_POOL_H
+#define STDEXT_POOL_H
+
+#include "types.h"
+#include <type_traits>
+#include <vector>
+
+namespace stdext {
+
+// allocates fixed size objects from big chunks, objects allocated in sequence lie next to each other in memory
+template<std::size_t ObjectSize, std::size_t ChunkObjects = 1024>
+class block_pool {
+    union node {
+        node *next;
+        typename std::aligned_storage<ObjectSize>::type storage;
+    };
+
+public:
+    // pools of short lived objects should keep their chunks to avoid freeing and allocating them all the time
+    explicit block_pool(bool releaseWhenEmpty = true) : m_free(nullptr), m_used(0), m_releaseWhenEmpty(releaseWhenEmpty) { }
+    ~block_pool() { release(); }
+
+    void *allocate() {
+        if(!m_free)
+            grow();
+        node *n = m_free;
+        m_free = n->next;
+        ++m_used;
+        return n;
+    }
+
+    void deallocate(void *p) {
+        node *n = static_cast<node*>(p);
+        n->next = m_free;
+        m_free = n;
+        // give the memory back once every object is gone
+        if(--m_used == 0 && m_releaseWhenEmpty)
+            release();
+    }
+
+    std::size_t used() const { return m_used; }
+    std::size_t capacity() const { return m_chunks.size() * ChunkObjects; }
+
+private:
+    void grow() {
+        node *chunk = new node[ChunkObjects];
+        m_chunks.push_back(chunk);
+        // link backwards so the chunk is handed out from its first slot on
+        for(std::size_t i = ChunkObjects; i > 0; --i) {
+            chunk[i-1].next = m_free;
+            m_free = &chunk[i-1];
+        }
+    }
+
+    void release() {
+        for(node *chunk : m_chunks)
+            delete[] chunk;
+        m_chunks.clear();
+        m_free = nullptr;
+    }
+
+    node *m_free;
+    std::size_t m_used;
+    bool m_releaseWhenEmpty;
+    std::vector<node*> m_chunks;
+};
+
+}
+
+#endif
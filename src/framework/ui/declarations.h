@@ -37,6 +37,7 @@ class UIAnchor;
 class UIAnchorGroup;
 class UIAnchorLayout;
 class UIParticles;
+class UIStateStyle;
 
 typedef stdext::shared_object_ptr<UIWidget> UIWidgetPtr;
 typedef stdext::shared_object_ptr<UIParticles> UIParticlesPtr;
@@ -49,6 +50,7 @@ typedef stdext::shared_object_ptr<UIGridLayout> UIGridLayoutPtr;
 typedef stdext::shared_object_ptr<UIAnchor> UIAnchorPtr;
 typedef stdext::shared_object_ptr<UIAnchorGroup> UIAnchorGroupPtr;
 typedef stdext::shared_object_ptr<UIAnchorLayout> UIAnchorLayoutPtr;
+typedef stdext::shared_object_ptr<UIStateStyle> UIStateStylePtr;
 
 typedef std::deque<UIWidgetPtr> UIWidgetList;
 typedef std::vector<UIAnchorPtr> UIAnchorList;
@@ -32,5 +32,6 @@
 #include "uigridlayout.h"
 #include "uianchorlayout.h"
 #include "uiparticles.h"
+#include "uistatestyle.h"
 
 #endif
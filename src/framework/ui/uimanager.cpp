@@ -29,6 +29,7 @@
 #include <framework/core/eventdispatcher.h>
 #include <framework/core/application.h>
 #include <framework/core/resourcemanager.h>
+#include <framework/core/profiler.h>
 
 UIManager g_ui;
 
@@ -39,6 +40,7 @@ void UIManager::init()
     m_rootWidget->setId("root");
     m_mouseReceiver = m_rootWidget;
     m_keyboardReceiver = m_rootWidget;
+    resetRenderStats();
 }
 
 void UIManager::terminate()
@@ -52,15 +54,130 @@ void UIManager::terminate()
     m_hoveredWidget = nullptr;
     m_pressedWidget = nullptr;
     m_styles.clear();
+    m_stateStyles.clear();
+    m_damagedRects.clear();
     m_destroyedWidgets.clear();
     m_checkEvent = nullptr;
 }
 
 void UIManager::render(Fw::DrawPane drawPane)
 {
+    PROFILE_SCOPE("UIManager::render");
+
+    // a full redraw covers any pending damage
+    if(drawPane & Fw::ForegroundPane) {
+        m_damagedRects.clear();
+        m_fullRedraws++;
+    }
+
     m_rootWidget->draw(m_rootWidget->getRect(), drawPane);
 }
 
+void UIManager::render(Fw::DrawPane drawPane, const Rect& rect)
+{
+    PROFILE_SCOPE("UIManager::render");
+
+    // widgets outside the rect are skipped while walking the tree, the clip takes care of partially covered ones
+    Rect oldClipRect = g_painter->getClipRect();
+    g_painter->setClipRect(rect);
+    m_rootWidget->draw(rect, drawPane);
+    g_painter->setClipRect(oldClipRect);
+}
+
+void UIManager::invalidate(const Rect& rect)
+{
+    // a full redraw is already due and covers any damage
+    if(!m_partialRedraw || !m_rootWidget || g_app.willRepaint()) {
+        g_app.repaint();
+        return;
+    }
+
+    Rect damagedRect = rect;
+
+    // widgets drawing outside of their rect are redrawn whole, the partial redraw culls them by their rect
+    int expansions = 0;
+    bool expanded = true;
+    while(expanded) {
+        expanded = false;
+        for(const auto& it : m_overflowRects) {
+            if(it.second.intersects(damagedRect) && !damagedRect.contains(it.second)) {
+                damagedRect |= it.second;
+                expanded = true;
+            }
+        }
+
+        if(expanded && ++expansions > MAX_DAMAGED_RECTS) {
+            m_damagedRects.clear();
+            g_app.repaint();
+            return;
+        }
+    }
+
+    damagedRect = damagedRect.intersection(m_rootWidget->getRect());
+    if(!damagedRect.isValid())
+        return;
+
+    // merge with every damaged rect it touches, merged rects can touch others so repeat until stable
+    bool merged = true;
+    while(merged) {
+        merged = false;
+        for(auto it = m_damagedRects.begin(); it != m_damagedRects.end(); ++it) {
+            if(it->contains(damagedRect))
+                return;
+            if(it->intersects(damagedRect)) {
+                damagedRect = damagedRect.united(*it);
+                m_damagedRects.erase(it);
+                merged = true;
+                break;
+            }
+        }
+    }
+
+    // busy frames are cheaper to redraw whole than to keep merging every new rect
+    if((int)m_damagedRects.size() >= MAX_DAMAGED_RECTS) {
+        m_damagedRects.clear();
+        g_app.repaint();
+        return;
+    }
+
+    m_damagedRects.push_back(damagedRect);
+}
+
+void UIManager::setOverflowRect(UIWidget *widget, const Rect& drawnRect)
+{
+    if(drawnRect.isValid())
+        m_overflowRects[widget] = drawnRect;
+    else
+        m_overflowRects.erase(widget);
+}
+
+void UIManager::setPartialRedraw(bool enable)
+{
+    // the foreground may switch between cached and drawn every frame
+    m_partialRedraw = enable;
+    m_damagedRects.clear();
+    g_app.repaint();
+}
+
+std::vector<Rect> UIManager::takeDamagedRects()
+{
+    std::vector<Rect> damagedRects;
+    damagedRects.swap(m_damagedRects);
+    if(!damagedRects.empty()) {
+        m_partialRedraws++;
+        m_damagedRectsDrawn += damagedRects.size();
+    }
+    return damagedRects;
+}
+
+void UIManager::resetRenderStats()
+{
+    m_fullRedraws = 0;
+    m_partialRedraws = 0;
+    m_damagedRectsDrawn = 0;
+    m_drawnWidgets = 0;
+}
+
 void UIManager::resize(const Size& size)
 {
     m_rootWidget->setSize(g_window.getSize());
@@ -263,6 +380,8 @@ void UIManager::onWidgetDisappear(const UIWidgetPtr& widget)
 
 void UIManager::onWidgetDestroy(const UIWidgetPtr& widget)
 {
+    m_overflowRects.erase(widget.get());
+
     // release input grabs
     if(m_keyboardReceiver == widget)
         resetKeyboardReceiver();
@@ -306,6 +425,7 @@ void UIManager::onWidgetDestroy(const UIWidgetPtr& widget)
 void UIManager::clearStyles()
 {
     m_styles.clear();
+    m_stateStyles.clear();
 }
 
 bool UIManager::importStyle(std::string file)
@@ -365,6 +485,7 @@ void UIManager::importStyleFromOTML(const OTMLNodePtr& styleNode)
         style->merge(styleNode);
         style->setTag(name);
         m_styles[name] = style;
+        m_stateStyles[name] = UIStateStylePtr(new UIStateStyle(style));
     }
 }
 
@@ -385,6 +506,15 @@ OTMLNodePtr UIManager::getStyle(const std::string& styleName)
     return nullptr;
 }
 
+UIStateStylePtr UIManager::getStateStyle(const OTMLNodePtr& styleNode)
+{
+    // widgets that did not override any state related property share the compiled style
+    auto it = m_stateStyles.find(styleNode->tag());
+    if(it != m_stateStyles.end() && it->second->isCompatible(styleNode))
+        return it->second;
+    return UIStateStylePtr(new UIStateStyle(styleNode));
+}
+
 std::string UIManager::getStyleClass(const std::string& styleName)
 {
     OTMLNodePtr style = getStyle(styleName);
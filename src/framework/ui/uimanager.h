@@ -31,11 +31,16 @@
 //@bindsingleton g_ui
 class UIManager
 {
+    enum {
+        MAX_DAMAGED_RECTS = 8
+    };
+
 public:
     void init();
     void terminate();
 
     void render(Fw::DrawPane drawPane);
+    void render(Fw::DrawPane drawPane, const Rect& rect);
     void resize(const Size& size);
     void inputEvent(const InputEvent& event);
 
@@ -43,10 +48,25 @@ public:
     bool updateDraggingWidget(const UIWidgetPtr& draggingWidget, const Point& clickedPos = Point());
     void updateHoveredWidget(bool now = false);
 
+    void invalidate(const Rect& rect);
+    void setOverflowRect(UIWidget *widget, const Rect& drawnRect);
+    std::vector<Rect> takeDamagedRects();
+    bool hasDamage() { return !m_damagedRects.empty(); }
+    void addDrawnWidget() { m_drawnWidgets++; }
+
+    void setPartialRedraw(bool enable);
+    bool isPartialRedraw() { return m_partialRedraw; }
+    uint64 getFullRedraws() { return m_fullRedraws; }
+    uint64 getPartialRedraws() { return m_partialRedraws; }
+    uint64 getDamagedRects() { return m_damagedRectsDrawn; }
+    uint64 getDrawnWidgets() { return m_drawnWidgets; }
+    void resetRenderStats();
+
     void clearStyles();
     bool importStyle(std::string file);
     void importStyleFromOTML(const OTMLNodePtr& styleNode);
     OTMLNodePtr getStyle(const std::string& styleName);
+    UIStateStylePtr getStateStyle(const OTMLNodePtr& styleNode);
     std::string getStyleClass(const std::string& styleName);
 
     UIWidgetPtr loadUI(std::string file, const UIWidgetPtr& parent);
@@ -87,6 +107,14 @@ private:
     stdext::boolean<false> m_hoverUpdateScheduled;
     stdext::boolean<false> m_drawDebugBoxes;
     std::unordered_map<std::string, OTMLNodePtr> m_styles;
+    std::unordered_map<std::string, UIStateStylePtr> m_stateStyles;
+    std::vector<Rect> m_damagedRects;
+    std::unordered_map<UIWidget*, Rect> m_overflowRects;
+    stdext::boolean<true> m_partialRedraw;
+    uint64 m_fullRedraws;
+    uint64 m_partialRedraws;
+    uint64 m_damagedRectsDrawn;
+    uint64 m_drawnWidgets;
     UIWidgetList m_destroyedWidgets;
     ScheduledEventPtr m_checkEvent;
 
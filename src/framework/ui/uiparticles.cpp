@@ -32,6 +32,7 @@ void UIParticles::drawSelf(Fw::DrawPane drawPane)
 {
     if(drawPane & Fw::ForegroundPane) {
         if(drawPane != Fw::BothPanes) {
+            g_painter->flush();
             glDisable(GL_BLEND);
             g_painter->setColor(Color::alpha);
             g_painter->drawFilledRect(m_rect);
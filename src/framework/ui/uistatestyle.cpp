@@ -0,0 +1,176 @@
+/*
+ * Copyright (c) 2010-2013 OTClient <https://github.com/edubart/otclient>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "uistatestyle.h"
+#include "uitranslator.h"
+
+#include <framework/otml/otmlnode.h>
+
+static bool isSameNode(const OTMLNodePtr& a, const OTMLNodePtr& b)
+{
+    if(!a || !b)
+        return a == b;
+    if(a->tag() != b->tag() || a->rawValue() != b->rawValue() || a->isUnique() != b->isUnique())
+        return false;
+
+    OTMLNodeList aChildren = a->children();
+    OTMLNodeList bChildren = b->children();
+    if(aChildren.size() != bChildren.size())
+        return false;
+    for(uint i = 0; i < aChildren.size(); ++i) {
+        if(!isSameNode(aChildren[i], bChildren[i]))
+            return false;
+    }
+    return true;
+}
+
+UIStateStyle::UIStateStyle(const OTMLNodePtr& styleNode)
+{
+    m_stateMask = 0;
+
+    for(const OTMLNodePtr& style : styleNode->children()) {
+        if(!stdext::starts_with(style->tag(), "$"))
+            continue;
+
+        m_ruleNodes.push_back(style);
+
+        Rule rule;
+        rule.on = 0;
+        rule.off = 0;
+        rule.node = style;
+
+        bool valid = true;
+        for(std::string stateStr : stdext::split(style->tag().substr(1), " ")) {
+            if(stateStr.length() == 0)
+                continue;
+
+            bool notstate = (stateStr[0] == '!');
+            if(notstate)
+                stateStr = stateStr.substr(1);
+
+            // unknown states are never on
+            Fw::WidgetState state = Fw::translateState(stateStr);
+            if(state == Fw::InvalidState) {
+                if(!notstate)
+                    valid = false;
+                continue;
+            }
+
+            if(notstate)
+                rule.off |= state;
+            else
+                rule.on |= state;
+        }
+
+        if(!valid)
+            continue;
+
+        m_stateMask |= rule.on | rule.off;
+        for(const OTMLNodePtr& node : style->children())
+            m_defaults[node->tag()] = styleNode->get(node->tag());
+        m_rules.push_back(rule);
+    }
+}
+
+bool UIStateStyle::isCompatible(const OTMLNodePtr& styleNode)
+{
+    uint index = 0;
+    for(const OTMLNodePtr& style : styleNode->children()) {
+        if(!stdext::starts_with(style->tag(), "$"))
+            continue;
+        if(index >= m_ruleNodes.size() || !isSameNode(style, m_ruleNodes[index]))
+            return false;
+        index++;
+    }
+    if(index != m_ruleNodes.size())
+        return false;
+
+    for(auto& it : m_defaults) {
+        if(!isSameNode(styleNode->get(it.first), it.second))
+            return false;
+    }
+    return true;
+}
+
+OTMLNodePtr UIStateStyle::getStyle(int states)
+{
+    states &= m_stateMask;
+
+    auto it = m_styles.find(states);
+    if(it != m_styles.end())
+        return it->second;
+
+    OTMLNodePtr style = OTMLNode::create();
+    for(const Rule& rule : m_rules) {
+        if((states & rule.on) == rule.on && (states & rule.off) == 0)
+            style->merge(rule.node);
+    }
+    m_styles[states] = style;
+    return style;
+}
+
+OTMLNodePtr UIStateStyle::getTransition(int fromStates, int toStates)
+{
+    if(fromStates >= 0)
+        fromStates &= m_stateMask;
+    toStates &= m_stateMask;
+
+    uint64 key = ((uint64)(uint32)fromStates << 32) | (uint32)toStates;
+    auto it = m_transitions.find(key);
+    if(it == m_transitions.end()) {
+        OTMLNodePtr fromStyle = fromStates >= 0 ? getStyle(fromStates) : nullptr;
+        OTMLNodePtr toStyle = getStyle(toStates);
+
+        Transition transition;
+        transition.node = OTMLNode::create(toStyle->tag());
+        transition.dynamic = false;
+
+        // restore the defaults of properties no longer set by a state
+        if(fromStyle) {
+            for(const OTMLNodePtr& node : fromStyle->children()) {
+                if(toStyle->get(node->tag()))
+                    continue;
+                auto it = m_defaults.find(node->tag());
+                if(it != m_defaults.end() && it->second)
+                    transition.node->addChild(it->second->clone());
+            }
+        }
+
+        for(const OTMLNodePtr& node : toStyle->children()) {
+            if(fromStyle && isSameNode(fromStyle->get(node->tag()), node))
+                continue;
+            transition.node->addChild(node->clone());
+        }
+
+        for(const OTMLNodePtr& node : transition.node->children()) {
+            if(stdext::starts_with(node->tag(), "!"))
+                transition.dynamic = true;
+        }
+
+        it = m_transitions.insert(std::make_pair(key, transition)).first;
+    }
+
+    // lua evaluated properties are translated in place when applied, so they need a fresh copy every time
+    if(it->second.dynamic)
+        return it->second.node->clone();
+    return it->second.node;
+}
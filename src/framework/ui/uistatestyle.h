@@ -0,0 +1,64 @@
+/*
+ * Copyright (c) 2010-2013 OTClient <https://github.com/edubart/otclient>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef UISTATESTYLE_H
+#define UISTATESTYLE_H
+
+#include "declarations.h"
+#include <framework/otml/declarations.h>
+
+// Compiled "$state" rules of a style, resolving state transitions into the properties that actually change
+class UIStateStyle : public stdext::shared_object
+{
+public:
+    UIStateStyle(const OTMLNodePtr& styleNode);
+
+    bool isCompatible(const OTMLNodePtr& styleNode);
+    bool isEmpty() { return m_rules.empty(); }
+
+    // only these states are referenced by the rules, changes on others never affect the style
+    int getStateMask() { return m_stateMask; }
+
+    OTMLNodePtr getStyle(int states);
+    OTMLNodePtr getTransition(int fromStates, int toStates);
+
+private:
+    struct Rule {
+        int on;
+        int off;
+        OTMLNodePtr node;
+    };
+
+    struct Transition {
+        OTMLNodePtr node;
+        bool dynamic;
+    };
+
+    std::vector<Rule> m_rules;
+    OTMLNodeList m_ruleNodes;
+    std::unordered_map<std::string, OTMLNodePtr> m_defaults;
+    std::unordered_map<int, OTMLNodePtr> m_styles;
+    std::unordered_map<uint64, Transition> m_transitions;
+    int m_stateMask;
+};
+
+#endif
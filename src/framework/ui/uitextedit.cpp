@@ -118,6 +118,9 @@ void UITextEdit::drawSelf(Fw::DrawPane drawPane)
         } else if(elapsed >= 2*delay) {
             m_cursorTicks = g_clock.millis();
         }
+
+        // keep redrawing while the cursor blinks
+        repaint();
     }
 
     g_painter->resetColor();
@@ -328,7 +331,7 @@ void UITextEdit::update(bool focusCursor)
     if(fireAreaUpdate)
         onTextAreaUpdate(m_textVirtualOffset, m_textVirtualSize, m_textTotalSize);
 
-    g_app.repaint();
+    repaint();
 }
 
 void UITextEdit::setCursorPos(int pos)
@@ -450,7 +453,7 @@ void UITextEdit::removeCharacter(bool right)
 void UITextEdit::blinkCursor()
 {
     m_cursorTicks = g_clock.millis();
-    g_app.repaint();
+    repaint();
 }
 
 void UITextEdit::del(bool right)
@@ -24,6 +24,7 @@
 #include "uimanager.h"
 #include "uianchorlayout.h"
 #include "uitranslator.h"
+#include "uistatestyle.h"
 
 #include <framework/core/eventdispatcher.h>
 #include <framework/otml/otmlnode.h>
@@ -37,6 +38,7 @@ UIWidget::UIWidget()
 {
     m_lastFocusReason = Fw::ActiveFocusReason;
     m_states = Fw::DefaultState;
+    m_appliedStates = Fw::DefaultState;
     m_autoFocusPolicy = Fw::AutoFocusLast;
     m_clickTimer.stop();
     m_autoRepeatDelay = 500;
@@ -57,6 +59,8 @@ UIWidget::~UIWidget()
 
 void UIWidget::draw(const Rect& visibleRect, Fw::DrawPane drawPane)
 {
+    g_ui.addDrawnWidget();
+
     Rect oldClipRect;
     if(m_clipping) {
         oldClipRect = g_painter->getClipRect();
@@ -173,6 +177,7 @@ void UIWidget::addChild(const UIWidgetPtr& child)
         oldLastChild->updateState(Fw::LastState);
     }
 
+    child->repaint();
     g_ui.onWidgetAppear(child);
 }
 
@@ -211,6 +216,7 @@ void UIWidget::insertChild(int index, const UIWidgetPtr& child)
     child->updateStates();
     updateChildrenIndexStates();
 
+    child->repaint();
     g_ui.onWidgetAppear(child);
 }
 
@@ -228,6 +234,9 @@ void UIWidget::removeChild(UIWidgetPtr child)
         if(isChildLocked(child))
             unlockChild(child);
 
+        // damage where the child was drawn while it still belongs to this widget
+        child->repaint();
+
         auto it = std::find(m_children.begin(), m_children.end(), child);
         m_children.erase(it);
 
@@ -389,6 +398,7 @@ void UIWidget::lowerChild(UIWidgetPtr child)
     m_children.erase(it);
     m_children.push_front(child);
     updateChildrenIndexStates();
+    child->repaint();
 }
 
 void UIWidget::raiseChild(UIWidgetPtr child)
@@ -408,6 +418,7 @@ void UIWidget::raiseChild(UIWidgetPtr child)
     m_children.erase(it);
     m_children.push_back(child);
     updateChildrenIndexStates();
+    child->repaint();
 }
 
 void UIWidget::moveChildToIndex(const UIWidgetPtr& child, int index)
@@ -433,6 +444,7 @@ void UIWidget::moveChildToIndex(const UIWidgetPtr& child, int index)
     m_children.insert(m_children.begin() + index - 1, child);
     updateChildrenIndexStates();
     updateLayout();
+    child->repaint();
 }
 
 void UIWidget::lockChild(const UIWidgetPtr& child)
@@ -520,7 +532,7 @@ void UIWidget::mergeStyle(const OTMLNodePtr& styleNode)
     m_style->merge(styleNode);
     m_style->setTag(name);
     m_style->setSource(source);
-    updateStyle();
+    reapplyStateStyle();
 }
 
 void UIWidget::applyStyle(const OTMLNodePtr& styleNode)
@@ -548,7 +560,8 @@ void UIWidget::applyStyle(const OTMLNodePtr& styleNode)
         }
 
         onStyleApply(styleNode->tag(), styleNode);
-        callLuaField("onStyleApply", styleNode->tag(), styleNode);
+        static const int onStyleApplyField = g_lua.internKey("onStyleApply");
+        callLuaField(onStyleApplyField, styleNode->tag(), styleNode);
 
         if(m_firstOnStyle) {
             UIWidgetPtr parent = getParent();
@@ -903,6 +916,67 @@ bool UIWidget::setRect(const Rect& rect)
     return true;
 }
 
+void UIWidget::repaint()
+{
+    // rotated widgets may draw anywhere
+    if(m_rotation != 0.0f) {
+        g_app.repaint();
+        return;
+    }
+
+    // damage where the widget was drawn and where it will be drawn now
+    Rect oldDrawnRect = m_drawnRect;
+    updateDrawnRect();
+
+    if(oldDrawnRect.isValid())
+        g_ui.invalidate(oldDrawnRect);
+    g_ui.invalidate(m_drawnRect.isValid() ? m_drawnRect : m_rect);
+}
+
+void UIWidget::updateDrawnRect()
+{
+    // images, icons and text can be offset outside the rect, unclipped children too
+    Rect drawnRect;
+    if(m_visible && m_rect.isValid()) {
+        drawnRect = m_rect;
+
+        if(m_imageTexture) {
+            Rect imageRect = m_rect.translated(m_imageRect.topLeft());
+            if(m_imageRect.isValid())
+                imageRect.resize(m_imageRect.size());
+            if(imageRect.isValid())
+                drawnRect |= imageRect;
+        }
+
+        if(m_icon) {
+            Rect iconRect = getIconDrawRect(m_rect);
+            if(iconRect.isValid())
+                drawnRect |= iconRect;
+        }
+
+        Rect textRect(m_rect.topLeft() + m_textOffset, m_rect.bottomRight());
+        if(!m_drawText.empty() && textRect.isValid())
+            drawnRect |= textRect;
+
+        if(!m_clipping) {
+            for(const UIWidgetPtr& child : m_children) {
+                if(child->m_drawnRect.isValid() && child->getRect().intersects(m_rect))
+                    drawnRect |= child->m_drawnRect;
+            }
+        }
+    }
+
+    if(drawnRect == m_drawnRect)
+        return;
+    m_drawnRect = drawnRect;
+
+    g_ui.setOverflowRect(this, drawnRect != m_rect ? drawnRect : Rect());
+
+    // an unclipped parent draws whatever its children draw
+    if(m_parent && !m_parent->isClipping())
+        m_parent->updateDrawnRect();
+}
+
 void UIWidget::setStyle(const std::string& styleName)
 {
     OTMLNodePtr styleNode = g_ui.getStyle(styleName);
@@ -913,14 +987,14 @@ void UIWidget::setStyle(const std::string& styleName)
     styleNode = styleNode->clone();
     applyStyle(styleNode);
     m_style = styleNode;
-    updateStyle();
+    reapplyStateStyle();
 }
 
 void UIWidget::setStyleFromNode(const OTMLNodePtr& styleNode)
 {
     applyStyle(styleNode);
     m_style = styleNode;
-    updateStyle();
+    reapplyStateStyle();
 }
 
 void UIWidget::setEnabled(bool enabled)
@@ -955,6 +1029,8 @@ void UIWidget::setVisible(bool visible)
             g_ui.onWidgetAppear(static_self_cast<UIWidget>());
         else
             g_ui.onWidgetDisappear(static_self_cast<UIWidget>());
+
+        repaint();
     }
 }
 
@@ -1397,6 +1473,14 @@ void UIWidget::updateChildrenIndexStates()
     }
 }
 
+void UIWidget::reapplyStateStyle()
+{
+    // the base style was just applied over the properties of the active states, so they are set again in full
+    m_stateStyle = nullptr;
+    m_appliedStateStyle = nullptr;
+    updateStyle();
+}
+
 void UIWidget::updateStyle()
 {
     if(m_destroyed)
@@ -1415,47 +1499,34 @@ void UIWidget::updateStyle()
     if(!m_style)
         return;
 
-    OTMLNodePtr newStateStyle = OTMLNode::create();
-
-    // copy only the changed styles from default style
-    if(m_stateStyle) {
-        for(OTMLNodePtr node : m_stateStyle->children()) {
-            if(OTMLNodePtr otherNode = m_style->get(node->tag()))
-                newStateStyle->addChild(otherNode->clone());
-        }
-    }
-
-    // checks for states combination
-    for(const OTMLNodePtr& style : m_style->children()) {
-        if(stdext::starts_with(style->tag(), "$")) {
-            std::string statesStr = style->tag().substr(1);
-            std::vector<std::string> statesSplit = stdext::split(statesStr, " ");
-
-            bool match = true;
-            for(std::string stateStr : statesSplit) {
-                if(stateStr.length() == 0)
-                    continue;
+    if(!m_stateStyle)
+        m_stateStyle = g_ui.getStateStyle(m_style);
 
-                bool notstate = (stateStr[0] == '!');
-                if(notstate)
-                    stateStr = stateStr.substr(1);
+    int states = m_states & m_stateStyle->getStateMask();
+    OTMLNodePtr newStateStyle;
 
-                bool stateOn = hasState(Fw::translateState(stateStr));
-                if((!notstate && !stateOn) || (notstate && stateOn))
-                    match = false;
-            }
+    if(m_appliedStateStyle == m_stateStyle) {
+        // none of the states used by the style changed
+        if(states == m_appliedStates)
+            return;
+        newStateStyle = m_stateStyle->getTransition(m_appliedStates, states);
+    } else {
+        newStateStyle = OTMLNode::create();
 
-            // merge states styles
-            if(match) {
-                newStateStyle->merge(style);
+        // the style itself changed, copy the defaults of everything the last state style had set
+        if(m_appliedStateStyle) {
+            for(const OTMLNodePtr& node : m_appliedStateStyle->getStyle(m_appliedStates)->children()) {
+                if(OTMLNodePtr otherNode = m_style->get(node->tag()))
+                    newStateStyle->addChild(otherNode->clone());
             }
         }
-    }
 
-    //TODO: prevent setting already set proprieties
+        newStateStyle->merge(m_stateStyle->getTransition(-1, states));
+    }
 
+    m_appliedStateStyle = m_stateStyle;
+    m_appliedStates = states;
     applyStyle(newStateStyle);
-    m_stateStyle = newStateStyle;
 }
 
 void UIWidget::onStyleApply(const std::string& styleName, const OTMLNodePtr& styleNode)
@@ -1471,7 +1542,7 @@ void UIWidget::onStyleApply(const std::string& styleName, const OTMLNodePtr& sty
     parseImageStyle(styleNode);
     parseTextStyle(styleNode);
 
-    g_app.repaint();
+    repaint();
 }
 
 void UIWidget::onGeometryChange(const Rect& oldRect, const Rect& newRect)
@@ -1485,9 +1556,11 @@ void UIWidget::onGeometryChange(const Rect& oldRect, const Rect& newRect)
             child->bindRectToParent();
     }
 
-    callLuaField("onGeometryChange", oldRect, newRect);
+    static const int onGeometryChangeField = g_lua.internKey("onGeometryChange");
+    callLuaField(onGeometryChangeField, oldRect, newRect);
 
-    g_app.repaint();
+    g_ui.invalidate(oldRect);
+    repaint();
 }
 
 void UIWidget::onLayoutUpdate()
@@ -1507,7 +1580,8 @@ void UIWidget::onChildFocusChange(const UIWidgetPtr& focusedChild, const UIWidge
 
 void UIWidget::onHoverChange(bool hovered)
 {
-    callLuaField("onHoverChange", hovered);
+    static const int onHoverChangeField = g_lua.internKey("onHoverChange");
+    callLuaField(onHoverChangeField, hovered);
 }
 
 void UIWidget::onVisibilityChange(bool visible)
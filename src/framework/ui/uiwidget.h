@@ -93,6 +93,7 @@ public:
     void unlockChild(const UIWidgetPtr& child);
     void mergeStyle(const OTMLNodePtr& styleNode);
     void applyStyle(const OTMLNodePtr& styleNode);
+    void repaint();
     void addAnchor(Fw::AnchorEdge anchoredEdge, const std::string& hookedWidgetId, Fw::AnchorEdge hookedEdge);
     void removeAnchor(Fw::AnchorEdge anchoredEdge);
     void fill(const std::string& hookedWidgetId);
@@ -128,7 +129,7 @@ public:
     void setPhantom(bool phantom);
     void setDraggable(bool draggable);
     void setFixedSize(bool fixed);
-    void setClipping(bool clipping) { m_clipping = clipping; }
+    void setClipping(bool clipping) { m_clipping = clipping; repaint(); }
     void setLastFocusReason(Fw::FocusReason reason);
     void setAutoFocusPolicy(Fw::AutoFocusPolicy policy);
     void setAutoRepeatDelay(int delay) { m_autoRepeatDelay = delay; }
@@ -171,10 +172,15 @@ private:
     void updateStates();
     void updateChildrenIndexStates();
     void updateStyle();
+    void reapplyStateStyle();
+    void updateDrawnRect();
 
+    Rect m_drawnRect;
     stdext::boolean<false> m_updateStyleScheduled;
     stdext::boolean<true> m_firstOnStyle;
-    OTMLNodePtr m_stateStyle;
+    UIStateStylePtr m_stateStyle;
+    UIStateStylePtr m_appliedStateStyle;
+    int m_appliedStates;
     int m_states;
 
 
@@ -277,6 +283,7 @@ protected:
     void drawBackground(const Rect& screenCoords);
     void drawBorder(const Rect& screenCoords);
     void drawIcon(const Rect& screenCoords);
+    Rect getIconDrawRect(const Rect& screenCoords);
 
     Color m_color;
     Color m_backgroundColor;
@@ -302,36 +309,36 @@ public:
     void setHeight(int height) { resize(getWidth(), height); }
     void setSize(const Size& size) { resize(size.width(), size.height()); }
     void setPosition(const Point& pos) { move(pos.x, pos.y); }
-    void setColor(const Color& color) { m_color = color; }
-    void setBackgroundColor(const Color& color) { m_backgroundColor = color; }
-    void setBackgroundOffsetX(int x) { m_backgroundRect.setX(x); }
-    void setBackgroundOffsetY(int y) { m_backgroundRect.setX(y); }
-    void setBackgroundOffset(const Point& pos) { m_backgroundRect.move(pos); }
-    void setBackgroundWidth(int width) { m_backgroundRect.setWidth(width); }
-    void setBackgroundHeight(int height) { m_backgroundRect.setHeight(height); }
-    void setBackgroundSize(const Size& size) { m_backgroundRect.resize(size); }
-    void setBackgroundRect(const Rect& rect) { m_backgroundRect = rect; }
+    void setColor(const Color& color) { m_color = color; repaint(); }
+    void setBackgroundColor(const Color& color) { m_backgroundColor = color; repaint(); }
+    void setBackgroundOffsetX(int x) { m_backgroundRect.setX(x); repaint(); }
+    void setBackgroundOffsetY(int y) { m_backgroundRect.setX(y); repaint(); }
+    void setBackgroundOffset(const Point& pos) { m_backgroundRect.move(pos); repaint(); }
+    void setBackgroundWidth(int width) { m_backgroundRect.setWidth(width); repaint(); }
+    void setBackgroundHeight(int height) { m_backgroundRect.setHeight(height); repaint(); }
+    void setBackgroundSize(const Size& size) { m_backgroundRect.resize(size); repaint(); }
+    void setBackgroundRect(const Rect& rect) { m_backgroundRect = rect; repaint(); }
     void setIcon(const std::string& iconFile);
-    void setIconColor(const Color& color) { m_iconColor = color; }
-    void setIconOffsetX(int x) { m_iconOffset.x = x; }
-    void setIconOffsetY(int y) { m_iconOffset.y = y; }
-    void setIconOffset(const Point& pos) { m_iconOffset = pos; }
-    void setIconWidth(int width) { m_iconRect.setWidth(width); }
-    void setIconHeight(int height) { m_iconRect.setHeight(height); }
-    void setIconSize(const Size& size) { m_iconRect.resize(size); }
-    void setIconRect(const Rect& rect) { m_iconRect = rect; }
-    void setIconClip(const Rect& rect) { m_iconClipRect = rect; }
-    void setIconAlign(Fw::AlignmentFlag align) { m_iconAlign = align; }
-    void setBorderWidth(int width) { m_borderWidth.set(width); updateLayout(); }
-    void setBorderWidthTop(int width) { m_borderWidth.top = width; }
-    void setBorderWidthRight(int width) { m_borderWidth.right = width; }
-    void setBorderWidthBottom(int width) { m_borderWidth.bottom = width; }
-    void setBorderWidthLeft(int width) { m_borderWidth.left = width; }
-    void setBorderColor(const Color& color) { m_borderColor.set(color); updateLayout(); }
-    void setBorderColorTop(const Color& color) { m_borderColor.top = color; }
-    void setBorderColorRight(const Color& color) { m_borderColor.right = color; }
-    void setBorderColorBottom(const Color& color) { m_borderColor.bottom = color; }
-    void setBorderColorLeft(const Color& color) { m_borderColor.left = color; }
+    void setIconColor(const Color& color) { m_iconColor = color; repaint(); }
+    void setIconOffsetX(int x) { m_iconOffset.x = x; repaint(); }
+    void setIconOffsetY(int y) { m_iconOffset.y = y; repaint(); }
+    void setIconOffset(const Point& pos) { m_iconOffset = pos; repaint(); }
+    void setIconWidth(int width) { m_iconRect.setWidth(width); repaint(); }
+    void setIconHeight(int height) { m_iconRect.setHeight(height); repaint(); }
+    void setIconSize(const Size& size) { m_iconRect.resize(size); repaint(); }
+    void setIconRect(const Rect& rect) { m_iconRect = rect; repaint(); }
+    void setIconClip(const Rect& rect) { m_iconClipRect = rect; repaint(); }
+    void setIconAlign(Fw::AlignmentFlag align) { m_iconAlign = align; repaint(); }
+    void setBorderWidth(int width) { m_borderWidth.set(width); updateLayout(); repaint(); }
+    void setBorderWidthTop(int width) { m_borderWidth.top = width; repaint(); }
+    void setBorderWidthRight(int width) { m_borderWidth.right = width; repaint(); }
+    void setBorderWidthBottom(int width) { m_borderWidth.bottom = width; repaint(); }
+    void setBorderWidthLeft(int width) { m_borderWidth.left = width; repaint(); }
+    void setBorderColor(const Color& color) { m_borderColor.set(color); updateLayout(); repaint(); }
+    void setBorderColorTop(const Color& color) { m_borderColor.top = color; repaint(); }
+    void setBorderColorRight(const Color& color) { m_borderColor.right = color; repaint(); }
+    void setBorderColorBottom(const Color& color) { m_borderColor.bottom = color; repaint(); }
+    void setBorderColorLeft(const Color& color) { m_borderColor.left = color; repaint(); }
     void setMargin(int margin) { m_margin.set(margin); updateParentLayout(); }
     void setMarginHorizontal(int margin) { m_margin.right = m_margin.left = margin; updateParentLayout(); }
     void setMarginVertical(int margin) { m_margin.bottom = m_margin.top = margin; updateParentLayout(); }
@@ -339,15 +346,15 @@ public:
     void setMarginRight(int margin) { m_margin.right = margin; updateParentLayout(); }
     void setMarginBottom(int margin) { m_margin.bottom = margin; updateParentLayout(); }
     void setMarginLeft(int margin) { m_margin.left = margin; updateParentLayout(); }
-    void setPadding(int padding) { m_padding.top = m_padding.right = m_padding.bottom = m_padding.left = padding; updateLayout(); }
-    void setPaddingHorizontal(int padding) { m_padding.right = m_padding.left = padding; updateLayout(); }
-    void setPaddingVertical(int padding) { m_padding.bottom = m_padding.top = padding; updateLayout(); }
-    void setPaddingTop(int padding) { m_padding.top = padding; updateLayout(); }
-    void setPaddingRight(int padding) { m_padding.right = padding; updateLayout(); }
-    void setPaddingBottom(int padding) { m_padding.bottom = padding; updateLayout(); }
-    void setPaddingLeft(int padding) { m_padding.left = padding; updateLayout(); }
-    void setOpacity(float opacity) { m_opacity = std::min(std::max(opacity, 0.0f), 1.0f); }
-    void setRotation(float degrees) { m_rotation = degrees; }
+    void setPadding(int padding) { m_padding.top = m_padding.right = m_padding.bottom = m_padding.left = padding; updateLayout(); repaint(); }
+    void setPaddingHorizontal(int padding) { m_padding.right = m_padding.left = padding; updateLayout(); repaint(); }
+    void setPaddingVertical(int padding) { m_padding.bottom = m_padding.top = padding; updateLayout(); repaint(); }
+    void setPaddingTop(int padding) { m_padding.top = padding; updateLayout(); repaint(); }
+    void setPaddingRight(int padding) { m_padding.right = padding; updateLayout(); repaint(); }
+    void setPaddingBottom(int padding) { m_padding.bottom = padding; updateLayout(); repaint(); }
+    void setPaddingLeft(int padding) { m_padding.left = padding; updateLayout(); repaint(); }
+    void setOpacity(float opacity) { m_opacity = std::min(std::max(opacity, 0.0f), 1.0f); repaint(); }
+    void setRotation(float degrees) { repaint(); m_rotation = degrees; repaint(); }
 
     int getX() { return m_rect.x(); }
     int getY() { return m_rect.y(); }
@@ -400,7 +407,7 @@ private:
     void initImage();
     void parseImageStyle(const OTMLNodePtr& styleNode);
 
-    void updateImageCache() { m_imageMustRecache = true; }
+    void updateImageCache() { m_imageMustRecache = true; repaint(); }
     void configureBorderImage() { m_imageBordered = true; updateImageCache(); }
 
     CoordsBuffer m_imageCoordsBuffer;
@@ -435,7 +442,7 @@ public:
     void setImageColor(const Color& color) { m_imageColor = color; updateImageCache(); }
     void setImageFixedRatio(bool fixedRatio) { m_imageFixedRatio = fixedRatio; updateImageCache(); }
     void setImageRepeated(bool repeated) { m_imageRepeated = repeated; updateImageCache(); }
-    void setImageSmooth(bool smooth) { m_imageSmooth = smooth; }
+    void setImageSmooth(bool smooth) { m_imageSmooth = smooth; repaint(); }
     void setImageAutoResize(bool autoResize) { m_imageAutoResize = autoResize; }
     void setImageBorderTop(int border) { m_imageBorder.top = border; configureBorderImage(); }
     void setImageBorderRight(int border) { m_imageBorder.right = border; configureBorderImage(); }
@@ -380,23 +380,32 @@ void UIWidget::drawBorder(const Rect& screenCoords)
 void UIWidget::drawIcon(const Rect& screenCoords)
 {
     if(m_icon) {
-        Rect drawRect;
-        if(m_iconRect.isValid()) {
-            drawRect = screenCoords;
-            drawRect.translate(m_iconRect.topLeft());
-            drawRect.resize(m_iconRect.size());
-        } else {
-            drawRect.resize(m_iconClipRect.size());
-
-            if(m_iconAlign == Fw::AlignNone)
-                drawRect.moveCenter(screenCoords.center());
-            else
-                drawRect.alignIn(screenCoords, m_iconAlign);
-        }
-        drawRect.translate(m_iconOffset);
         g_painter->setColor(m_iconColor);
-        g_painter->drawTexturedRect(drawRect, m_icon, m_iconClipRect);
+        g_painter->drawTexturedRect(getIconDrawRect(screenCoords), m_icon, m_iconClipRect);
+
+        // animated icons change without notice, the next frame must draw them again
+        if(m_icon->isAnimatedTexture())
+            repaint();
+    }
+}
+
+Rect UIWidget::getIconDrawRect(const Rect& screenCoords)
+{
+    Rect drawRect;
+    if(m_iconRect.isValid()) {
+        drawRect = screenCoords;
+        drawRect.translate(m_iconRect.topLeft());
+        drawRect.resize(m_iconRect.size());
+    } else {
+        drawRect.resize(m_iconClipRect.size());
+
+        if(m_iconAlign == Fw::AlignNone)
+            drawRect.moveCenter(screenCoords.center());
+        else
+            drawRect.alignIn(screenCoords, m_iconAlign);
     }
+    drawRect.translate(m_iconOffset);
+    return drawRect;
 }
 
 void UIWidget::setIcon(const std::string& iconFile)
@@ -407,4 +416,5 @@ void UIWidget::setIcon(const std::string& iconFile)
         m_icon = g_textures.getTexture(iconFile);
     if(m_icon && !m_iconClipRect.isValid())
         m_iconClipRect = Rect(0, 0, m_icon->getSize());
+    repaint();
 }
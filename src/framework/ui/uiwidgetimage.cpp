@@ -173,6 +173,10 @@ void UIWidget::drawImage(const Rect& screenCoords)
 
     g_painter->setColor(m_imageColor);
     g_painter->drawTextureCoords(m_imageCoordsBuffer, m_imageTexture);
+
+    // animated images change without notice, the next frame must draw them again
+    if(m_imageTexture->isAnimatedTexture())
+        repaint();
 }
 
 void UIWidget::setImageSource(const std::string& source)
@@ -192,5 +196,5 @@ void UIWidget::setImageSource(const std::string& source)
         setSize(size);
     }
 
-    m_imageMustRecache = true;
+    updateImageCache();
 }
@@ -103,7 +103,7 @@ void UIWidget::drawText(const Rect& screenCoords)
 
 void UIWidget::onTextChange(const std::string& text, const std::string& oldText)
 {
-    g_app.repaint();
+    repaint();
     callLuaField("onTextChange", text, oldText);
 }
 
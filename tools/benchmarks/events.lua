@@ -0,0 +1,80 @@
+-- Event dispatcher checks and benchmark
+-- run it from the client terminal with: dofile('/tools/benchmarks/events.lua')
+-- about 100k events are posted, scheduled, cycled and canceled, the results are printed after a couple of seconds
+
+local EVENTS = 100000
+local CYCLE_EVENTS = 10000
+local MAX_DELAY = 1000
+
+local function rate(count, elapsed)
+  return count / math.max(elapsed, 1e-9)
+end
+
+-- immediate events
+local executed = 0
+local postStart = os.clock()
+for i = 1, EVENTS do
+  addEvent(function() executed = executed + 1 end)
+end
+local postTime = os.clock() - postStart
+
+-- scheduled events spread over a second, every other one is canceled before it runs
+local fired, canceledFired = 0, 0
+local scheduled = {}
+local scheduleStart = os.clock()
+for i = 1, EVENTS do
+  local canceled = i % 2 == 0
+  scheduled[i] = scheduleEvent(function()
+    if canceled then
+      canceledFired = canceledFired + 1
+    else
+      fired = fired + 1
+    end
+  end, i % MAX_DELAY + 1)
+end
+local scheduleTime = os.clock() - scheduleStart
+
+local cancelStart = os.clock()
+for i = 2, EVENTS, 2 do
+  removeEvent(scheduled[i])
+end
+local cancelTime = os.clock() - cancelStart
+scheduled = nil
+
+-- cycle events keep running until they are canceled
+local cycles, cyclesAfterCancel = 0, 0
+local cycleCanceled = false
+local cycleEvents = {}
+for i = 1, CYCLE_EVENTS do
+  cycleEvents[i] = cycleEvent(function()
+    if cycleCanceled then
+      cyclesAfterCancel = cyclesAfterCancel + 1
+    else
+      cycles = cycles + 1
+    end
+  end, i % 100 + 10)
+end
+
+scheduleEvent(function()
+  local cycleCancelStart = os.clock()
+  for i = 1, CYCLE_EVENTS do
+    removeEvent(cycleEvents[i])
+  end
+  local cycleCancelTime = os.clock() - cycleCancelStart
+  cycleCanceled = true
+  cycleEvents = nil
+
+  scheduleEvent(function()
+    assert(executed == EVENTS, string.format('%d of %d immediate events ran', executed, EVENTS))
+    assert(fired == EVENTS / 2, string.format('%d of %d scheduled events ran', fired, EVENTS / 2))
+    assert(canceledFired == 0, string.format('%d canceled scheduled events ran', canceledFired))
+    assert(cycles > 0, 'no cycle event ran')
+    assert(cyclesAfterCancel == 0, string.format('canceled cycle events ran %d more times', cyclesAfterCancel))
+
+    print(string.format('%d events ran as expected, %d cycles before canceling', EVENTS + EVENTS / 2, cycles))
+    print(string.format('  post %.0f events/s', rate(EVENTS, postTime)))
+    print(string.format('  schedule %.0f events/s', rate(EVENTS, scheduleTime)))
+    print(string.format('  cancel %.0f events/s', rate(EVENTS / 2, cancelTime)))
+    print(string.format('  cancel cycles %.0f events/s', rate(CYCLE_EVENTS, cycleCancelTime)))
+  end, 500)
+end, MAX_DELAY + 500)
@@ -0,0 +1,63 @@
+-- Lua to C++ call benchmark
+-- run it from the client terminal with: dofile('/tools/benchmarks/luacalls.lua')
+-- measures method calls, field accesses and callbacks on a hidden UIWidget
+
+local CALLS = 1000000
+local CALLBACKS = 100000
+
+local widget = g_ui.createWidget('UIWidget', rootWidget)
+widget:setVisible(false)
+widget:setId('luacallsBenchmark')
+widget.counter = 0
+
+local function measure(count, fn)
+  local start = os.clock()
+  fn(count)
+  local elapsed = os.clock() - start
+  return count / elapsed, elapsed * 1e9 / count
+end
+
+local function report(name, perSecond, nanos)
+  print(string.format('  %s %.0f/s (%.0f ns)', name, perSecond, nanos))
+end
+
+print('lua calls on a UIWidget')
+
+-- a bound C++ method resolved through the class metatable
+report('method call', measure(CALLS, function(count)
+  for i = 1, count do
+    widget:getId()
+  end
+end))
+
+-- fields live in the per-object fields table, reads go through __index and writes through __newindex
+report('field read', measure(CALLS, function(count)
+  local value
+  for i = 1, count do
+    value = widget.counter
+  end
+end))
+
+report('field write', measure(CALLS, function(count)
+  for i = 1, count do
+    widget.counter = i
+  end
+end))
+
+-- a callback is a C++ to lua call made while running a lua to C++ one, its cost is the difference
+-- between resizing the widget with and without an onGeometryChange handler
+local function resize(count)
+  for i = 1, count do
+    widget:setWidth(i % 2 + 1)
+  end
+end
+local _, plainNanos = measure(CALLBACKS, resize)
+
+local called = 0
+widget.onGeometryChange = function() called = called + 1 end
+local _, callbackNanos = measure(CALLBACKS, resize)
+assert(called == CALLBACKS, string.format('onGeometryChange ran %d times for %d resizes', called, CALLBACKS))
+
+print(string.format('  callback dispatch %.0f ns', math.max(callbackNanos - plainNanos, 0)))
+
+widget:destroy()
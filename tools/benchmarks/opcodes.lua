@@ -0,0 +1,39 @@
+-- Opcode dispatch replay benchmark
+-- run it from the client terminal with: dofile('/tools/benchmarks/opcodes.lua')
+-- it records the packets received while walking around for a few seconds, then parses them again,
+-- use it on a test server only: replaying moves the game back to the recorded state
+
+local RECORD_TIME = 10000
+local ROUNDS = 5
+
+assert(g_game.isOnline(), 'log in before running this benchmark')
+local protocol = g_game.getProtocolGame()
+
+local function replay()
+  ProtocolGame.resetOpcodeCounters()
+  local best = math.huge
+  for i = 1, ROUNDS do
+    local start = os.clock()
+    protocol:replayRecordedMessages()
+    best = math.min(best, os.clock() - start)
+  end
+  -- the counters hold every round
+  return best, ProtocolGame.getFastPathOpcodes() / ROUNDS, ProtocolGame.getLuaPathOpcodes() / ROUNDS
+end
+
+print(string.format('recording packets for %d seconds, move around meanwhile', RECORD_TIME / 1000))
+protocol:clearRecordedMessages()
+protocol:setRecording(true)
+
+scheduleEvent(function()
+  protocol:setRecording(false)
+  local messages = protocol:getRecordedMessages()
+  assert(messages > 0, 'no packets were received while recording')
+
+  local time, fastPath, luaPath = replay()
+  local opcodes = fastPath + luaPath
+  print(string.format('%d packets with %d opcodes parsed in %.2f ms', messages, opcodes, time * 1000))
+  print(string.format('  %.0f opcodes/s, %d took the built-in path and %d the lua one', opcodes / time, fastPath, luaPath))
+
+  protocol:clearRecordedMessages()
+end, RECORD_TIME)
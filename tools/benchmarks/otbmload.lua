@@ -0,0 +1,27 @@
+-- OTBM parallel loading check
+-- run it from the client terminal with: dofile('/tools/benchmarks/otbmload.lua')
+-- set OTBM_FILE to the map to load first, items.otb must already be loaded with g_things.loadOtb
+-- the maps are saved back to the write directory, the two saved files must be identical
+
+local file = OTBM_FILE or '/data/world.otbm'
+assert(g_things.isOtbLoaded(), 'load items.otb before running this check')
+
+local function load(parallel, saveFile)
+  g_map.clean()
+  g_map.setParallelLoading(parallel)
+  g_map.loadOtbm(file)
+  g_map.saveOtbm(saveFile)
+end
+
+local wasParallel = g_map.isParallelLoading()
+load(false, '/otbmload-serial.otbm')
+load(true, '/otbmload-parallel.otbm')
+g_map.setParallelLoading(wasParallel)
+
+-- the saved file holds every tile with its flags, house and items with their attributes
+local serial = g_resources.readFileContents('/otbmload-serial.otbm')
+local parallel = g_resources.readFileContents('/otbmload-parallel.otbm')
+assert(#serial > 0, 'the serial load produced an empty map')
+assert(serial == parallel, 'parallel loading built a different map than serial loading')
+
+print(string.format('otbm %s: serial and parallel loading build the same map', file))
@@ -0,0 +1,37 @@
+-- OTB and OTBM load time benchmark
+-- run it from the client terminal with: dofile('/tools/benchmarks/otbmreader.lua')
+-- set OTB_FILE and OTBM_FILE first, the map should be a real world sized one
+-- loading runs serially so the processor time measured is the time spent reading the files
+
+local otbFile = OTB_FILE or '/data/items.otb'
+local otbmFile = OTBM_FILE or '/data/world.otbm'
+local ROUNDS = 3
+
+local function measure(load)
+  local best, total = math.huge, 0
+  for i = 1, ROUNDS do
+    local start = os.clock()
+    load()
+    local elapsed = os.clock() - start
+    best = math.min(best, elapsed)
+    total = total + elapsed
+  end
+  return best * 1000, total * 1000 / ROUNDS
+end
+
+local otbBest, otbAverage = measure(function()
+  g_things.loadOtb(otbFile)
+end)
+assert(g_things.isOtbLoaded(), 'unable to load ' .. otbFile)
+
+local wasParallel = g_map.isParallelLoading()
+g_map.setParallelLoading(false)
+local otbmBest, otbmAverage = measure(function()
+  g_map.clean()
+  g_map.loadOtbm(otbmFile)
+end)
+g_map.setParallelLoading(wasParallel)
+
+local size = g_map.getSize()
+print(string.format('otb %s: best %.1f ms, average %.1f ms', otbFile, otbBest, otbAverage))
+print(string.format('otbm %s (%dx%d): best %.1f ms, average %.1f ms', otbmFile, size.width, size.height, otbmBest, otbmAverage))
@@ -0,0 +1,62 @@
+-- OTML parsing benchmark
+-- run it from the client terminal with: dofile('/tools/benchmarks/otml.lua')
+-- parses every .otml, .otui and .otmod file under modules/ and data/ the way the startup does,
+-- without creating any widget or style from them
+
+local ROUNDS = 5
+local EXTENSIONS = { 'otml', 'otui', 'otmod' }
+
+local function isOtml(file)
+  for _, extension in ipairs(EXTENSIONS) do
+    if g_resources.isFileType(file, extension) then
+      return true
+    end
+  end
+  return false
+end
+
+local function collect(dir, files)
+  for _, name in ipairs(g_resources.listDirectoryFiles(dir)) do
+    local path = dir .. '/' .. name
+    if g_resources.directoryExists(path) then
+      collect(path, files)
+    elseif isOtml(name) then
+      table.insert(files, path)
+    end
+  end
+  return files
+end
+
+local files = {}
+for _, dir in ipairs({ '/modules', '/data' }) do
+  if g_resources.directoryExists(dir) then
+    collect(dir, files)
+  end
+end
+assert(#files > 0, 'no otml files found under modules/ and data/')
+
+local nodes = 0
+for _, file in ipairs(files) do
+  local ok, result = pcall(parseOtml, file)
+  assert(ok, string.format('unable to parse %s: %s', file, tostring(result)))
+  nodes = nodes + result
+end
+
+local bytes = 0
+for _, file in ipairs(files) do
+  bytes = bytes + #g_resources.readFileContents(file)
+end
+
+local best, total = math.huge, 0
+for i = 1, ROUNDS do
+  local start = os.clock()
+  for _, file in ipairs(files) do
+    parseOtml(file)
+  end
+  local elapsed = os.clock() - start
+  best = math.min(best, elapsed)
+  total = total + elapsed
+end
+
+print(string.format('%d otml files, %d KB, %d top level nodes', #files, bytes / 1024, nodes))
+print(string.format('  parse all: best %.1f ms, average %.1f ms', best * 1000, total * 1000 / ROUNDS))
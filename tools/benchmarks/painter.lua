@@ -0,0 +1,80 @@
+-- Painter batching benchmark
+-- run it from the client terminal with: dofile('/tools/benchmarks/painter.lua')
+-- draws a scene of images, labels and items (when the dat is loaded) with quad batching on and off
+-- and prints the draw calls, batches and quads counted by the painter in the drawn frames
+-- partial redraw is turned off meanwhile so every frame draws the whole foreground
+
+local COLUMNS = 24
+local ROWS = 16
+local CELL = 32
+local WARMUP = 500
+local SAMPLES = 20
+local SAMPLE_INTERVAL = 50
+
+local panel = g_ui.createWidget('UIWidget', rootWidget)
+panel:fill('parent')
+panel:setPhantom(true)
+
+local hasItems = g_things.isDatLoaded()
+for i = 0, COLUMNS * ROWS - 1 do
+  local kind = i % 3
+  local cell
+  if kind == 0 then
+    cell = g_ui.createWidget('UIWidget', panel)
+    cell:setImageSource('/images/ui/button')
+  elseif kind == 1 or not hasItems then
+    cell = g_ui.createWidget('UIWidget', panel)
+    cell:setText(tostring(i))
+  else
+    cell = UIItem.create()
+    panel:addChild(cell)
+    cell:setItemId(100 + i)
+  end
+  cell:setPhantom(true)
+  cell:setRect({ x = (i % COLUMNS) * CELL, y = math.floor(i / COLUMNS) * CELL, width = CELL, height = CELL })
+end
+
+local wasBatching = g_graphics.isPainterBatching()
+local wasPartialRedraw = g_ui.isPartialRedraw()
+g_ui.setPartialRedraw(false)
+
+local results = {}
+
+local function measure(batching, done)
+  g_graphics.setPainterBatching(batching)
+  local totals = { calls = 0, batches = 0, quads = 0 }
+  local samples = 0
+  local sampleEvent
+  scheduleEvent(function()
+    sampleEvent = cycleEvent(function()
+      totals.calls = totals.calls + g_graphics.getDrawCalls()
+      totals.batches = totals.batches + g_graphics.getDrawBatches()
+      totals.quads = totals.quads + g_graphics.getDrawQuads()
+      samples = samples + 1
+      if samples >= SAMPLES then
+        removeEvent(sampleEvent)
+        results[batching] = { calls = totals.calls / samples, batches = totals.batches / samples, quads = totals.quads / samples }
+        done()
+      end
+    end, SAMPLE_INTERVAL)
+  end, WARMUP)
+end
+
+local function finish()
+  panel:destroy()
+  g_graphics.setPainterBatching(wasBatching)
+  g_ui.setPartialRedraw(wasPartialRedraw)
+
+  local on, off = results[true], results[false]
+  print(string.format('%d widgets per frame', COLUMNS * ROWS))
+  print(string.format('  batching off: %.0f draw calls', off.calls))
+  print(string.format('  batching on: %.0f draw calls, %.0f batches, %.0f quads, %.1f quads per batch',
+                      on.calls, on.batches, on.quads, on.quads / math.max(on.batches, 1)))
+  print(string.format('  draw calls reduced %.1fx', off.calls / math.max(on.calls, 1)))
+  assert(on.quads > 0, 'no quad went through the batch')
+  assert(on.calls < off.calls, 'batching did not reduce the draw calls')
+end
+
+measure(false, function()
+  measure(true, finish)
+end)
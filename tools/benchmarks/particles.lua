@@ -0,0 +1,52 @@
+-- Particle benchmark, about 100k particles alive at once
+-- run it from the client terminal with: dofile('/tools/benchmarks/particles.lua')
+-- the numbers come from the profiler scopes of the drawn frames, the results are printed after a few seconds
+
+local WARMUP = 3000 -- the emitter needs 2 seconds to reach its steady particle count
+local SAMPLES = 50
+local SAMPLE_INTERVAL = 100
+
+assert(g_particles.importParticle('/tools/benchmarks/particles.otps'), 'unable to load the benchmark particles')
+
+local wasProfiling = g_profiler.isEnabled()
+g_profiler.setEnabled(true)
+
+local widget = UIParticles.create()
+rootWidget:addChild(widget)
+widget:fill('parent')
+widget:setPhantom(true)
+widget:addEffect('benchmark-effect')
+
+local totals = { frame = 0 }
+local samples = 0
+local sampleEvent
+
+local function finish()
+  removeEvent(sampleEvent)
+  widget:destroy()
+  g_profiler.setEnabled(wasProfiling)
+
+  print(string.format('%d samples of frames with ~100k particles', samples))
+  print(string.format('  frame %.2f ms', totals.frame / samples))
+  for _, name in ipairs({ 'ParticleManager::poll', 'ParticleSystem::render' }) do
+    print(string.format('  %s %.2f ms', name, (totals[name] or 0) / samples))
+  end
+end
+
+scheduleEvent(function()
+  sampleEvent = cycleEvent(function()
+    -- each entry is { name, depth, milliseconds, calls }
+    for _, scope in ipairs(g_profiler.getFrameScopes()) do
+      local name = scope[1]
+      if name == 'ParticleManager::poll' or name == 'ParticleSystem::render' then
+        totals[name] = (totals[name] or 0) + scope[3]
+      end
+    end
+    totals.frame = totals.frame + g_profiler.getFrameTime()
+    samples = samples + 1
+
+    if samples >= SAMPLES then
+      finish()
+    end
+  end, SAMPLE_INTERVAL)
+end, WARMUP)
@@ -0,0 +1,40 @@
+-- Sprite decoding checks and benchmark
+-- run it from the client terminal with: dofile('/tools/benchmarks/sprites.lua')
+-- the sprites must already be loaded, it decodes the whole .spr with the SSE and the scalar pixel expansion
+
+assert(g_sprites.isLoaded(), 'load the sprites before running this benchmark')
+
+local count = g_sprites.getSpritesCount()
+local wasVector = g_sprites.isVectorDecoding()
+local cacheSize = g_sprites.getCacheSize()
+
+-- without a cache every call decodes the sprite again
+g_sprites.setCacheSize(0)
+
+local function decodeAll(vector)
+  g_sprites.setVectorDecoding(vector)
+  local start = os.clock()
+  for id = 1, count do
+    g_sprites.getSpritePixels(id)
+  end
+  return os.clock() - start
+end
+
+-- both paths must produce the same pixels for every sprite
+for id = 1, count do
+  g_sprites.setVectorDecoding(true)
+  local vectorPixels = g_sprites.getSpritePixels(id)
+  g_sprites.setVectorDecoding(false)
+  assert(g_sprites.getSpritePixels(id) == vectorPixels, 'vector and scalar decoding differ for sprite ' .. id)
+end
+
+local vectorTime = decodeAll(true)
+local scalarTime = decodeAll(false)
+
+g_sprites.setVectorDecoding(wasVector)
+g_sprites.setCacheSize(cacheSize)
+
+print(string.format('%d sprites decoded the same by both paths', count))
+print(string.format('  sse %.0f sprites/s (%.1f ms)', count / vectorTime, vectorTime * 1000))
+print(string.format('  scalar %.0f sprites/s (%.1f ms)', count / scalarTime, scalarTime * 1000))
+print(string.format('  speedup %.2fx', scalarTime / vectorTime))
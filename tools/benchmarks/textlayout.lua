@@ -0,0 +1,145 @@
+-- Text wrapping checks and console layout benchmark
+-- run it from the client terminal with: dofile('/tools/benchmarks/textlayout.lua')
+-- the check compares UITextEdit.wrapText with the word splitting wrap it replaced, ported below,
+-- the benchmark lays out a console buffer holding 1000 lines
+
+local LINES = 1000
+local CHECK_TEXTS = 200
+local CHECK_WIDTHS = { 40, 120, 250 }
+local RELAYOUTS = 10
+
+math.randomseed(1)
+
+local function randomWord(length)
+  local chars = {}
+  for i = 1, length do
+    chars[i] = string.char(math.random(33, 126))
+  end
+  return table.concat(chars)
+end
+
+local function randomText()
+  local words = {}
+  for i = 1, math.random(1, 30) do
+    -- a few words are longer than any wrap width and must be broken with hyphens
+    local length = math.random(1, 10) == 1 and math.random(20, 40) or math.random(1, 10)
+    words[i] = randomWord(length)
+  end
+  -- double spaces give empty words
+  return table.concat(words, math.random(1, 5) == 1 and '  ' or ' ')
+end
+
+local root = g_ui.createWidget('UIWidget', rootWidget)
+root:setVisible(false)
+
+local meter = g_ui.createWidget('UIWidget', root)
+local edit = g_ui.createWidget('UITextEdit', root)
+edit:setMultiline(true)
+meter:setFont(edit:getFont())
+
+local function measure(text)
+  meter:setText(text)
+  return meter:getTextSize().width
+end
+
+local function split(text)
+  local words = {}
+  local start = 1
+  while true do
+    local pos = text:find(' ', start, true)
+    if not pos then
+      table.insert(words, text:sub(start))
+      return words
+    end
+    table.insert(words, text:sub(start, pos - 1))
+    start = pos + 1
+  end
+end
+
+-- the wrap used before the text layout rework, measuring every candidate line again
+local function oldWrapText(text, maxWidth)
+  local words = {}
+  for _, word in ipairs(split(text)) do
+    if measure(word) > maxWidth then
+      local newWord = ''
+      for j = 1, #word do
+        local char = word:sub(j, j)
+        local candidate = newWord .. char
+        if j ~= #word then
+          candidate = candidate .. '-'
+        end
+        if measure(candidate) > maxWidth then
+          table.insert(words, newWord .. '-')
+          newWord = ''
+        end
+        newWord = newWord .. char
+      end
+      table.insert(words, newWord)
+    else
+      table.insert(words, word)
+    end
+  end
+
+  local outText, line = '', ''
+  for _, word in ipairs(words) do
+    if measure(line .. word) > maxWidth then
+      if #line > 0 then
+        outText = outText .. line:sub(1, -2) .. '\n'
+      end
+      line = ''
+    end
+    line = line .. word .. ' '
+  end
+  outText = outText .. line
+  return outText:sub(1, -2)
+end
+
+-- wrapText wraps to the padding rect minus the text offset
+local padding = edit:getPaddingRect().width - edit:getWidth()
+for _, width in ipairs(CHECK_WIDTHS) do
+  edit:setWidth(width - padding + edit:getTextOffset().x)
+  local maxWidth = edit:getPaddingRect().width - edit:getTextOffset().x
+  for i = 1, CHECK_TEXTS do
+    local text = randomText()
+    edit:setText(text)
+    edit:wrapText()
+    local expected = oldWrapText(text, maxWidth)
+    assert(edit:getText() == expected, string.format('wrap to %d differs for "%s":\n%s\n%s', maxWidth, text, edit:getText(), expected))
+  end
+end
+print(string.format('%d texts wrapped the same as before at %d widths', CHECK_TEXTS, #CHECK_WIDTHS))
+
+-- console buffer, the labels wrap to its width and grow to their wrapped height
+local buffer = g_ui.createWidget('UIWidget', root)
+buffer:setWidth(400)
+local layout = UIVerticalLayout.create(buffer)
+layout:setAlignBottom(true)
+buffer:setLayout(layout)
+
+local lines = {}
+for i = 1, LINES do
+  lines[i] = string.format('%02d:%02d Player [%d]: %s', i % 24, i % 60, i, randomText())
+end
+
+local style = g_ui.getStyle('ConsoleLabel') and 'ConsoleLabel' or 'UITextEdit'
+local start = os.clock()
+for i = 1, LINES do
+  local label = g_ui.createWidget(style, buffer)
+  label:setTextWrap(true)
+  label:setTextAutoResize(true)
+  label:setText(lines[i])
+end
+local createTime = os.clock() - start
+
+-- resizing the buffer wraps every line again
+start = os.clock()
+for i = 1, RELAYOUTS do
+  buffer:setWidth(i % 2 == 0 and 400 or 300)
+end
+local relayoutTime = (os.clock() - start) / RELAYOUTS
+
+root:destroy()
+
+print(string.format('console with %d %s lines', LINES, style))
+print(string.format('  created and laid out in %.1f ms', createTime * 1000))
+print(string.format('  wrapped again on resize in %.1f ms', relayoutTime * 1000))
@@ -0,0 +1,38 @@
+-- Map tile storage benchmark
+-- run it from the client terminal with: dofile('/tools/benchmarks/tiles.lua')
+-- set OTBM_FILE to a large map first, items.otb must already be loaded with g_things.loadOtb
+-- the scan calls g_map.getTile for every position of the ground floor, the lua call cost is measured apart
+
+local file = OTBM_FILE or '/data/world.otbm'
+local FLOOR = 7
+assert(g_things.isOtbLoaded(), 'load items.otb before running this benchmark')
+
+g_map.clean()
+local loadStart = os.clock()
+g_map.loadOtbm(file)
+local loadTime = os.clock() - loadStart
+
+local size = g_map.getSize()
+assert(size.width > 0 and size.height > 0, 'unable to load ' .. file)
+
+local function scan(getTile)
+  local found = 0
+  local start = os.clock()
+  for y = 0, size.height - 1 do
+    for x = 0, size.width - 1 do
+      if getTile({ x = x, y = y, z = FLOOR }) then
+        found = found + 1
+      end
+    end
+  end
+  return os.clock() - start, found
+end
+
+-- same loop without touching the map, what is left is the cost of getTile itself
+local baseTime = scan(function(pos) return nil end)
+local scanTime, found = scan(g_map.getTile)
+
+local lookups = size.width * size.height
+print(string.format('otbm %s (%dx%d) loaded in %.1f ms', file, size.width, size.height, loadTime * 1000))
+print(string.format('  %d getTile calls on floor %d found %d tiles in %.1f ms', lookups, FLOOR, found, scanTime * 1000))
+print(string.format('  %.1f ns per lookup without the lua overhead', math.max(scanTime - baseTime, 0) * 1e9 / lookups))
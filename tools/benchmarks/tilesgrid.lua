@@ -0,0 +1,68 @@
+-- MapView visible tiles check
+-- run it from the client terminal with: dofile('/tools/benchmarks/tilesgrid.lua')
+-- a map must be loaded, either by logging in or with g_map.loadOtbm, set CAMERA_POSITION to start somewhere else
+-- the camera walks, teleports and changes floors, after every move the incrementally shifted tiles
+-- are compared with a full rebuild in the near, mid and far view modes
+
+local start = CAMERA_POSITION or (g_game.isOnline() and g_game.getLocalPlayer():getPosition()) or g_map.getCentralPosition()
+assert(start and start.x and start.x > 0, 'set CAMERA_POSITION or load a map first')
+
+local STEPS = 40
+local DIRECTIONS = {
+  { x = 1, y = 0 }, { x = 0, y = 1 }, { x = -1, y = 0 }, { x = 0, y = -1 },
+  { x = 1, y = 1 }, { x = -1, y = 1 }, { x = -1, y = -1 }, { x = 1, y = -1 },
+}
+local VIEWS = {
+  { mode = 0, dimension = { width = 15, height = 11 } },
+  { mode = 1, dimension = { width = 25, height = 19 } },
+  { mode = 2, dimension = { width = 41, height = 31 } },
+}
+
+local map = UIMap.create()
+rootWidget:addChild(map)
+map:fill('parent')
+map:setPhantom(true)
+map:setAutoViewMode(false)
+map:setMultifloor(true)
+
+local checks = 0
+local function moveTo(position)
+  map:setCameraPosition(position)
+  assert(map:checkVisibleTilesCache(), string.format('visible tiles differ from a full rebuild at %d,%d,%d', position.x, position.y, position.z))
+  checks = checks + 1
+end
+
+for _, view in ipairs(VIEWS) do
+  map:setVisibleDimension(view.dimension)
+  map:setViewMode(view.mode)
+
+  local position = { x = start.x, y = start.y, z = start.z }
+  moveTo(position)
+
+  -- single steps in every direction, the path that shifts the grid
+  for _, direction in ipairs(DIRECTIONS) do
+    for i = 1, STEPS do
+      position = { x = position.x + direction.x, y = position.y + direction.y, z = position.z }
+      moveTo(position)
+    end
+  end
+
+  -- jumps farther than the view rebuild the grid
+  moveTo({ x = position.x + view.dimension.width * 2, y = position.y, z = position.z })
+  moveTo({ x = start.x, y = start.y, z = start.z })
+
+  -- floor changes, then steps on the new floor
+  for _, z in ipairs({ start.z - 1, start.z + 1, start.z }) do
+    if z >= 0 and z <= 15 then
+      position = { x = start.x, y = start.y, z = z }
+      moveTo(position)
+      for i = 1, STEPS do
+        position = { x = position.x + 1, y = position.y, z = z }
+        moveTo(position)
+      end
+    end
+  end
+end
+
+map:destroy()
+print(string.format('%d camera moves: incremental visible tiles match a full rebuild', checks))
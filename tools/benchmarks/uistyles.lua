@@ -0,0 +1,53 @@
+-- Widget state style checks and benchmark
+-- run it from the client terminal with: dofile('/tools/benchmarks/uistyles.lua')
+-- it uses the CheckBox style from data/styles/10-checkboxes.otui
+
+local WIDGETS = 3000
+local ROUNDS = 10
+
+local function sameRect(a, b)
+  return a.x == b.x and a.y == b.y and a.width == b.width and a.height == b.height
+end
+
+local function sameColor(a, b)
+  return a.r == b.r and a.g == b.g and a.b == b.b and a.a == b.a
+end
+
+local root = g_ui.createWidget('UIWidget', rootWidget)
+root:setVisible(false)
+
+-- a restyled widget must keep the properties of the states it is in
+local checked = g_ui.createWidget('CheckBox', root)
+checked:setChecked(true)
+local checkedClip = checked:getImageClip()
+checked:setStyle('CheckBox')
+assert(sameRect(checked:getImageClip(), checkedClip), 'restyled checked widget lost its $checked image clip')
+checked:mergeStyle(g_ui.getStyle('CheckBox'))
+assert(sameRect(checked:getImageClip(), checkedClip), 'merged style dropped the $checked image clip')
+
+local disabled = g_ui.createWidget('CheckBox', root)
+disabled:setEnabled(false)
+local disabledColor = disabled:getColor()
+disabled:setStyle('CheckBox')
+assert(sameColor(disabled:getColor(), disabledColor), 'restyled disabled widget lost its $disabled color')
+print('state styles survive restyles')
+
+local widgets = {}
+for i = 1, WIDGETS do
+  widgets[i] = g_ui.createWidget('CheckBox', root)
+end
+
+local start = os.clock()
+for round = 1, ROUNDS do
+  for i = 1, WIDGETS do
+    widgets[i]:setChecked(round % 2 == 1)
+  end
+  for i = 1, WIDGETS do
+    widgets[i]:setEnabled(round % 2 == 0)
+  end
+end
+local elapsed = os.clock() - start
+local transitions = WIDGETS * ROUNDS * 2
+print(string.format('%d state transitions in %.1f ms, %.2f us each', transitions, elapsed * 1000, elapsed * 1000000 / transitions))
+
+root:destroy()